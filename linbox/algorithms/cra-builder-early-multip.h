@@ -201,6 +201,35 @@ namespace LinBox
 			return CRABuilderEarlySingle<Domain>::noncoprime(i);
 		}
 
+		/** @brief Appends the state of both builders and the random
+		 * coefficients to \p bytes.
+		 */
+		uint64_t serialize(std::vector<uint8_t>& bytes) const
+		{
+			auto bytesWritten = CRABuilderEarlySingle<Domain>::serialize(bytes);
+			bytesWritten += CRABuilderFullMultip<Domain>::serialize(bytes);
+			bytesWritten += LinBox::serialize(bytes, static_cast<uint64_t>(randv.size()));
+			for (const auto& c : randv)
+				bytesWritten += LinBox::serialize(bytes, static_cast<uint64_t>(c));
+			return bytesWritten;
+		}
+
+		/** @brief Restores the state written by serialize().
+		 */
+		uint64_t unserialize(const std::vector<uint8_t>& bytes, uint64_t offset = 0u)
+		{
+			auto bytesRead = CRABuilderEarlySingle<Domain>::unserialize(bytes, offset);
+			bytesRead += CRABuilderFullMultip<Domain>::unserialize(bytes, offset + bytesRead);
+			uint64_t l, c;
+			bytesRead += LinBox::unserialize(l, bytes, offset + bytesRead);
+			randv.resize(l);
+			for (auto& r : randv) {
+				bytesRead += LinBox::unserialize(c, bytes, offset + bytesRead);
+				r = static_cast<size_t>(c);
+			}
+			return bytesRead;
+		}
+
 		bool changeVector()
 		{
 			for ( std::vector<size_t>::iterator int_p = randv. begin();int_p != randv. end(); ++ int_p)
@@ -219,11 +248,9 @@ namespace LinBox
                  ++it)
             {
                 if (it->occupied) {
-					Integer D = it->mod();
-					std::vector<Integer> e_v(randv.size());
-					e_v = it->residue;
+					const Integer& D = it->mod();
 					Integer z;
-					dot(z,D, e_v, randv);
+					dot(z,D, it->residue, randv);
 					Integer prev_residue_ = CRABuilderEarlySingle<Domain>::residue_;
 					CRABuilderEarlySingle<Domain>::progress(D,z);
 					if (prev_residue_ == CRABuilderEarlySingle<Domain>::residue_ )
@@ -246,9 +273,12 @@ namespace LinBox
 			z = 0;
 			typename Vect1::const_iterator v1_p;
 			typename Vect2::const_iterator v2_p;
+			// accumulate without reduction, reduce once at the end
 			for (v1_p  = v1. begin(), v2_p = v2. begin(); v1_p != v1. end(); ++ v1_p, ++ v2_p) {
-				z = (z + (*v1_p)*(*v2_p))%D;
+				z += (*v1_p)*(*v2_p);
 			}
+			Integer::modin(z, D);
+			if (z < 0) z += D;
 			return z;
 		}
 
@@ -38,6 +38,14 @@
 #include <utility>
 
 #include "linbox/algorithms/lazy-product.h"
+#include "linbox/util/serialization.h"
+
+/*! Minimal dimension of a vector for its shelves to be combined with OpenMP threads.
+ * Below it, the reconstruction of the entries is too cheap to be shared.
+ */
+#ifndef __LINBOX_CRA_PARALLEL_THRESHOLD
+#define __LINBOX_CRA_PARALLEL_THRESHOLD 64
+#endif
 
 namespace LinBox
 {
@@ -55,6 +63,12 @@ namespace LinBox
      * shelf according to log2(log(modulus)), as computed by the getShelf() helper.
      * When two residues belong on the same shelf, they are combined and re-assigned
      * to another shelf, recursively.
+     *
+     * The shelves thus form a subproduct tree over the primes: every
+     * combination merges two moduli of about the same size. The entries of
+     * the vector are independent, and for vectors of dimension at least
+     * __LINBOX_CRA_PARALLEL_THRESHOLD, each combination and the final
+     * normalization are shared among the OpenMP threads.
 	 */
 	template<class Domain_Type>
 	struct CRABuilderFullMultip {
@@ -258,6 +272,68 @@ namespace LinBox
             return shelves_.rend();
         }
 
+        /** @brief Appends the accumulated state to \p bytes.
+         *
+         * Every occupied shelf is written with its modulus and residues,
+         * so that a checkpointed reconstruction can be resumed by unserialize().
+         * @returns the number of bytes written
+         */
+        uint64_t serialize(std::vector<uint8_t>& bytes) const
+        {
+            auto bytesWritten = LinBox::serialize(bytes, static_cast<uint64_t>(dimension_));
+            bytesWritten += LinBox::serialize(bytes, totalsize_);
+            bytesWritten += LinBox::serialize(bytes, static_cast<uint8_t>(collapsed_));
+            bytesWritten += LinBox::serialize(bytes, static_cast<uint8_t>(normalized_));
+            bytesWritten += LinBox::serialize(bytes, static_cast<uint64_t>(shelves_.size()));
+            for (const auto& shelf : shelves_) {
+                bytesWritten += LinBox::serialize(bytes, static_cast<uint8_t>(shelf.occupied));
+                if (! shelf.occupied) continue;
+                bytesWritten += LinBox::serialize(bytes, shelf.mod());
+                bytesWritten += LinBox::serialize(bytes, shelf.logmod);
+                bytesWritten += LinBox::serialize(bytes, static_cast<int32_t>(shelf.count));
+                bytesWritten += LinBox::serialize(bytes, shelf.residue);
+            }
+            return bytesWritten;
+        }
+
+        /** @brief Restores the state written by serialize().
+         *
+         * The upper bound given at construction is kept.
+         * @returns the number of bytes read
+         */
+        uint64_t unserialize(const std::vector<uint8_t>& bytes, uint64_t offset = 0u)
+        {
+            uint64_t dim, nshelves;
+            uint8_t flag;
+            uint64_t bytesRead = 0u;
+            bytesRead += LinBox::unserialize(dim, bytes, offset + bytesRead);
+            dimension_ = static_cast<size_t>(dim);
+            bytesRead += LinBox::unserialize(totalsize_, bytes, offset + bytesRead);
+            bytesRead += LinBox::unserialize(flag, bytes, offset + bytesRead);
+            collapsed_ = flag;
+            bytesRead += LinBox::unserialize(flag, bytes, offset + bytesRead);
+            normalized_ = flag;
+            bytesRead += LinBox::unserialize(nshelves, bytes, offset + bytesRead);
+
+            shelves_.clear();
+            for (uint64_t i = 0; i < nshelves; ++i) {
+                shelves_.emplace_back(dimension_);
+                Shelf& shelf = shelves_.back();
+                bytesRead += LinBox::unserialize(flag, bytes, offset + bytesRead);
+                shelf.occupied = flag;
+                if (! shelf.occupied) continue;
+                Integer m;
+                int32_t count;
+                bytesRead += LinBox::unserialize(m, bytes, offset + bytesRead);
+                shelf.mod.initialize(m);
+                bytesRead += LinBox::unserialize(shelf.logmod, bytes, offset + bytesRead);
+                bytesRead += LinBox::unserialize(count, bytes, offset + bytesRead);
+                shelf.count = count;
+                bytesRead += LinBox::unserialize(shelf.residue, bytes, offset + bytesRead);
+            }
+            return bytesRead;
+        }
+
 	protected:
         /** Returns the index where the shelf (with specified natural log of modulus) belongs.
          */
@@ -284,16 +360,18 @@ namespace LinBox
         }
 
         /** @brief Incorporates the residue in src into dest and updates the modulus.
+         *
+         * Entries are independent, so large vectors are combined in parallel.
          */
         static inline void combineShelves(Shelf& dest, const Shelf& src) {
             // assumption: dest is already occupied
             auto invprod = precompInv(dest.mod(), src.mod());
-			auto src_it = src.residue.begin();
-            for (auto dest_it = dest.residue.begin();
-                 dest_it != dest.residue.end();
-                 ++dest_it, ++src_it)
-            {
-                reconstruct(*dest_it, dest.mod(), *src_it, invprod, src.mod());
+            const Integer& destmod = dest.mod();
+            const Integer& srcmod = src.mod();
+            const long n = static_cast<long>(dest.residue.size());
+#pragma omp parallel for if(n >= __LINBOX_CRA_PARALLEL_THRESHOLD) schedule(static)
+            for (long i = 0; i < n; ++i) {
+                reconstruct(dest.residue[i], destmod, src.residue[i], invprod, srcmod);
             }
             dest.mod.mulin(src.mod());
             dest.logmod += src.logmod;
@@ -349,12 +427,16 @@ namespace LinBox
         void normalize() const {
             if (normalized_) return;
             collapse();
-            Integer halfm = shelves_.back().mod();
+            const Integer& m = shelves_.back().mod();
+            Integer halfm = m;
             --halfm;
             halfm >>= 1;
-            for (auto& x : const_cast<std::vector<Integer>&>(shelves_.back().residue)) {
-                Integer::modin(x, shelves_.back().mod());
-                if (x > halfm) x -= shelves_.back().mod();
+            auto& residue = const_cast<std::vector<Integer>&>(shelves_.back().residue);
+            const long n = static_cast<long>(residue.size());
+#pragma omp parallel for if(n >= __LINBOX_CRA_PARALLEL_THRESHOLD) schedule(static)
+            for (long i = 0; i < n; ++i) {
+                Integer::modin(residue[i], m);
+                if (residue[i] > halfm) residue[i] -= m;
             }
             const_cast<bool&>(normalized_) = true;
         }
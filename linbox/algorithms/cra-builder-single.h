@@ -311,6 +311,31 @@ namespace LinBox
 			return primeProd_.bitsize() + nextM_.bitsize() - 1;
 		}
 
+		/** @brief Appends the modulus and residue to \p bytes.
+		 *
+		 * @returns the number of bytes written
+		 */
+		uint64_t serialize(std::vector<uint8_t>& bytes) const
+		{
+			auto bytesWritten = LinBox::serialize(bytes, primeProd_);
+			bytesWritten += LinBox::serialize(bytes, nextM_);
+			bytesWritten += LinBox::serialize(bytes, residue_);
+			return bytesWritten;
+		}
+
+		/** @brief Restores the state written by serialize().
+		 *
+		 * @returns the number of bytes read
+		 */
+		uint64_t unserialize(const std::vector<uint8_t>& bytes, uint64_t offset = 0u)
+		{
+			uint64_t bytesRead = 0u;
+			bytesRead += LinBox::unserialize(primeProd_, bytes, offset + bytesRead);
+			bytesRead += LinBox::unserialize(nextM_, bytes, offset + bytesRead);
+			bytesRead += LinBox::unserialize(residue_, bytes, offset + bytesRead);
+			return bytesRead;
+		}
+
 		virtual ~CRABuilderSingleBase() {}
 
 #ifdef _LB_CRATIMING
@@ -440,6 +465,25 @@ namespace LinBox
 		{
 			return occurency_ > EARLY_TERM_THRESHOLD;
 		}
+
+		/** @brief Appends the state, with the number of equalities, to \p bytes.
+		 */
+		uint64_t serialize(std::vector<uint8_t>& bytes) const
+		{
+			auto bytesWritten = Base::serialize(bytes);
+			return bytesWritten + LinBox::serialize(bytes, static_cast<uint32_t>(occurency_));
+		}
+
+		/** @brief Restores the state written by serialize().
+		 */
+		uint64_t unserialize(const std::vector<uint8_t>& bytes, uint64_t offset = 0u)
+		{
+			uint32_t occ;
+			auto bytesRead = Base::unserialize(bytes, offset);
+			bytesRead += LinBox::unserialize(occ, bytes, offset + bytesRead);
+			occurency_ = occ;
+			return bytesRead;
+		}
 	};
 
 
@@ -552,6 +596,23 @@ namespace LinBox
 		{
 			return curfailprob_ <= failbound_;
 		}
+
+		/** @brief Appends the state, with the current failure probability, to \p bytes.
+		 */
+		uint64_t serialize(std::vector<uint8_t>& bytes) const
+		{
+			auto bytesWritten = Base::serialize(bytes);
+			return bytesWritten + LinBox::serialize(bytes, curfailprob_);
+		}
+
+		/** @brief Restores the state written by serialize().
+		 */
+		uint64_t unserialize(const std::vector<uint8_t>& bytes, uint64_t offset = 0u)
+		{
+			auto bytesRead = Base::unserialize(bytes, offset);
+			bytesRead += LinBox::unserialize(curfailprob_, bytes, offset + bytesRead);
+			return bytesRead;
+		}
 	};
 
 
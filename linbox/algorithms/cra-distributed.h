@@ -26,6 +26,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -39,10 +40,25 @@
 #include "linbox/util/mpicpp.h"
 #include "linbox/util/timer.h"
 
+#if defined(__LINBOX_USE_OPENMP) || defined(_OPENMP)
+#include <omp.h>
+#endif
+
 #if defined(__LINBOX_HAVE_MPI)
 
 namespace LinBox {
 
+    /**
+     * Master/worker chinese remaindering over MPI.
+     *
+     * The master hands out batches of primes to the workers, each worker using
+     * its own disjoint sequence of primes. A worker sends every residue as soon
+     * as it is computed, then reports the wall time of the batch; its next
+     * batch is sized from that throughput so that it lasts about
+     * batchDuration() seconds, slow nodes thus getting fewer primes than fast ones.
+     * As soon as the builder has terminated, the master sends a stop signal
+     * that the workers check before each prime, so no batch is completed in vain.
+     */
     template <class CRABase>
     struct ChineseRemainderDistributed {
         using Domain = typename CRABase::Domain;
@@ -55,19 +71,33 @@ namespace LinBox {
         CRABase Builder_;
         Communicator* _pCommunicator;
         double _hadamardLogBound;
-        double _workerHadamardLogBound = 0.0; //!< Each worker will compute primes until this is hit.
+        double _batchSeconds = 1.0;    //!< Targeted wall time of a batch on a worker.
+        bool _threadedWorkers = false; //!< Workers use all their OpenMP threads.
+
+        // Sent by a worker instead of a prime.
+        enum : uint64_t {
+            StopAck = 0,   //!< The worker received the stop signal and quits.
+            BatchDone = 1, //!< Followed by the wall time of the batch.
+        };
 
     public:
-        ChineseRemainderDistributed(double b, Communicator* c)
+        /**
+         * \param threadedWorkers  If true, each worker computes several residues at once
+         * with OpenMP threads, and the communicator must have been created with
+         * at least Communicator::ThreadMode::Serialized.
+         */
+        ChineseRemainderDistributed(double b, Communicator* c, bool threadedWorkers = false)
             : Builder_(b)
             , _pCommunicator(c)
             , _hadamardLogBound(b)
+            , _threadedWorkers(threadedWorkers)
         {
-            if (c && c->size() > 1) {
-                _workerHadamardLogBound = _hadamardLogBound / (c->size() - 1);
-            }
         }
 
+        /// Targeted wall time, in seconds, of a batch of primes on a worker.
+        double batchDuration() const { return _batchSeconds; }
+        void setBatchDuration(double seconds) { _batchSeconds = seconds; }
+
         /** \brief The CRA loop.
          *
          * \param Iteration  Function object of two arguments, \c
@@ -165,44 +195,193 @@ namespace LinBox {
         {
             MaskedPrimeGenerator gen(_pCommunicator->rank() - 1, _pCommunicator->size() - 1);
 
-            // Each worker will work until _workerHadamardLogBound is hit
-            double primesLogSum = 0.0;
-            while (primesLogSum < _workerHadamardLogBound) {
-                worker_compute(gen, Iteration, r);
+#if defined(__LINBOX_USE_OPENMP) || defined(_OPENMP)
+            if (_threadedWorkers && omp_get_max_threads() > 1) {
+                threaded_worker_process_task(gen, Iteration, r);
+                return;
+            }
+#endif
+
+            // A batch size of 0 is the stop signal
+            uint64_t batch;
+            _pCommunicator->recv(batch, 0);
+            while (batch > 0) {
+                Timer chrono;
+                chrono.start();
+                uint64_t i = 0;
+                for (; i < batch && !stop_received(); ++i) {
+                    worker_compute(gen, Iteration, r);
+
+                    uint64_t p = *gen;
+                    _pCommunicator->send(p, 0);
+                    _pCommunicator->send(r, 0);
+                }
+                if (i < batch) break;
+                chrono.stop();
 
-                uint64_t p = *gen;
-                primesLogSum += Givaro::logtwo(p);
-                _pCommunicator->send(p, 0);
-                _pCommunicator->send(r, 0);
+                send_batch_done(chrono.realtime());
+                _pCommunicator->recv(batch, 0);
             }
 
-            uint64_t poisonPill = 0;
+            uint64_t poisonPill = StopAck;
             _pCommunicator->send(poisonPill, 0);
         }
 
+#if defined(__LINBOX_USE_OPENMP) || defined(_OPENMP)
+        /**
+         * Same as worker_process_task, but every thread of the node pulls
+         * primes of the current batch from the worker's generator and sends its residue as soon as it is done.
+         * The (prime, residue) pair is sent within one critical section,
+         * so that the master receives them consecutively from this rank.
+         */
+        template <class Any, class Function>
+        void threaded_worker_process_task(MaskedPrimeGenerator& gen, Function& Iteration, const Any& r0)
+        {
+            uint64_t batch;
+            bool stopped = false;
+            _pCommunicator->recv(batch, 0);
+            while (batch > 0) {
+                Timer chrono;
+                chrono.start();
+                uint64_t handed = 0;
+
+#pragma omp parallel shared(gen, handed, stopped)
+                {
+                    Any r(r0);
+                    for (;;) {
+                        uint64_t p = 0;
+
+#pragma omp critical (LinBoxCRADistributed)
+                        {
+                            if (!stopped && handed < batch) {
+                                if (stop_received()) {
+                                    stopped = true;
+                                }
+                                else {
+                                    ++gen;
+                                    while (Builder_.noncoprime(*gen)) {
+                                        ++gen;
+                                    }
+                                    p = *gen;
+                                    ++handed;
+                                }
+                            }
+                        }
+                        if (p == 0) break;
+
+                        Domain D(p);
+                        Iteration(r, D);
+
+#pragma omp critical (LinBoxCRADistributed)
+                        {
+                            if (!stopped) {
+                                _pCommunicator->send(p, 0);
+                                _pCommunicator->send(r, 0);
+                            }
+                        }
+                    }
+                }
+
+                if (stopped) break;
+                chrono.stop();
+
+                send_batch_done(chrono.realtime());
+                _pCommunicator->recv(batch, 0);
+            }
+
+            uint64_t poisonPill = StopAck;
+            _pCommunicator->send(poisonPill, 0);
+        }
+#endif
+
         template <class Any, class Function>
         void master_process_task(Function& Iteration, Domain& D, Any& r)
         {
+            const int workers = _pCommunicator->size() - 1;
+
+            // Each worker starts with a single prime, to measure its throughput
+            std::vector<uint64_t> batches(workers + 1, 1u);
+            for (int w = 1; w <= workers; ++w) {
+                _pCommunicator->send(batches[w], w);
+            }
+
             Iteration(r, D);
             Builder_.initialize(D, r);
+            bool stopped = false;
+            if (Builder_.terminated()) {
+                stop_workers();
+                stopped = true;
+            }
 
-            uint32_t workersDone = _pCommunicator->size() - 1;
+            int workersDone = workers;
             while (workersDone > 0) {
                 // Receive the prime
                 uint64_t p;
                 _pCommunicator->recv(p, MPI_ANY_SOURCE);
-                if (p == 0) {
+                int src = _pCommunicator->status().MPI_SOURCE;
+                if (p == StopAck) {
                     workersDone -= 1;
                     continue;
                 }
 
+                if (p == BatchDone) {
+                    double elapsed;
+                    _pCommunicator->recv(elapsed, src);
+                    // Once stopped, the worker is already waiting for the stop signal
+                    if (!stopped) {
+                        batches[src] = next_batch_size(batches[src], elapsed);
+                        _pCommunicator->send(batches[src], src);
+                    }
+                    continue;
+                }
+
                 // Receive result vector and update builder
-                _pCommunicator->recv(r, _pCommunicator->status().MPI_SOURCE);
+                _pCommunicator->recv(r, src);
+                if (stopped) continue;
 
                 Domain D(p);
                 Builder_.progress(D, r);
+                if (Builder_.terminated()) {
+                    stop_workers();
+                    stopped = true;
+                }
+            }
+        }
+
+    protected:
+        /// Size of the next batch of a worker that took \p elapsed seconds for \p batch primes.
+        uint64_t next_batch_size(uint64_t batch, double elapsed) const
+        {
+            double rate = batch / std::max(elapsed, 1e-6);
+            // Grow at most twice, a single quick measurement may be misleading
+            double next = std::min(rate * _batchSeconds, 2.0 * batch);
+            return std::max<uint64_t>(1u, static_cast<uint64_t>(next));
+        }
+
+        /// Broadcasts the stop signal (a batch of size 0) to the workers.
+        void stop_workers()
+        {
+            uint64_t stop = 0;
+            for (int w = 1; w < _pCommunicator->size(); ++w) {
+                _pCommunicator->send(stop, w);
             }
         }
+
+        /// Whether the master has sent the stop signal, which is the only message it sends during a batch.
+        bool stop_received()
+        {
+            if (!_pCommunicator->iprobe(0)) return false;
+            uint64_t batch;
+            _pCommunicator->recv(batch, 0);
+            return batch == 0;
+        }
+
+        void send_batch_done(double elapsed)
+        {
+            uint64_t marker = BatchDone;
+            _pCommunicator->send(marker, 0);
+            _pCommunicator->send(elapsed, 0);
+        }
     };
 }
 
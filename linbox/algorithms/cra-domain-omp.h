@@ -1,9 +1,10 @@
 /* linbox/algorithms/cra-domain-omp.h
  * Copyright (C) 1999-2010 The LinBox group
  *
- * Naive parallel chinese remaindering
- * Launch NN iterations in parallel, where NN=omp_get_max_threads()
- * Then synchronization and termintation test.
+ * Asynchronous parallel chinese remaindering:
+ * each OpenMP thread pulls the next coprime from the shared prime iterator,
+ * computes its residue and folds it into the builder as soon as it is done.
+ * No new prime is handed out once the builder has terminated.
  * Time-stamp: <13 Mar 12 13:49:58 Jean-Guillaume.Dumas@imag.fr>
  *
  * ========LICENCE========
@@ -38,7 +39,9 @@
 #endif
 #include <omp.h>
 #include <set>
+#include <exception>
 #include "linbox/algorithms/cra-domain-sequential.h"
+#include "linbox/util/tracer.h"
 
 namespace LinBox
 {
@@ -58,76 +61,153 @@ namespace LinBox
 			Father_t(b)
 		{}
 
+		/** \brief The \ref CRA loop, run by all OpenMP threads.
+		 *
+		 * There are no rounds: every thread repeatedly samples a prime
+		 * that is coprime to both the current modulus and the primes
+		 * still being processed by the other threads, runs \p Iteration
+		 * on it and immediately feeds the residue to the builder.
+		 * Once the builder has terminated, no further prime is handed out
+		 * and the threads only finish the iterations already in flight.
+		 *
+		 * A RESTART invalidates every residue that was in flight when it
+		 * was received: those are counted as bad instead of being combined.
+		 */
 		template <class ResultType, class Function, class PrimeIterator>
 		ResultType& operator() (ResultType& res, Function& Iteration, PrimeIterator& primeiter)
 		{
 			using ResidueType = typename CRAResidue<ResultType,Function>::template ResidueType<Domain>;
 			size_t NN = omp_get_max_threads();
-			//std::cerr << "Blocs: " << NN << " iterations." << std::endl;
 			// commentator().start ("Parallel OMP Givaro::Modular iteration", "mmcrait");
 			if (NN == 1) return Father_t::operator()(res,Iteration,primeiter);
-
-			std::vector<Domain> ROUNDdomains; ROUNDdomains.reserve(NN);
-			std::vector<ResidueType> ROUNDresidues; ROUNDresidues.reserve(NN);
-			std::vector<IterationResult> ROUNDresults(NN);
-			std::set<Integer> coprimeset;
-
-			while (! this->Builder_.terminated()) {
-				ROUNDdomains.clear();
-				ROUNDresidues.clear();
-				coprimeset.clear();
-
-				while (coprimeset.size() < NN) {
-					coprimeset.emplace(this->get_coprime(primeiter));
-					++primeiter;
-				}
-
-				for(auto coprimesetiter = coprimeset.cbegin(); coprimesetiter != coprimeset.cend(); ++coprimesetiter) {
-					// std::cerr << "With prime: " << *coprimesetiter << std::endl;
-					ROUNDdomains.emplace_back(*coprimesetiter);
-					ROUNDresidues.emplace_back(CRAResidue<ResultType,Function>::create(ROUNDdomains.back()));
-				}
-
-#pragma omp parallel for
-				for(size_t i=0;i<NN;++i) {
-					ROUNDresults[i] = Iteration(ROUNDresidues[i], ROUNDdomains[i]);
-				}
-#pragma omp barrier
-
-				// if any thread says RESTART, then all CONTINUEs become SKIPs
-				bool anyrestart = false;
-				for (auto res : ROUNDresults) {
-					if (res == IterationResult::RESTART) anyrestart = true;
-				}
-				if (anyrestart) {
-					this->nbad_ += this->ngood_;
-					this->ngood_ = 0;
-				}
-
-				for (size_t i = 0; i < NN; ++i) {
-					if (ROUNDresults[i] == IterationResult::SKIP) {
-						this->doskip();
+			this->resume_if_requested(primeiter);
+
+			std::set<Integer> inflight;	// primes handed out but not yet combined
+			size_t epoch = 0;			// incremented at each RESTART
+			bool done = false;
+			std::exception_ptr failure;
+
+#pragma omp parallel shared(inflight, epoch, done, failure)
+			{
+				for (;;) {
+					Integer prime;
+					size_t startepoch = 0;
+					bool stop = false;
+
+#pragma omp critical (LinBoxCRAOMP)
+					{
+						if (done)
+							stop = true;
+						else {
+							try {
+								prime = next_coprime(primeiter, inflight);
+								inflight.insert(prime);
+								startepoch = epoch;
+							}
+							catch (...) {
+								failure = std::current_exception();
+								done = stop = true;
+							}
+						}
 					}
-					else if (anyrestart && ROUNDresults[i] == IterationResult::CONTINUE) {
-						// commentator should indicate that this prime is bad
-						++this->nbad_;
+					if (stop) break;
+
+					Domain D(prime);
+					ResidueType r(CRAResidue<ResultType,Function>::create(D));
+					IterationResult status;
+					try {
+						LINBOX_TRACE_SPAN("CRA prime");
+						status = Iteration(r, D);
 					}
-					else if (this->ngood_ == 0) {
-						this->ngood_ = 1;
-						this->Builder_.initialize(ROUNDdomains[i], ROUNDresidues[i]);
+					catch (...) {
+#pragma omp critical (LinBoxCRAOMP)
+						{
+							if (! failure) failure = std::current_exception();
+							done = true;
+						}
+						break;
 					}
-					else {
-						++this->ngood_;
-						this->Builder_.progress(ROUNDdomains[i], ROUNDresidues[i]);
+
+#pragma omp critical (LinBoxCRAOMP)
+					{
+						inflight.erase(prime);
+						if (! done) {
+							try {
+								combine(D, r, status, startepoch != epoch);
+								if (status == IterationResult::RESTART) ++epoch;
+								LINBOX_TRACE_COUNTER("CRA good primes", this->ngood_);
+								done = (this->ngood_ > 0) && this->Builder_.terminated();
+								this->checkpoint_if_due();
+							}
+							catch (...) {
+								failure = std::current_exception();
+								done = true;
+							}
+						}
 					}
 				}
-				//std::cerr << "Computed: " << iterCount() << " primes." << std::endl;
 			}
 
+			if (failure) std::rethrow_exception(failure);
+
 			// commentator().stop ("done", NULL, "mmcrait");
 			//std::cerr << "Used: " << this->iterCount() << " primes." << std::endl;
 			return this->Builder_.result(res);
 		}
+
+	protected:
+		/** \brief Next coprime from the iterator, distinct from the primes in flight.
+		 *
+		 * Must be called inside the critical section.
+		 */
+		template <class PrimeIterator>
+		Integer next_coprime(PrimeIterator& primeiter, const std::set<Integer>& inflight)
+		{
+			Integer prime;
+			int tries = 0;
+			do {
+				if (++tries > this->MAXNONCOPRIME)
+					throw LinboxError("LinBox ERROR: ran out of primes in CRA\n");
+				prime = this->get_coprime(primeiter);
+				++primeiter; ++this->nprimes_;
+			} while (inflight.find(prime) != inflight.end());
+			return prime;
+		}
+
+		/** \brief Folds one residue into the builder.
+		 *
+		 * Must be called inside the critical section.
+		 * \param stale  true if a RESTART was received while this residue
+		 * was being computed.
+		 */
+		template <class ResidueType>
+		void combine(const Domain& D, ResidueType& r, IterationResult status, bool stale)
+		{
+			switch (status) {
+			case IterationResult::SKIP:
+				this->doskip();
+				break;
+			case IterationResult::RESTART:
+				this->nbad_ += this->ngood_;
+				this->ngood_ = 1;
+				this->Builder_.initialize(D, r);
+				break;
+			case IterationResult::CONTINUE:
+				if (stale) {
+					// commentator should indicate that this prime is bad
+					++this->nbad_;
+				}
+				else if (this->ngood_ == 0) {
+					this->ngood_ = 1;
+					this->Builder_.initialize(D, r);
+				}
+				else {
+					++this->ngood_;
+					this->Builder_.progress(D, r);
+				}
+				break;
+			}
+		}
 	};
 }
 
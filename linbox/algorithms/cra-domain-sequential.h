@@ -34,9 +34,15 @@
 #include "linbox/integer.h"
 #include "linbox/solutions/methods.h"
 #include "linbox/vector/blas-vector.h"
+#include "linbox/util/serialization.h"
 #include <utility>
 #include <stdlib.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
 #include "linbox/util/commentator.h"
+#include "linbox/util/tracer.h"
 
 namespace LinBox
 {
@@ -51,12 +57,16 @@ namespace LinBox
 	public:
 		const int MAXSKIP = 1000;
 		const int MAXNONCOPRIME = 1000;
+		static constexpr uint32_t CHECKPOINT_MAGIC = 0x5243424cU; // "LBCR"
 
 	protected:
 		CRABase Builder_;
 		int ngood_ = 0;
 		int nbad_ = 0;
 		int nskip_ = 0;
+		uint64_t nprimes_ = 0; // primes drawn from the iterator by the loop
+		std::string checkpointFile_;
+		int checkpointPeriod_ = 0;
 
 		/** \brief Helper class to sample unique primes.
 		*/
@@ -104,6 +114,46 @@ namespace LinBox
 			return PrimeSampler<PrimeIterator>(*this, primeiter)();
 		}
 
+		/** \brief Builder state, for the builders that can be checkpointed.
+		 */
+		template <class Builder>
+		static auto serialize_builder(std::vector<uint8_t>& bytes, const Builder& B, int) -> decltype(B.serialize(bytes)) {
+			return B.serialize(bytes);
+		}
+
+		template <class Builder>
+		static uint64_t serialize_builder(std::vector<uint8_t>&, const Builder&, long) {
+			throw LinboxError("LinBox ERROR: this CRA builder cannot be checkpointed\n");
+		}
+
+		template <class Builder>
+		static auto unserialize_builder(Builder& B, const std::vector<uint8_t>& bytes, uint64_t offset, int) -> decltype(B.unserialize(bytes, offset)) {
+			return B.unserialize(bytes, offset);
+		}
+
+		template <class Builder>
+		static uint64_t unserialize_builder(Builder&, const std::vector<uint8_t>&, uint64_t, long) {
+			throw LinboxError("LinBox ERROR: this CRA builder cannot be checkpointed\n");
+		}
+
+		/** \brief Writes the checkpoint file if one is due after this iteration.
+		 */
+		void checkpoint_if_due() const {
+			if (checkpointPeriod_ > 0 && ! checkpointFile_.empty()
+			    && iterCount() % checkpointPeriod_ == 0) {
+				if (! checkpoint(checkpointFile_))
+					commentator().report(Commentator::LEVEL_IMPORTANT,INTERNAL_WARNING) << "could not write CRA checkpoint to " << checkpointFile_ << "\n";
+			}
+		}
+
+		/** \brief Resumes from the checkpoint file, if any, before the first iteration.
+		 */
+		template <class PrimeIterator>
+		void resume_if_requested(PrimeIterator& primeiter) {
+			if (! checkpointFile_.empty() && iterCount() == 0 && resume(checkpointFile_, primeiter))
+				commentator().report(Commentator::LEVEL_IMPORTANT,INTERNAL_DESCRIPTION) << "resumed CRA from " << checkpointFile_ << " after " << iterCount() << " iterations\n";
+		}
+
 	public:
 		/** \brief Pass-through constructor to create the underlying builder.
 		 */
@@ -120,6 +170,101 @@ namespace LinBox
 			return ngood_ + nbad_;
 		}
 
+		/** \brief How many primes the loop has drawn from the iterator,
+		 * including those of a resumed checkpoint.
+		 */
+		uint64_t primeCount() const {
+			return nprimes_;
+		}
+
+		/** \brief Periodically saves the CRA state to a file.
+		 *
+		 * Every \p period iterations, the loop writes the termination
+		 * counters, the number of primes drawn from the iterator and the
+		 * state of the builder (modulus and residues) to \p filename.
+		 * A full CRA run started with the same file resumes from it.
+		 * An empty filename disables checkpointing.
+		 */
+		void setCheckpoint(const std::string& filename, int period = 1)
+		{
+			checkpointFile_ = filename;
+			checkpointPeriod_ = period;
+		}
+
+		/** \brief Appends the CRA state to \p bytes.
+		 *
+		 * Format is: a magic number, the counters (good, bad and skipped
+		 * in a row), the number of primes drawn, then the builder state.
+		 */
+		uint64_t serialize(std::vector<uint8_t>& bytes) const
+		{
+			auto bytesWritten = LinBox::serialize(bytes, CHECKPOINT_MAGIC);
+			bytesWritten += LinBox::serialize(bytes, static_cast<int32_t>(ngood_));
+			bytesWritten += LinBox::serialize(bytes, static_cast<int32_t>(nbad_));
+			bytesWritten += LinBox::serialize(bytes, static_cast<int32_t>(nskip_));
+			bytesWritten += LinBox::serialize(bytes, nprimes_);
+			bytesWritten += serialize_builder(bytes, Builder_, 0);
+			return bytesWritten;
+		}
+
+		/** \brief Restores the CRA state written by serialize().
+		 *
+		 * The builder must have been created with the same parameters.
+		 */
+		uint64_t unserialize(const std::vector<uint8_t>& bytes, uint64_t offset = 0u)
+		{
+			uint32_t magic;
+			int32_t ngood, nbad, nskip;
+			uint64_t bytesRead = 0u;
+			bytesRead += LinBox::unserialize(magic, bytes, offset + bytesRead);
+			if (magic != CHECKPOINT_MAGIC)
+				throw LinboxError("LinBox ERROR: not a CRA checkpoint\n");
+			bytesRead += LinBox::unserialize(ngood, bytes, offset + bytesRead);
+			bytesRead += LinBox::unserialize(nbad, bytes, offset + bytesRead);
+			bytesRead += LinBox::unserialize(nskip, bytes, offset + bytesRead);
+			bytesRead += LinBox::unserialize(nprimes_, bytes, offset + bytesRead);
+			bytesRead += unserialize_builder(Builder_, bytes, offset + bytesRead, 0);
+			ngood_ = ngood; nbad_ = nbad; nskip_ = nskip;
+			return bytesRead;
+		}
+
+		/** \brief Writes the CRA state to \p filename.
+		 *
+		 * The file is replaced atomically, so that a job killed while
+		 * writing still leaves the previous checkpoint intact.
+		 * \return false if the file could not be written.
+		 */
+		bool checkpoint(const std::string& filename) const
+		{
+			std::vector<uint8_t> bytes;
+			serialize(bytes);
+			std::string tmpname = filename + ".tmp";
+			std::ofstream out(tmpname, std::ios::binary | std::ios::trunc);
+			out.write(reinterpret_cast<const char*>(bytes.data()), (std::streamsize)bytes.size());
+			out.close();
+			if (! out) return false;
+			return std::rename(tmpname.c_str(), filename.c_str()) == 0;
+		}
+
+		/** \brief Restores the CRA state from \p filename.
+		 *
+		 * \p primeiter is advanced past the primes already drawn, so that
+		 * iterators sampling unique primes do not hand them out again;
+		 * for the others, the coprimality check against the restored
+		 * modulus rejects them.
+		 * \return false if there is no such file.
+		 */
+		template <class PrimeIterator>
+		bool resume(const std::string& filename, PrimeIterator& primeiter)
+		{
+			std::ifstream in(filename, std::ios::binary);
+			if (! in) return false;
+			std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+			unserialize(bytes);
+			for (uint64_t i = 0; i < nprimes_; ++i) ++primeiter;
+			return true;
+		}
+
             /** \brief The \ref CRA loop
              *
              * Given a function to generate residues \c mod a single prime,
@@ -144,6 +289,7 @@ namespace LinBox
 		ResultType& operator() (ResultType& res, Function& Iteration, PrimeIterator& primeiter)
             {
                 commentator().start ("Givaro::Modular iteration", "mmcravit");
+				resume_if_requested(primeiter);
 				(*this)(-1, res, Iteration, primeiter);
                 commentator().stop ("done", NULL, "mmcravit");
 				return res;
@@ -174,10 +320,11 @@ namespace LinBox
 		bool operator() (int k, ResultType& res, Function& Iteration, PrimeIterator& primeiter)
             {
 				while (k != 0 && ngood_ == 0) {
+					LINBOX_TRACE_SPAN("CRA prime");
 					--k;
 					Domain D(*primeiter);
                     commentator().report(Commentator::LEVEL_IMPORTANT, INTERNAL_DESCRIPTION) << "With prime " << *primeiter << std::endl;
-					++primeiter;
+					++primeiter; ++nprimes_;
 					auto r = CRAResidue<ResultType,Function>::create(D);
 #ifdef _LB_CRATIMING
                     Timer chrono; chrono.start();
@@ -189,6 +336,7 @@ namespace LinBox
 						++ngood_;
 						Builder_.initialize(D,r);
 					}
+					checkpoint_if_due();
 #ifdef _LB_CRATIMING
                     chrono.stop();
                     std::clog << "1st iter : " << chrono << std::endl;
@@ -196,10 +344,11 @@ namespace LinBox
 				}
 
 				while (k != 0 && ! Builder_.terminated()) {
+					LINBOX_TRACE_SPAN("CRA prime");
 					--k;
 					Domain D(get_coprime(primeiter));
                     commentator().report(Commentator::LEVEL_IMPORTANT, INTERNAL_DESCRIPTION) << "With prime " << *primeiter << std::endl;
-					++primeiter;
+					++primeiter; ++nprimes_;
 					auto r = CRAResidue<ResultType,Function>::create(D);
 
 					switch (Iteration(r, D)) {
@@ -217,6 +366,8 @@ namespace LinBox
 						Builder_.initialize(D, r);
 						break;
 					}
+					LINBOX_TRACE_COUNTER("CRA good primes", ngood_);
+					checkpoint_if_due();
 				}
 
                 Builder_.result(res);
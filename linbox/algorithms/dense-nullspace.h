@@ -95,6 +95,21 @@ namespace LinBox
 			BlasMatrix<typename DenseMat::Field> & Ker,
 			size_t & kerdim);
 
+	/*! Nullspace of a word packed dense matrix over \c GF2 (M4RI).
+	 * Same conventions as above ; \p A is preserved by both.
+	 */
+	inline size_t&
+	NullSpaceBasisIn (const Tag::Side Side,
+			M4RIMatrix & A,
+			M4RIMatrix & Ker,
+			size_t & kerdim);
+
+	inline size_t&
+	NullSpaceBasis (const Tag::Side Side,
+			const M4RIMatrix & A,
+			M4RIMatrix & Ker,
+			size_t & kerdim);
+
 
 
 } // LinBox
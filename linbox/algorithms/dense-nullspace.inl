@@ -26,6 +26,7 @@
 #define __LINBOX_dense_nullspace_INL
 
 #include "linbox/matrix/dense-matrix.h"
+#include "linbox/matrix/matrixdomain/matrix-domain-m4ri.h"
 
 #include "fflas-ffpack/ffpack/ffpack.h" // LU
 #include "fflas-ffpack/fflas/fflas.h" // trsm
@@ -459,6 +460,31 @@ namespace LinBox
 		return NullSpaceBasisIn<typename DenseMat::Field>(Side,B,Ker,kerdim);
 	}
 
+	inline size_t&
+	NullSpaceBasis (const Tag::Side Side,
+			const M4RIMatrix & A,
+			M4RIMatrix & Ker,
+			size_t & kerdim)
+	{
+		M4RIDomain D (A.field());
+		if (Side == Tag::Side::Right)
+			kerdim = D.nullspaceBasisRight(Ker, A);
+		else {
+			assert(Side == Tag::Side::Left);
+			kerdim = D.nullspaceBasisLeft(Ker, A);
+		}
+		return kerdim;
+	}
+
+	inline size_t&
+	NullSpaceBasisIn (const Tag::Side Side,
+			M4RIMatrix & A,
+			M4RIMatrix & Ker,
+			size_t & kerdim)
+	{
+		return NullSpaceBasis(Side, A, Ker, kerdim);
+	}
+
 
 } // LinBox
 
@@ -92,6 +92,8 @@ namespace LinBox {
 
         BlasMatrixDomain<Field> _bmdf;
 
+        size_t _digitsPerStep = 1; // p-adic digits per lifting step in solveNonsingular
+
 #ifdef RSTIMING
         mutable Timer tSetup, ttSetup, tFastInvert,
             ttFastInvert,                                               // only done in deterministic or inconsistent
@@ -143,6 +145,11 @@ namespace LinBox {
 #endif
         }
 
+        /** Number of p-adic digits lifted per step by solveNonsingular,
+         * see LiftingContainerBase::setDigitsPerStep.
+         */
+        void setDigitsPerStep(size_t k) { _digitsPerStep = k; }
+
         /** Solve a linear system \c Ax=b over quotient field of a ring.
          *
          * @param num Vector of numerators of the solution
@@ -191,6 +198,30 @@ namespace LinBox {
         SolverReturnStatus solveNonsingular(Vector1& num, Integer& den, const IMatrix& A, const Vector2& b, bool s = false,
                                             int maxPrimes = DEFAULT_MAXPRIMES);
 
+        /** Solve a nonsingular, square linear system \c AX=B for a block of right-hand sides.
+         *
+         * A is inverted once modulo p and all the columns are lifted together
+         * by a DixonBlockLiftingContainer, each step being one product modulo p^k
+         * and one integer product by A on a block. Each column is then
+         * reconstructed by RationalReconstruction, with early termination.
+         *
+         * @param Num       Matrix of numerators of the solutions
+         * @param Den       Denominators: <code>1/Den[j] * Num[j]</code> is the rational
+         * solution of <code>A x = B[j]</code>, for each column j
+         * @param A         Matrix of linear system (it must be square)
+         * @param B         Right-hand sides, one per column
+         * @param maxPrimes maximum number of moduli to try
+         *
+         * @return status of solution :
+         *   - \c SS_FAILED   the reconstruction failed;
+         *   - \c SS_OK       solutions found;
+         *   - \c SS_SINGULAR system appreared singular mod all primes.
+         *   .
+         */
+        template <class IMatrix>
+        SolverReturnStatus solveNonsingular(BlasMatrix<Ring>& Num, BlasVector<Ring>& Den, const IMatrix& A,
+                                            const BlasMatrix<Ring>& B, int maxPrimes = DEFAULT_MAXPRIMES);
+
         /** Solve a general rectangular linear system \c Ax=b over quotient field of a ring.
          *  If A is known to be square and nonsingular, calling solveNonsingular is more efficient.
          *
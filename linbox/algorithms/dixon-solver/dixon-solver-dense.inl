@@ -130,6 +130,7 @@ namespace LinBox {
 
         typedef DixonLiftingContainer<Ring, Field, IMatrix, BlasMatrix<Field>> LiftingContainer;
         LiftingContainer lc(_ring, *F, A, *FMP, b, _prime);
+        if (_digitsPerStep > 1) lc.setDigitsPerStep(_digitsPerStep);
         RationalReconstruction<LiftingContainer> re(lc);
         if (!re.getRational(num, den, 0)) {
             delete FMP;
@@ -143,6 +144,109 @@ namespace LinBox {
         return SS_OK;
     }
 
+    template <class Ring, class Field, class RandomPrime>
+    template <class IMatrix>
+    SolverReturnStatus DixonSolver<Ring, Field, RandomPrime, Method::DenseElimination>::solveNonsingular(
+        BlasMatrix<Ring>& Num, BlasVector<Ring>& Den, const IMatrix& A, const BlasMatrix<Ring>& B, int maxPrimes)
+    {
+        linbox_check(A.rowdim() == A.coldim());
+        linbox_check(A.rowdim() == B.rowdim());
+        linbox_check(Num.rowdim() == A.coldim() && Num.coldim() == B.coldim());
+        linbox_check(Den.size() == B.coldim());
+
+        const size_t n = A.coldim();
+        const size_t s = B.coldim();
+
+        // Invert A mod p once for all the right-hand sides.
+        Field* F = NULL;
+        BlasMatrix<Field>* invA = NULL;
+        int notfr = 1;
+        for (int trials = 0; notfr && trials < maxPrimes; ++trials) {
+            if (trials != 0) chooseNewPrime();
+            if (invA != NULL) delete invA;
+            if (F != NULL) delete F;
+
+            F = new Field(_prime);
+            BlasMatrix<Field> Ap(*F, n, n);
+            MatrixHom::map(Ap, A);
+            invA = new BlasMatrix<Field>(*F, n, n);
+            BlasMatrixDomain<Field> BMDF(*F);
+            BMDF.invin(*invA, Ap, notfr); // notfr <- nullity
+        }
+        if (notfr) {
+            delete invA;
+            delete F;
+            return SS_SINGULAR;
+        }
+
+        // Bounds of the solutions: the bound of the column of largest norm holds for all of them.
+        Integer numbound, denbound;
+        double maxLogBound;
+        {
+            size_t jmax = 0;
+            Integer norm, maxnorm, t;
+            _ring.assign(maxnorm, _ring.zero);
+            for (size_t j = 0; j < s; ++j) {
+                _ring.assign(norm, _ring.zero);
+                for (size_t i = 0; i < n; ++i) {
+                    _ring.assign(t, B.getEntry(i, j));
+                    _ring.axpyin(norm, t, t);
+                }
+                if (_ring.compare(norm, maxnorm) > 0) {
+                    _ring.assign(maxnorm, norm);
+                    jmax = j;
+                }
+            }
+            BlasVector<Ring> bj(_ring, n);
+            for (size_t i = 0; i < n; ++i) _ring.assign(bj[i], B.getEntry(i, jmax));
+            auto hb = RationalSolveHadamardBound(A, bj);
+            _ring.init(numbound, LinBox::integer(1) << static_cast<uint64_t>(std::ceil(hb.numLogBound)));
+            _ring.init(denbound, LinBox::integer(1) << static_cast<uint64_t>(std::ceil(hb.denLogBound)));
+            maxLogBound = 1 + hb.numLogBound + hb.denLogBound;
+        }
+
+        // Lifting of all the columns together, k = _digitsPerStep digits per step,
+        // then a rational reconstruction per column, with early termination.
+        typedef DixonBlockLiftingContainer<Ring, Field, IMatrix> BlockContainer;
+        typedef typename BlockContainer::Column Column;
+        SolverReturnStatus status = SS_OK;
+        {
+            Integer p;
+            _ring.init(p, _prime);
+            BlockContainer blc(_ring, A, *invA, B, p, _digitsPerStep, numbound, denbound, maxLogBound);
+
+            BlasVector<Ring> num(_ring, n), Anum(_ring, n);
+            Integer den, t;
+            for (size_t j = 0; j < s; ++j) {
+                Column col(blc, j);
+                RationalReconstruction<Column> re(col, _ring);
+                bool ok = re.getRational(num, den, 1);
+
+                // early termination may stop too soon: check A num = den B[j],
+                // or reconstruct from all the digits
+                if (ok) {
+                    A.apply(Anum, num);
+                    for (size_t i = 0; ok && i < n; ++i) {
+                        _ring.mul(t, den, B.getEntry(i, j));
+                        ok = _ring.areEqual(t, Anum[i]);
+                    }
+                }
+                if (!ok && !re.getRational(num, den, 0)) {
+                    status = SS_FAILED;
+                    break;
+                }
+
+                for (size_t i = 0; i < n; ++i) Num.setEntry(i, j, num[i]);
+                _ring.assign(Den[j], den);
+            }
+        }
+
+        delete invA;
+        delete F;
+
+        return status;
+    }
+
     template <class Ring, class Field, class RandomPrime>
     template <class IMatrix, class Vector1, class Vector2>
     SolverReturnStatus DixonSolver<Ring, Field, RandomPrime, Method::DenseElimination>::solveSingular(
@@ -37,6 +37,7 @@
 #include "linbox/vector/vector-domain.h"
 #include "linbox/algorithms/gauss.h"
 #include "linbox/blackbox/zo-gf2.h"
+#include "linbox/matrix/matrixdomain/matrix-domain-m4ri.h"
 
 /** @file algorithms/gauss-gf2.h
  * @brief  Gauss elimination and applications for sparse matrices on \f$F_2\f$.
@@ -178,6 +179,13 @@ namespace LinBox
 				 const Vector2& b, Random& generator) const;
 
 
+		/** \brief Sparse in place Gaussian elimination with reordering, as QLUPin, without L and Q.
+		 *
+		 * Once the remaining rows are dense enough (more than
+		 * \c __LINBOX_GF2_SpD_DENSITY__ of their entries are non zero),
+		 * they are eliminated as a word packed dense matrix, by M4RI, and the
+		 * result is put back as sparse rows.
+		 */
 		template <class SparseSeqMatrix, class Perm>
 		size_t& InPlaceLinearPivoting(size_t &Rank,
 						     Element& determinant,
@@ -216,6 +224,20 @@ namespace LinBox
 				    const size_t &indcol,
 				    const long &indpermut) const;
 
+		//-----------------------------------------
+		// Dense elimination of the rows k..Ni-1,
+		// whose entries are in the columns Rank..Nj-1.
+		// Their pivots are moved to the columns
+		// Rank.. by P, in all the rows.
+		//-----------------------------------------
+		template <class SparseSeqMatrix, class Perm>
+		void DenseEliminationBinary (size_t &Rank,
+					     SparseSeqMatrix &LigneA,
+					     Perm &P,
+					     size_t k,
+					     size_t Ni,
+					     size_t Nj) const;
+
 		//------------------------------------------
 		// Looking for a non-zero pivot in a row
 		// Using the column density for reordering
@@ -29,7 +29,10 @@
 
 #include "linbox/algorithms/gauss.h"
 #include "linbox/util/commentator.h"
+#include "linbox/util/tracer.h"
 #include <utility>
+#include <vector>
+#include <algorithm>
 
 #ifdef __LINBOX_ALL__ //BB: ???
 #ifndef __LINBOX_COUNT__
@@ -43,6 +46,15 @@
 #endif
 #endif
 
+#ifndef __LINBOX_GF2_SpD_DENSITY__
+// Density of the remaining rows above which they are eliminated as a dense matrix
+#define __LINBOX_GF2_SpD_DENSITY__ 0.02
+#endif
+#ifndef __LINBOX_GF2_SpD_MINDIM__
+// No dense switch for fewer remaining rows or columns
+#define __LINBOX_GF2_SpD_MINDIM__ 64
+#endif
+
 namespace LinBox
 {
 	// Specialization over GF2
@@ -59,6 +71,7 @@ namespace LinBox
 		// In place (LigneA is modified)
 		// With reordering (D is a density type. Density is allocated here)
 		//    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+		LINBOX_TRACE_SPAN("Gaussian elimination GF2");
 		commentator().start ("Gaussian elimination with reordering over GF2",
 				   "IPLRGF2", Ni);
 		commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
@@ -74,9 +87,13 @@ namespace LinBox
 
 
 		// assignment of LigneA with the domain object
-		for (size_t jj = 0; jj < Ni; ++jj)
+		// nbnz: number of entries of the rows not yet eliminated
+		size_t nbnz = 0;
+		for (size_t jj = 0; jj < Ni; ++jj) {
 			for (size_t k = 0; k < LigneA[jj].size(); ++k)
 				++col_density[LigneA[jj][k]];
+			nbnz += LigneA[jj].size();
+		}
 
 		long last = (long)Ni - 1;
 		long c;
@@ -91,9 +108,21 @@ namespace LinBox
 		// Elimination steps with reordering
 
 		typename SparseSeqMatrix::iterator LigneA_k = LigneA.begin();
-		for (long k = 0; k < last; ++k, ++LigneA_k) {
+		bool dense = false;
+		long k;
+		for (k = 0; k < last; ++k, ++LigneA_k) {
 			long p = k, s = 0;
 
+			// the remaining rows have their entries in the columns Rank..Nj-1
+			const size_t sNi = Ni-(size_t)k, sNj = Nj-Rank;
+			if ( (sNi >= __LINBOX_GF2_SpD_MINDIM__) && (sNj >= __LINBOX_GF2_SpD_MINDIM__)
+			     && (double)nbnz > __LINBOX_GF2_SpD_DENSITY__*(double)sNi*(double)sNj ) {
+				commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
+				<< "Dense switch: " << sNi << 'x' << sNj << ", " << nbnz << " entries" << std::endl;
+				dense = true;
+				break;
+			}
+
 #ifdef __LINBOX_FILLIN__
 			if ( ! (k % 100) )
 #else
@@ -149,9 +178,12 @@ namespace LinBox
 							permuteBinary( LigneA[(size_t)ll], Rank, c);
 					}
 					long npiv=(long)LigneA_k->size();
+					nbnz -= (size_t)npiv;
 					for (ll = k+1; ll < static_cast<long>(Ni); ++ll) {
 						bool elim=false;
+						nbnz -= LigneA[(size_t)ll].size();
 						eliminateBinary (elim, LigneA[(size_t)ll], *LigneA_k, Rank, c, (size_t)npiv, col_density);
+						nbnz += LigneA[(size_t)ll].size();
 					}
 				}
 
@@ -163,12 +195,16 @@ namespace LinBox
 			// LigneA.write(rep << "U:= ", Tag::FileFormat::Maple) << std::endl;
 		}//for k
 
-		SparseFindPivotBinary ( LigneA[(size_t)last], Rank, c, determinant);
-		if (c != -1) {
-			if ( c != (static_cast<long>(Rank)-1) ) {
-				P.permute(Rank-1,(size_t)c);
-				for (long ll=0      ; ll < last ; ++ll)
-					permuteBinary( LigneA[(size_t)ll], Rank, c);
+		if (dense)
+			DenseEliminationBinary (Rank, LigneA, P, (size_t)k, Ni, Nj);
+		else {
+			SparseFindPivotBinary ( LigneA[(size_t)last], Rank, c, determinant);
+			if (c != -1) {
+				if ( c != (static_cast<long>(Rank)-1) ) {
+					P.permute(Rank-1,(size_t)c);
+					for (long ll=0      ; ll < last ; ++ll)
+						permuteBinary( LigneA[(size_t)ll], Rank, c);
+				}
 			}
 		}
 
@@ -208,6 +244,69 @@ namespace LinBox
 		return Rank;
 	}
 
+	template <class SparseSeqMatrix, class Perm>
+	inline void
+	GaussDomain<GF2>::DenseEliminationBinary (size_t &Rank,
+						  SparseSeqMatrix &LigneA,
+						  Perm &P,
+						  size_t k,
+						  size_t Ni,
+						  size_t Nj) const
+	{
+		LINBOX_TRACE_SPAN("Gaussian elimination GF2 dense");
+		const size_t sNi = Ni-k, sNj = Nj-Rank;
+		const GF2 F2;
+		M4RIMatrix S (F2, sNi, sNj);
+		for (size_t i = 0; i < sNi; ++i) {
+			for (size_t j = 0; j < LigneA[k+i].size(); ++j)
+				S.setEntry (i, LigneA[k+i][j]-Rank, true);
+			LigneA[k+i].resize(0);
+		}
+
+		std::vector<size_t> Pc;
+		const size_t R2 = M4RIDomain (F2).rowEchelon (S, Pc);
+
+		// pivot i goes to the column Rank+i ; colS[j] is the column of S now at Rank+j
+		std::vector<size_t> colS (sNj);
+		for (size_t j = 0; j < sNj; ++j)
+			colS[j] = j;
+		bool permuted = false;
+		for (size_t i = 0; i < R2; ++i)
+			if (Pc[i] != i) {
+				P.permute (Rank+i, Rank+Pc[i]);
+				std::swap (colS[i], colS[Pc[i]]);
+				permuted = true;
+			}
+
+		if (permuted) {
+			std::vector<size_t> newcol (sNj);
+			for (size_t j = 0; j < sNj; ++j)
+				newcol[colS[j]] = j;
+			for (size_t l = 0; l < k; ++l) {
+				typename SparseSeqMatrix::value_type & row = LigneA[l];
+				typename SparseSeqMatrix::value_type::iterator it =
+				std::lower_bound (row.begin(), row.end(), Rank);
+				if (it == row.end()) continue;
+				for (typename SparseSeqMatrix::value_type::iterator jt = it; jt != row.end(); ++jt)
+					*jt = Rank+newcol[*jt-Rank];
+				std::sort (it, row.end());
+			}
+		}
+
+		// U, back in the rows k..k+R2-1
+		std::vector<size_t> tmp;
+		for (size_t i = 0; i < R2; ++i) {
+			tmp.resize(0);
+			for (size_t j = i; j < sNj; ++j)
+				if (S.getEntry (i, colS[j]))
+					tmp.push_back (Rank+j);
+			LigneA[k+i].resize (tmp.size());
+			std::copy (tmp.begin(), tmp.end(), LigneA[k+i].begin());
+		}
+
+		Rank += R2;
+	}
+
 	// Specialization over GF2
 	template <class SparseSeqMatrix, class Perm> inline size_t&
 	GaussDomain<GF2>::QLUPin (size_t &Rank,
@@ -227,6 +326,7 @@ namespace LinBox
 		// In place (LigneA is modified)
 		// With reordering (D is a density type. Density is allocated here)
 		//    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+		LINBOX_TRACE_SPAN("Gaussian elimination GF2");
 		commentator().start ("Gaussian elimination with reordering over GF2",
 				   "IPLRGF2", Ni);
 		commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
@@ -34,6 +34,7 @@
 
 #include "linbox/algorithms/gauss.h"
 #include "linbox/util/commentator.h"
+#include "linbox/util/tracer.h"
 #include <givaro/zring.h>
 #include <givaro/ring-interface.h>
 #include <utility>
@@ -81,6 +82,7 @@ namespace LinBox
         // In place (LigneA is modified)
         // With reordering (D is a density type. Density is allocated here)
         //    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+        LINBOX_TRACE_SPAN("Gaussian elimination QLUPin");
         commentator().start ("QLUPin Gaussian elimination with reordering",
                      "IPLR", Ni);
         commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
@@ -480,6 +482,7 @@ namespace LinBox
         // In place (LigneA is modified)
         // With reordering (D is a density type. Density is allocated here)
         //    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+        LINBOX_TRACE_SPAN("Gaussian elimination IPLR");
         commentator().start ("IPLR Gaussian elimination with reordering",
                      "IPLR", Ni);
         field().write( commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
@@ -623,6 +626,7 @@ namespace LinBox
         // In place (LigneA is modified)
         // With reordering (D is a density type. Density is allocated here)
         //    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+        LINBOX_TRACE_SPAN("Gaussian elimination IPperm");
         commentator().start ("IPperm Gaussian elimination with reordering",
                      "IPLR", Ni);
         field().write( commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
@@ -774,6 +778,7 @@ namespace LinBox
         // Without reordering (Pivot is first non-zero in row)
         //     long Ni = SLA.n_row (), Nj = SLA.n_col ();
         //    long Ni = LigneA.n_row (), Nj = LigneA.n_col ();
+        LINBOX_TRACE_SPAN("Gaussian elimination NoReordering");
         commentator().start ("Gaussian elimination (no reordering)",
                      "NoRe", Ni);
         commentator().report (Commentator::LEVEL_NORMAL, INTERNAL_DESCRIPTION)
@@ -0,0 +1,261 @@
+/* linbox/algorithms/incremental-det.h
+ * Copyright (C) LinBox
+ *
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ *.
+ */
+
+/*! @file algorithms/incremental-det.h
+ * @ingroup algorithms
+ * @brief Determinants of integer matrices differing by rank-one updates.
+ */
+
+#ifndef __LINBOX_incremental_det_H
+#define __LINBOX_incremental_det_H
+
+#include <vector>
+#include "fflas-ffpack/ffpack/ffpack.h"
+#include "linbox/integer.h"
+#include "linbox/ring/modular.h"
+#include "linbox/field/field-traits.h"
+#include "linbox/matrix/dense-matrix.h"
+#include "linbox/algorithms/cra-builder-single.h"
+#include "linbox/randiter/random-prime.h"
+#include "linbox/util/error.h"
+
+namespace LinBox
+{
+
+	/** @brief Determinant of an integer matrix under rank-one updates.
+	 *
+	 * The determinant is reconstructed by early terminated chinese
+	 * remaindering, as in the integer cra_det. For every prime used so far,
+	 * the inverse of the matrix and its determinant modulo p are kept, so
+	 * that after a rank-one update <code>A + u v^T</code> (e.g. replacing a
+	 * row or a column) both are updated in \f$O(n^2)\f$ per prime, by the
+	 * matrix determinant lemma
+	 * <code>det(A + u v^T) = (1 + v^T A^{-1} u) det(A)</code>
+	 * and the Sherman-Morrison formula, instead of a new factorization.
+	 *
+	 * Only the primes for which the updated matrix becomes singular are
+	 * factored again, at the next update. New primes are factored once,
+	 * when the previous ones are not enough for the early termination.
+	 */
+	template <class Field = Givaro::Modular<double> >
+	class IncrementalDeterminant {
+	public:
+		typedef Givaro::ZRing<Integer>		Ring;
+		typedef BlasMatrix<Ring>		IMatrix;
+		typedef typename Field::Element		Element;
+
+	protected:
+		/// Images modulo one prime of the current matrix
+		struct Image {
+			Field F;
+			std::vector<Element> inverse;	// A^{-1} mod p, row major, when not singular
+			Element det;
+			bool singular;
+
+			Image(const Integer& p) :
+				F(p), singular(true)
+			{ F.assign(det, F.zero); }
+		};
+
+		IMatrix				_A;
+		std::vector<Image>		_images;
+		PrimeIterator<IteratorCategories::HeuristicTag> _genprime;
+		size_t				_threshold;
+
+	public:
+		/** @brief Starts from the integer square matrix \p A.
+		 * @param A  matrix, copied.
+		 * @param threshold  early termination threshold of the reconstruction.
+		 */
+		IncrementalDeterminant(const IMatrix& A, size_t threshold = LINBOX_DEFAULT_EARLY_TERMINATION_THRESHOLD) :
+			_A(A), _genprime(FieldTraits<Field>::bestBitSize(A.coldim())), _threshold(threshold)
+		{
+			if (A.coldim() != A.rowdim())
+				throw LinboxError("LinBox ERROR: matrix must be square for determinant computation\n");
+		}
+
+		/// The current matrix.
+		const IMatrix& matrix() const { return _A; }
+
+		/// Number of primes whose images are kept.
+		size_t primes() const { return _images.size(); }
+
+		/** @brief Determinant of the current matrix.
+		 *
+		 * Uses the images of the primes kept, and adds new primes only
+		 * if these are not enough for the early termination.
+		 */
+		Integer& det(Integer& d)
+		{
+			CRABuilderEarlySingle<Field> cra(_threshold);
+			size_t used = 0;
+			for (; used < _images.size(); ++used) {
+				combine(cra, used, _images[used]);
+				if (cra.terminated()) break;
+			}
+			while (! cra.terminated()) {
+				do { ++_genprime; } while (known(*_genprime));
+				_images.emplace_back(*_genprime);
+				factor(_images.back());
+				combine(cra, used++, _images.back());
+			}
+			return cra.result(d);
+		}
+
+		/** @brief Replaces row \p i by \p r.
+		 * @param r  vector of integers, of size the dimension.
+		 */
+		template <class Vector>
+		void replaceRow(size_t i, const Vector& r)
+		{
+			const size_t n = _A.coldim();
+			std::vector<Integer> v(n);
+			for (size_t j = 0; j < n; ++j)
+				v[j] = r[j] - _A.getEntry(i, j);
+			std::vector<Integer> u(n, Integer(0));
+			u[i] = 1;
+			for (size_t j = 0; j < n; ++j)
+				_A.setEntry(i, j, r[j]);
+			update(u, v);
+		}
+
+		/** @brief Replaces column \p j by \p c.
+		 * @param c  vector of integers, of size the dimension.
+		 */
+		template <class Vector>
+		void replaceColumn(size_t j, const Vector& c)
+		{
+			const size_t n = _A.rowdim();
+			std::vector<Integer> u(n);
+			for (size_t i = 0; i < n; ++i)
+				u[i] = c[i] - _A.getEntry(i, j);
+			std::vector<Integer> v(n, Integer(0));
+			v[j] = 1;
+			for (size_t i = 0; i < n; ++i)
+				_A.setEntry(i, j, c[i]);
+			update(u, v);
+		}
+
+		/** @brief Replaces the matrix by <code>A + u v^T</code>.
+		 */
+		template <class Vector1, class Vector2>
+		void rankOneUpdate(const Vector1& u, const Vector2& v)
+		{
+			const size_t n = _A.rowdim();
+			std::vector<Integer> uu(u.begin(), u.end()), vv(v.begin(), v.end());
+			for (size_t i = 0; i < n; ++i)
+				for (size_t j = 0; j < n; ++j)
+					_A.setEntry(i, j, _A.getEntry(i, j) + uu[i] * vv[j]);
+			update(uu, vv);
+		}
+
+	protected:
+		bool known(const Integer& p) const
+		{
+			for (const auto& image : _images) {
+				Integer q;
+				image.F.characteristic(q);
+				if (q == p) return true;
+			}
+			return false;
+		}
+
+		void combine(CRABuilderEarlySingle<Field>& cra, size_t index, const Image& image) const
+		{
+			if (index == 0)
+				cra.initialize(image.F, image.det);
+			else
+				cra.progress(image.F, image.det);
+		}
+
+		/// Determinant and inverse of the current matrix modulo the prime of \p image.
+		void factor(Image& image) const
+		{
+			const Field& F = image.F;
+			const size_t n = _A.rowdim();
+			std::vector<Element> Ap(n*n);
+			for (size_t i = 0; i < n; ++i)
+				for (size_t j = 0; j < n; ++j)
+					F.init(Ap[i*n+j], _A.getEntry(i, j));
+			std::vector<Element> LU(Ap);
+			FFPACK::Det(F, image.det, n, LU.data(), n);
+			image.singular = F.isZero(image.det);
+			if (image.singular) {
+				image.inverse.clear();
+				return;
+			}
+			int nullity;
+			image.inverse.resize(n*n);
+			FFPACK::Invert(F, n, Ap.data(), n, image.inverse.data(), n, nullity);
+		}
+
+		/// Updates all the images after <code>A <- A + u v^T</code>, already applied to _A.
+		void update(const std::vector<Integer>& u, const std::vector<Integer>& v)
+		{
+			const size_t n = _A.rowdim();
+			std::vector<Element> up(n), vp(n), w(n), z(n);
+			for (auto& image : _images) {
+				if (image.singular) {
+					factor(image);
+					continue;
+				}
+				const Field& F = image.F;
+				for (size_t i = 0; i < n; ++i) {
+					F.init(up[i], u[i]);
+					F.init(vp[i], v[i]);
+				}
+				// w <- A^{-1} u, z <- A^{-T} v
+				FFLAS::fgemv(F, FFLAS::FflasNoTrans, n, n, F.one, image.inverse.data(), n, up.data(), 1, F.zero, w.data(), 1);
+				FFLAS::fgemv(F, FFLAS::FflasTrans, n, n, F.one, image.inverse.data(), n, vp.data(), 1, F.zero, z.data(), 1);
+
+				// matrix determinant lemma
+				Element lambda;
+				F.add(lambda, F.one, FFLAS::fdot(F, n, vp.data(), 1, w.data(), 1));
+				F.mulin(image.det, lambda);
+				if (F.isZero(lambda)) {
+					image.singular = true;
+					image.inverse.clear();
+					continue;
+				}
+
+				// Sherman-Morrison: A^{-1} <- A^{-1} - (w z^T) / lambda
+				Element alpha;
+				F.inv(alpha, lambda);
+				F.negin(alpha);
+				FFLAS::fger(F, n, n, alpha, w.data(), 1, z.data(), 1, image.inverse.data(), n);
+			}
+		}
+	};
+
+}
+
+#endif // __LINBOX_incremental_det_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -35,6 +35,7 @@
 
 #include "linbox/linbox-config.h"
 #include "linbox/util/debug.h"
+#include "linbox/util/tracer.h"
 
 #include "linbox/blackbox/apply.h"
 #include "linbox/blackbox/diagonal.h"
@@ -103,6 +104,8 @@ namespace LinBox
 		Integer_t                     _denbound;
 		MatrixApplyDomain<Ring,IMatrix>    _MAD;
 		//BlasApply<Ring>          _BA;
+		size_t                   _digitsPerStep; // p-adic digits per integer update
+		Integer_t                          _pk; // _p^_digitsPerStep
 
 
 
@@ -126,7 +129,7 @@ namespace LinBox
 
 		template <class Prime_Type, class Vector1>
 		LiftingContainerBase (const Ring& R, const IMatrix& A, const Vector1& b, const Prime_Type& p):
-			_matA(A), _intRing(R), _b(R,b.size()),_VDR(R), _MAD(R,A)
+			_matA(A), _intRing(R), _b(R,b.size()),_VDR(R), _MAD(R,A), _digitsPerStep(1)
 		{
 
 #ifdef RSTIMING
@@ -140,6 +143,7 @@ namespace LinBox
 			// initialise the prime as an Integer_t
 			//this->_intRing.init(_p,p);
 			this->convertPrime(_p, p);
+			_pk = _p;
 			//std::cout<<"padic base= "<<_p<<std::endl;
 
 
@@ -187,14 +191,38 @@ namespace LinBox
 
 		virtual IVector& nextdigit (IVector& , const IVector&) const = 0;
 
+		/** Computes the solution \c D of <code>A D = residu mod p^k</code>,
+		 * with \c k the number of digits per step and entries of \c D in <code>[0, p^k)</code>.
+		 * Only called when setDigitsPerStep() accepted some \c k > 1.
+		 */
+		virtual IVector& nextdigits (IVector& block, const IVector& residu) const
+		{
+			return nextdigit(block, residu);
+		}
+
+		/** Sets the number of digits per step \c k: iterators then lift
+		 * modulo <code>p^k</code> and update the integer residue once every \c k digits,
+		 * with one product by the matrix on entries of <code>k log(p)</code> bits.
+		 * Digits are still returned one at a time, in base \c p.
+		 * @returns false if the container does not support \c k.
+		 */
+		virtual bool setDigitsPerStep (size_t k)
+		{
+			return k <= 1;
+		}
+
 		class const_iterator {
 		private:
 			BlasVector<Ring>              _res;
 			const LiftingContainerBase    &_lc;
 			size_t                   _position;
+			BlasVector<Ring>            _block; // p-adic digits not yet returned
+			size_t                    _pending; // number of digits left in _block
+			BlasVector<Ring>              _tmp; // A * digit, its entries are reused from step to step
 		public:
 			const_iterator(const LiftingContainerBase& lc,size_t end=0) :
-				_res(lc._b), _lc(lc), _position(end)
+				_res(lc._b), _lc(lc), _position(end), _block(lc.ring()), _pending(0),
+				_tmp(lc.ring(), lc._matA.rowdim())
 			{}
 
 			/**
@@ -203,7 +231,10 @@ namespace LinBox
 			 */
 			bool next (IVector& digit)
 			{
+				if (_lc._digitsPerStep > 1)
+					return nextFromBlock(digit);
 
+				LINBOX_TRACE_SPAN("lifting step");
 #ifdef DEBUG_LC
 				linbox_check (digit.size() == _lc._matA.coldim());
 #endif
@@ -224,16 +255,15 @@ namespace LinBox
 #endif
 				/*  prepare for updating residu */
 
-				// compute v2 = _matA * digit
-				IVector v2 (_lc.ring(),_lc._matA.rowdim());
-				_lc._MAD.applyV(v2,digit, _res);
+				// compute _tmp = _matA * digit
+				_lc._MAD.applyV(_tmp,digit, _res);
 
 #ifdef DEBUG_LC
 
 				//_matA.write(std::cout<<"\n _matA :\n");
 				std::cout<<"\n A * digit "<<_position<<": ";
-				for (size_t i=0;i<v2.size();++i)
-					std::cout<<v2[i]<<",";
+				for (size_t i=0;i<_tmp.size();++i)
+					std::cout<<_tmp[i]<<",";
 
 #endif
 #ifdef RSTIMING
@@ -242,12 +272,11 @@ namespace LinBox
 				_lc.tRingOther.start();
 #endif
 
-				// update _res -= v2
-				_lc._VDR.subin (_res, v2);
-				typename BlasVector<Ring>::iterator p0;
-				// update _res = _res / p
-				int index=0;
-				for ( p0 = _res.begin(); p0 != _res.end(); ++ p0, ++index){
+				// update _res = (_res - _tmp) / p, in place
+				typename BlasVector<Ring>::iterator p0 = _res.begin();
+				typename BlasVector<Ring>::const_iterator v0 = _tmp.begin();
+				for ( ; p0 != _res.end(); ++ p0, ++ v0){
+					_lc._intRing.subin(*p0, *v0);
 #ifdef LC_CHECK_DIVISION
 					if (! _lc._intRing.isDivisor(*p0,_lc._p)) {
 						std::cout<<"residue "<<*p0<<" not divisible by modulus "<<_lc._p<<std::endl;
@@ -267,6 +296,59 @@ namespace LinBox
 				return true;
 			}
 
+		protected:
+			/** Returns the next p-adic digit of the current block,
+			 * lifting a new block of digits modulo p^k when all have been returned.
+			 */
+			bool nextFromBlock (IVector& digit)
+			{
+				if (_pending == 0) {
+					LINBOX_TRACE_SPAN("lifting block");
+					_block.resize(_lc._matA.coldim());
+
+					// compute the next k digits at once: A * block = _res mod p^k
+					_lc.nextdigits(_block, _res);
+#ifdef RSTIMING
+					_lc.tRingApply.start();
+#endif
+					_lc._MAD.applyV(_tmp, _block, _res);
+#ifdef RSTIMING
+					_lc.tRingApply.stop();
+					_lc.ttRingApply += _lc.tRingApply;
+					_lc.tRingOther.start();
+#endif
+					// update _res = (_res - _tmp) / p^k, in place
+					typename BlasVector<Ring>::iterator p0 = _res.begin();
+					typename BlasVector<Ring>::const_iterator v0 = _tmp.begin();
+					for ( ; p0 != _res.end(); ++ p0, ++ v0) {
+						_lc._intRing.subin(*p0, *v0);
+#ifdef LC_CHECK_DIVISION
+						if (! _lc._intRing.isDivisor(*p0,_lc._pk)) {
+							std::cout<<"residue "<<*p0<<" not divisible by modulus "<<_lc._pk<<std::endl;
+							return false;
+						}
+#endif
+						_lc._intRing.divin(*p0, _lc._pk);
+					}
+#ifdef RSTIMING
+					_lc.tRingOther.stop();
+					_lc.ttRingOther += _lc.tRingOther;
+#endif
+					_pending = _lc._digitsPerStep;
+				}
+
+				// peel the lowest p-adic digit off the block
+				for (size_t i = 0; i < digit.size(); ++i) {
+					_lc._intRing.rem(digit[i], _block[i], _lc._p);
+					_lc._intRing.quoin(_block[i], _lc._p);
+				}
+				--_pending;
+				++_position;
+				return true;
+			}
+
+		public:
+
 			bool operator != (const const_iterator& iterator) const
 			{
 				if ( &_lc != &iterator._lc) {
@@ -370,8 +452,74 @@ namespace LinBox
 			return _b;
 		}
 
+	protected:
+		// sets _digitsPerStep and _pk, the matrix products now use entries bounded by _pk
+		void setDigitBlock(size_t k)
+		{
+			_digitsPerStep = k;
+			_intRing.assign(_pk, _intRing.one);
+			for (size_t i = 0; i < k; ++i)
+				_intRing.mulin(_pk, _p);
+			Integer Pk;
+			_intRing.convert(Pk, _pk);
+			_MAD.setup(Pk);
+		}
+
 	};
 
+	/** Computes <code>A^{-1} mod p^k</code>, with entries in <code>[0, p^k)</code>,
+	 * from \p Ainv = <code>A^{-1} mod p</code>, by lifting the identity:
+	 * k products modulo p and k-1 integer products by \p A.
+	 */
+	template <class Ring, class IMatrix, class FMatrix>
+	BlasMatrix<Ring>& liftInverse (BlasMatrix<Ring>& invpk, const IMatrix& A, const FMatrix& Ainv,
+				       const typename Ring::Element& p, size_t k)
+	{
+		typedef typename FMatrix::Field Field;
+		const Ring& R = invpk.field();
+		const Field& F = Ainv.field();
+		const size_t n = A.coldim();
+		BlasMatrixDomain<Ring> BMDR(R);
+		BlasMatrixDomain<Field> BMDF(F);
+		Hom<Ring, Field> hom(R, F);
+
+		BlasMatrix<Ring> Res(R, n, n), X(R, n, n), AX(R, n, n);
+		BlasMatrix<Field> Resp(F, n, n), Xp(F, n, n);
+		for (size_t i = 0; i < n; ++i)
+			for (size_t l = 0; l < n; ++l)
+				R.assign(invpk.refEntry(i, l), R.zero);
+		for (size_t i = 0; i < n; ++i)
+			Res.setEntry(i, i, R.one);
+
+		typename Ring::Element pj;
+		R.assign(pj, R.one);
+		for (size_t j = 0; j < k; ++j) {
+			// X = A^{-1} Res mod p, is the j-th p-adic digit of A^{-1}
+			for (size_t i = 0; i < n; ++i)
+				for (size_t l = 0; l < n; ++l)
+					hom.image(Resp.refEntry(i, l), Res.getEntry(i, l));
+			BMDF.mul(Xp, Ainv, Resp);
+			for (size_t i = 0; i < n; ++i)
+				for (size_t l = 0; l < n; ++l) {
+					hom.preimage(X.refEntry(i, l), Xp.getEntry(i, l));
+					if (R.compare(X.getEntry(i, l), R.zero) < 0)
+						R.addin(X.refEntry(i, l), p);
+					R.axpyin(invpk.refEntry(i, l), pj, X.getEntry(i, l));
+				}
+
+			if (j + 1 < k) {
+				// Res = (Res - A X) / p
+				BMDR.mul(AX, A, X);
+				BMDR.subin(Res, AX);
+				for (size_t i = 0; i < n; ++i)
+					for (size_t l = 0; l < n; ++l)
+						R.divin(Res.refEntry(i, l), p);
+			}
+			R.mulin(pj, p);
+		}
+		return invpk;
+	}
+
 	/// Dixon Lifting Container
 	template <class _Ring, class _Field, class _IMatrix, class _FMatrix>
 	class DixonLiftingContainer : public LiftingContainerBase< _Ring, _IMatrix> {
@@ -394,6 +542,9 @@ namespace LinBox
 		mutable FVector              _res_p;
 		mutable FVector            _digit_p;
 		BlasApply<Field>                _BA;
+		mutable IVector            _res_pk;  // residue mod p^k
+		BlasMatrix<Ring>          *_invpk;  // A^{-1} mod p^k, when lifting k digits per step
+		MatrixApplyDomain<Ring, BlasMatrix<Ring> > *_MADinv;
 
 	public:
 #ifdef RSTIMING
@@ -408,7 +559,8 @@ namespace LinBox
 				       const VectorIn&   b,
 				       const Prime_Type& p) :
 			LiftingContainerBase<Ring,IMatrix> (R,A,b,p), _Ap(Ap), _field(&F), _VDF(F),
-			_res_p(F,b.size()), _digit_p(F,A.coldim()), _BA(F)
+			_res_p(F,b.size()), _digit_p(F,A.coldim()), _BA(F),
+			_res_pk(R,b.size()), _invpk(NULL), _MADinv(NULL)
 		{
 
 			for (size_t i=0; i< _res_p.size(); ++i)
@@ -438,7 +590,11 @@ namespace LinBox
 		}
 
 
-		virtual ~DixonLiftingContainer() {}
+		virtual ~DixonLiftingContainer()
+		{
+			if (_MADinv != NULL) delete _MADinv;
+			if (_invpk != NULL) delete _invpk;
+		}
 
 		// return the field
 		const Field& field() const
@@ -446,6 +602,35 @@ namespace LinBox
 			return *_field;
 		}
 
+		/** Precomputes <code>A^{-1} mod p^k</code> from the inverse mod p,
+		 * by lifting the identity (k products mod p and k-1 integer products),
+		 * so that iterators produce k digits per step.
+		 * Only worth it when the number of digits to lift is large compared to the dimension.
+		 */
+		virtual bool setDigitsPerStep(size_t k)
+		{
+			if (_MADinv != NULL) { delete _MADinv; _MADinv = NULL; }
+			if (_invpk != NULL) { delete _invpk; _invpk = NULL; }
+			if (k <= 1) {
+				this->setDigitBlock(1);
+				return true;
+			}
+
+			const size_t n = this->_matA.coldim();
+			if (this->_matA.rowdim() != n) return false;
+
+			const Ring& R = this->_intRing;
+			_invpk = new BlasMatrix<Ring>(R, n, n);
+			liftInverse(*_invpk, this->_matA, _Ap, this->_p, k);
+
+			this->setDigitBlock(k);
+			_MADinv = new MatrixApplyDomain<Ring, BlasMatrix<Ring> >(R, *_invpk);
+			Integer Pk;
+			R.convert(Pk, this->_pk);
+			_MADinv->setup(Pk);
+			return true;
+		}
+
 	protected:
 
 		virtual IVector& nextdigit(IVector& digit, const IVector& residu) const
@@ -501,8 +686,288 @@ namespace LinBox
 			return digit;
 		}
 
+		virtual IVector& nextdigits(IVector& block, const IVector& residu) const
+		{
+			if (_MADinv == NULL) return nextdigit(block, residu);
+#ifdef RSTIMING
+			tGetDigit.start();
+#endif
+			const Ring& R = this->_intRing;
+			// res_pk = residu mod p^k
+			for (size_t i = 0; i < residu.size(); ++i) {
+				R.rem(_res_pk[i], residu[i], this->_pk);
+				if (_res_pk[i] < 0) R.addin(_res_pk[i], this->_pk);
+			}
+
+			// block = A^{-1} res_pk mod p^k
+			_MADinv->applyV(block, _res_pk, _res_pk);
+			for (size_t i = 0; i < block.size(); ++i) {
+				R.remin(block[i], this->_pk);
+				if (block[i] < 0) R.addin(block[i], this->_pk);
+			}
+#ifdef RSTIMING
+			tGetDigit.stop();
+			ttGetDigit += tGetDigit;
+#endif
+			return block;
+		}
+
 	}; // end of class DixonLiftingContainerBase
 
+	/** \brief Dixon lifting of a block of right-hand sides.
+	 *
+	 * All the columns of \c B are lifted together, \c k p-adic digits per
+	 * step: a step is one product by <code>A^{-1} mod p^k</code> and one
+	 * integer product by \c A, on the whole block. When \c p^k fits in
+	 * \c Field, the first product is done in the word size field of
+	 * cardinality \c p^k; otherwise it goes through the chunked BLAS
+	 * products of MatrixApplyDomain, as DixonLiftingContainer::nextdigits does.
+	 *
+	 * column(j) is the lifting container of the j-th column, to be given to
+	 * RationalReconstruction. The steps are lifted when a column first asks
+	 * for them and are kept, so that the columns are reconstructed one
+	 * after the other, each stopping as early as the reconstruction allows.
+	 */
+	template <class _Ring, class _Field, class _IMatrix>
+	class DixonBlockLiftingContainer {
+
+	public:
+		typedef _Field                               Field;
+		typedef _Ring                                 Ring;
+		typedef _IMatrix                           IMatrix;
+		typedef typename Ring::Element           Integer_t;
+		typedef BlasVector<Ring>                   IVector;
+
+		/// The lifting container of one column.
+		class Column;
+
+	protected:
+
+		const IMatrix                     &_matA;
+		Ring                           _intRing;
+		Integer_t                            _p;
+		size_t                   _digitsPerStep;
+		Integer_t                           _pk; // _p^_digitsPerStep
+		size_t                          _length; // in p-adic digits
+		Integer_t                     _numbound;
+		Integer_t                     _denbound;
+		BlasMatrix<Ring>                   _res; // residues of all the columns
+		std::vector<BlasMatrix<Ring> >   _steps; // the blocks of digits lifted so far, in [0, p^k)
+
+		// A^{-1} mod p^k, in the word size field of cardinality p^k if it fits
+		Field                             *_Fpk;
+		BlasMatrix<Field>               *_invFpk;
+		// otherwise over the integers
+		BlasMatrix<Ring>                 *_invpk;
+		MatrixApplyDomain<Ring, BlasMatrix<Ring> > *_MADinv;
+
+	public:
+
+		/**
+		 * @param Ap       <code>A^{-1} mod p</code>
+		 * @param k        number of p-adic digits per step
+		 * @param logBound log2 of the bound on 2 |num| den of the solutions
+		 */
+		template <class FMatrix>
+		DixonBlockLiftingContainer (const Ring&             R,
+					    const IMatrix&          A,
+					    const FMatrix&         Ap,
+					    const BlasMatrix<Ring>& B,
+					    const Integer_t&        p,
+					    size_t                  k,
+					    const Integer_t& numbound,
+					    const Integer_t& denbound,
+					    double           logBound) :
+			_matA(A), _intRing(R), _p(p), _digitsPerStep(k > 1 ? k : 1),
+			_numbound(numbound), _denbound(denbound), _res(B),
+			_Fpk(NULL), _invFpk(NULL), _invpk(NULL), _MADinv(NULL)
+		{
+			linbox_check(A.rowdim() == A.coldim());
+			linbox_check(A.rowdim() == B.rowdim());
+
+			Integer Prime, Pk;
+			R.convert(Prime, _p);
+			_length = (size_t) std::ceil(logBound / Givaro::logtwo(Prime));
+
+			R.assign(_pk, R.one);
+			for (size_t i = 0; i < _digitsPerStep; ++i)
+				R.mulin(_pk, _p);
+			R.convert(Pk, _pk);
+
+			const size_t n = A.coldim();
+			BlasMatrix<Ring> invpk(R, n, n);
+			liftInverse(invpk, A, Ap, _p, _digitsPerStep);
+
+			if (Pk <= Integer(Field::maxCardinality())) {
+				_Fpk = new Field(Pk);
+				_invFpk = new BlasMatrix<Field>(*_Fpk, n, n);
+				Hom<Ring, Field> hom(R, *_Fpk);
+				for (size_t i = 0; i < n; ++i)
+					for (size_t l = 0; l < n; ++l)
+						hom.image(_invFpk->refEntry(i, l), invpk.getEntry(i, l));
+			}
+			else {
+				_invpk = new BlasMatrix<Ring>(invpk);
+				_MADinv = new MatrixApplyDomain<Ring, BlasMatrix<Ring> >(R, *_invpk);
+				_MADinv->setup(Pk);
+			}
+		}
+
+		~DixonBlockLiftingContainer ()
+		{
+			if (_MADinv != NULL) delete _MADinv;
+			if (_invpk != NULL) delete _invpk;
+			if (_invFpk != NULL) delete _invFpk;
+			if (_Fpk != NULL) delete _Fpk;
+		}
+
+		/// Number of right-hand sides.
+		size_t coldim () const { return _res.coldim(); }
+
+		/** Block of the digits <code>t k</code> to <code>(t+1) k - 1</code>
+		 * of all the columns, lifted if needed.
+		 */
+		const BlasMatrix<Ring>& step (size_t t)
+		{
+			while (_steps.size() <= t)
+				lift();
+			return _steps[t];
+		}
+
+	protected:
+
+		// computes the next block of digits D, with A D = _res mod p^k,
+		// and updates _res = (_res - A D) / p^k
+		void lift ()
+		{
+			LINBOX_TRACE_SPAN("lifting block");
+			const Ring& R = _intRing;
+			const size_t n = _matA.coldim();
+			const size_t s = _res.coldim();
+			BlasMatrix<Ring> D(R, n, s);
+
+			if (_invFpk != NULL) {
+				Hom<Ring, Field> hom(R, *_Fpk);
+				BlasMatrix<Field> Rp(*_Fpk, n, s), Dp(*_Fpk, n, s);
+				for (size_t i = 0; i < n; ++i)
+					for (size_t j = 0; j < s; ++j)
+						hom.image(Rp.refEntry(i, j), _res.getEntry(i, j));
+				BlasMatrixDomain<Field>(*_Fpk).mul(Dp, *_invFpk, Rp);
+				for (size_t i = 0; i < n; ++i)
+					for (size_t j = 0; j < s; ++j) {
+						hom.preimage(D.refEntry(i, j), Dp.getEntry(i, j));
+						if (R.compare(D.getEntry(i, j), R.zero) < 0)
+							R.addin(D.refEntry(i, j), _pk);
+					}
+			}
+			else {
+				BlasMatrix<Ring> Rpk(R, n, s);
+				for (size_t i = 0; i < n; ++i)
+					for (size_t j = 0; j < s; ++j) {
+						Integer_t& r = Rpk.refEntry(i, j);
+						R.rem(r, _res.getEntry(i, j), _pk);
+						if (R.compare(r, R.zero) < 0) R.addin(r, _pk);
+					}
+				_MADinv->applyM(D, Rpk);
+				for (size_t i = 0; i < n; ++i)
+					for (size_t j = 0; j < s; ++j) {
+						Integer_t& d = D.refEntry(i, j);
+						R.remin(d, _pk);
+						if (R.compare(d, R.zero) < 0) R.addin(d, _pk);
+					}
+			}
+
+			BlasMatrix<Ring> AD(R, n, s);
+			BlasMatrixDomain<Ring>(R).mul(AD, _matA, D);
+			BlasMatrixDomain<Ring>(R).subin(_res, AD);
+			for (size_t i = 0; i < n; ++i)
+				for (size_t j = 0; j < s; ++j)
+					R.divin(_res.refEntry(i, j), _pk);
+
+			_steps.push_back(D);
+		}
+
+	private:
+		DixonBlockLiftingContainer (const DixonBlockLiftingContainer&);
+		DixonBlockLiftingContainer& operator= (const DixonBlockLiftingContainer&);
+
+	public:
+
+		class Column : public LiftingContainer<_Ring> {
+		public:
+			typedef _Field                     Field;
+			typedef _Ring                       Ring;
+			typedef typename Ring::Element Integer_t;
+			typedef BlasVector<Ring>         IVector;
+
+		protected:
+			DixonBlockLiftingContainer &_blc;
+			size_t                        _j;
+
+		public:
+			Column (DixonBlockLiftingContainer& blc, size_t j) :
+				_blc(blc), _j(j)
+			{}
+
+			class const_iterator {
+			private:
+				const Column     &_col;
+				size_t       _position;
+				IVector         _block; // p-adic digits of the current step not yet returned
+			public:
+				const_iterator (const Column& col, size_t end = 0) :
+					_col(col), _position(end), _block(col.ring(), col.size())
+				{}
+
+				bool next (IVector& digit)
+				{
+					DixonBlockLiftingContainer& blc = _col._blc;
+					const Ring& R = blc._intRing;
+					const size_t k = blc._digitsPerStep;
+					if (_position % k == 0) {
+						const BlasMatrix<Ring>& D = blc.step(_position / k);
+						for (size_t i = 0; i < _block.size(); ++i)
+							R.assign(_block[i], D.getEntry(i, _col._j));
+					}
+
+					// peel the lowest p-adic digit off the block
+					for (size_t i = 0; i < digit.size(); ++i) {
+						R.rem(digit[i], _block[i], blc._p);
+						R.quoin(_block[i], blc._p);
+					}
+					++_position;
+					return true;
+				}
+
+				bool operator != (const const_iterator& iterator) const
+				{
+					return _position != iterator._position;
+				}
+
+				bool operator == (const const_iterator& iterator) const
+				{
+					return _position == iterator._position;
+				}
+			};
+
+			const_iterator begin () const { return const_iterator(*this); }
+
+			const_iterator end () const { return const_iterator(*this, length()); }
+
+			virtual size_t length () const { return _blc._length; }
+
+			virtual size_t size () const { return _blc._matA.coldim(); }
+
+			virtual const Ring& ring () const { return _blc._intRing; }
+
+			virtual const Integer_t& prime () const { return _blc._p; }
+
+			const Integer_t numbound () const { return _blc._numbound; }
+
+			const Integer_t denbound () const { return _blc._denbound; }
+		};
+	};
+
 	/// Wiedemann LiftingContianer.
 	template <class _Ring, class _Field, class _IMatrix, class _FMatrix, class _FPolynomial>
 	class WiedemannLiftingContainer : public LiftingContainerBase<_Ring, _IMatrix> {
@@ -53,6 +53,7 @@
 #include "linbox/vector/subvector.h"
 #include "linbox/vector/vector-domain.h"
 #include "linbox/util/timer.h"
+#include "linbox/util/tracer.h"
 
 namespace LinBox
 {
@@ -214,6 +215,7 @@ namespace LinBox
 			integer card;
 
 			commentator().start ("Massey", "masseyd", (unsigned int)END);
+			LINBOX_TRACE_SPAN("Massey");
 
 			// ====================================================
 			// Sequence and iterator initialization
@@ -346,6 +348,7 @@ namespace LinBox
 #endif // INCLUDE_TIMING
 			}
 
+			LINBOX_TRACE_COUNTER("Massey degree", L);
 			commentator().stop ("done", NULL, "masseyd");
 			//		commentator().stop ("Done", "Done", "LinBox::MasseyDomain::massey");
 			return L;
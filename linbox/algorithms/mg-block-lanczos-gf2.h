@@ -0,0 +1,212 @@
+/* linbox/algorithms/mg-block-lanczos-gf2.h
+ * Copyright (C) 2013 the LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ *
+ * Class definitions for block Lanczos iteration over GF2
+ */
+
+#ifndef __LINBOX_mg_block_lanczos_gf2_H
+#define __LINBOX_mg_block_lanczos_gf2_H
+
+#include "linbox/linbox-config.h"
+
+#include <vector>
+#include <cstdint>
+
+#include "linbox/field/gf2.h"
+#include "linbox/blackbox/zo-gf2.h"
+#include "linbox/matrix/matrix-traits.h"
+#include "linbox/matrix/densematrix/m4ri-matrix.h"
+#include "linbox/solutions/methods.h"
+#include "linbox/algorithms/mg-block-lanczos.h"
+
+#ifndef LINBOX_BLOCK_LANCZOS_GF2_DENSE
+// Below this many columns, the nullspace is computed by dense elimination
+#define LINBOX_BLOCK_LANCZOS_GF2_DENSE 512
+#endif
+
+namespace LinBox
+{
+
+	/** \brief Block Lanczos iteration over GF2, on word packed blocks.
+	 *
+	 * The blocking factor is 64 : a block of 64 vectors of length \f$n\f$ is
+	 * \f$n\f$ machine words, one per row, and the \f$64\times 64\f$
+	 * matrices of the iteration are 64 words. Applying the black box is then
+	 * a XOR of words per non zero entry, and the small products are done by
+	 * tables of 8 bits (Montgomery 1995).
+	 *
+	 * The black box is first read into its compressed rows and columns (by
+	 * its indexed iterators, or else by applying it to the unit vectors), so
+	 * that \f$AV\f$ and \f$A^TW\f$ are both gathers, run in parallel over
+	 * the rows with OpenMP.
+	 *
+	 * The iteration is on \f$A^TA\f$, whatever \c traits.preconditioner : the
+	 * diagonal preconditioners are the identity over GF2. Its output is
+	 * turned into vectors of the right nullspace of \f$A\f$ ;
+	 * \c solve looks for one of the nullspace of \f$[A|b]\f$ whose last
+	 * entry is one.
+	 */
+	template <class Matrix>
+	class MGBlockLanczosSolver<GF2, Matrix> {
+	public:
+
+		typedef GF2                 Field;
+		typedef bool              Element;
+		typedef uint64_t             Word;
+
+		static const size_t N = 64 ; //!< blocking factor
+
+		/** Constructor
+		 * @param F Field over which to operate
+		 * @param traits @ref SolverTraits  structure describing user
+		 *               options for the solver
+		 */
+		MGBlockLanczosSolver (const GF2 &F, const Method::BlockLanczos &traits) :
+			_traits (traits), _field (&F), _randiter (F)
+		{}
+
+		/** Constructor with a random iterator
+		 * @param F Field over which to operate
+		 * @param traits @ref SolverTraits  structure describing user
+		 *               options for the solver
+		 * @param r Random iterator to use for randomization
+		 */
+		MGBlockLanczosSolver (const GF2 &F, const Method::BlockLanczos &traits, GF2::RandIter r) :
+			_traits (traits), _field (&F), _randiter (r)
+		{}
+
+		/** Solve the linear system Ax = b.
+		 *
+		 * If the system is singular, a random solution is computed.
+		 *
+		 * @param A Black box for the matrix A
+		 * @param x Vector in which to store solution
+		 * @param b Right-hand side of system
+		 * @return true on success and false when no solution was found,
+		 * which means that the system is inconsistent, with probability at
+		 * least \f$1-2^{-k}\f$ for the \f$k\f$ nullspace vectors sampled.
+		 */
+		template <class Blackbox, class Vector>
+		bool solve (const Blackbox &A, Vector &x, const Vector &b);
+
+		/** Sample uniformly from the (right) nullspace of A
+		 *
+		 * @param A Black box for the matrix A
+		 * @param x Matrix into whose columns to store nullspace elements,
+		 *          which are independent
+		 * @return Number of nullspace vectors found
+		 */
+		template <class Blackbox, class Matrix1>
+		unsigned int sampleNullspace (const Blackbox &A, Matrix1 &x);
+
+		inline const Field & field() const { return *_field; }
+
+	private:
+
+		// Reading the black box in _ei, _ej
+		template <class Blackbox>
+		void load (const Blackbox &A);
+
+		template <class Blackbox>
+		void entries (const Blackbox &A, IndexedTags::HasNext);
+
+		template <class Blackbox>
+		void entries (const Blackbox &A, IndexedTags::HasIndexed);
+
+		template <class Blackbox>
+		void entries (const Blackbox &A, IndexedTags::NoIndexed);
+
+		void entries (const ZeroOne<GF2> &A, IndexedTags::NoIndexed);
+
+		// From _ei, _ej to the compressed rows and columns
+		void compress ();
+
+		// y = A x, with _m words in y and _n in x
+		void applyA (Word *y, const Word *x) const;
+
+		// y = A^T x
+		void applyAT (Word *y, const Word *x) const;
+
+		// Rows of K : an independent set of vectors of the right nullspace
+		bool nullspace (M4RIMatrix &K);
+
+		// Run the block Lanczos iteration on A^T A from V_0 = A^T A X,
+		// X random. On return, X and V are the last X and V_i.
+		// Return false if the method breaks down.
+		bool iterate (std::vector<Word> &X, std::vector<Word> &V, Word seed) const;
+
+		// Nullspace vectors of A in the span of the columns of X and V
+		size_t combine (M4RIMatrix &K, const std::vector<Word> &X, const std::vector<Word> &V) const;
+
+		// Compute W_i^inv and S_i (as a mask of columns) given V_i^T A V_i
+		// and S_{i-1}. Return false if no suitable S_i exists
+		static bool compute_Winv_S (Word *Winv, Word &S, const Word *T, Word lastS);
+
+		// C = X^T Y, X and Y with n rows
+		static void innerProduct (Word *C, const Word *X, const Word *Y, size_t n);
+
+		// Y = Y + X D, X and Y with n rows
+		static void mulAddin (Word *Y, const Word *X, const Word *D, size_t n);
+
+		// C = A B, 64 x 64
+		static void mul (Word *C, const Word *A, const Word *B);
+
+		// T = A^T, 64 x 64
+		static void transpose (Word *T, const Word *A);
+
+		// Transpose n rows of 64 bits into 64 rows of (n+63)/64 words
+		static void transpose (Word *T, const Word *X, size_t n);
+
+		// Row echelon form of the R rows of w words of E, the same row
+		// operations on the rows of cw words of C. Return the rank
+		static size_t echelon (Word *E, size_t R, size_t w, Word *C, size_t cw);
+
+		// Private variables
+
+		const Method::BlockLanczos _traits;
+		const Field              *_field;
+		GF2::RandIter             _randiter;
+
+		size_t                    _m;       // rows of the operator
+		size_t                    _n;       // columns of the operator
+
+		std::vector<uint32_t>     _ei;      // entries, before compress ()
+		std::vector<uint32_t>     _ej;
+
+		std::vector<size_t>       _rowp;    // compressed rows
+		std::vector<uint32_t>     _rowi;
+		std::vector<size_t>       _colp;    // compressed columns
+		std::vector<uint32_t>     _coli;
+	};
+
+} // namespace LinBox
+
+#include "linbox/algorithms/mg-block-lanczos-gf2.inl"
+
+#endif // __LINBOX_mg_block_lanczos_gf2_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -0,0 +1,668 @@
+/* linbox/algorithms/mg-block-lanczos-gf2.inl
+ * Copyright (C) 2013 the LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ *
+ * Function definitions for block Lanczos iteration over GF2
+ */
+
+#ifndef __LINBOX_mg_block_lanczos_gf2_INL
+#define __LINBOX_mg_block_lanczos_gf2_INL
+
+#include "linbox/linbox-config.h"
+
+#include <iostream>
+#include <algorithm>
+#include <random>
+
+#include "linbox/util/debug.h"
+#include "linbox/util/commentator.h"
+#include "linbox/matrix/matrixdomain/matrix-domain-m4ri.h"
+#include "linbox/algorithms/mg-block-lanczos-gf2.h"
+
+namespace LinBox
+{
+
+	template <class Matrix>
+	const size_t MGBlockLanczosSolver<GF2, Matrix>::N;
+
+	template <class Matrix>
+	template <class Blackbox, class Vector>
+	inline bool MGBlockLanczosSolver<GF2, Matrix>::solve (const Blackbox &A, Vector &x, const Vector &b)
+	{
+		linbox_check ((x.size () == A.coldim ()) &&
+			      (b.size () == A.rowdim ()));
+
+		commentator().start ("Solving linear system (Montgomery's block Lanczos over GF2)", "MGBlockLanczosSolver::solve");
+
+		// the operator is [A | b]
+		load (A);
+		const size_t n = _n;
+		for (size_t i = 0; i < _m; ++i)
+			if (b[i]) {
+				_ei.push_back ((uint32_t)i);
+				_ej.push_back ((uint32_t)n);
+			}
+		++_n;
+		compress ();
+
+		bool success = false, done = false;
+		M4RIMatrix K (field ());
+
+		for (unsigned int i = 0; !done && i < _traits.trialsBeforeFailure; ++i) {
+			std::ostream &report = commentator().report (Commentator::LEVEL_UNIMPORTANT, INTERNAL_DESCRIPTION);
+			report << "In try: " << i << std::endl;
+
+			if (!nullspace (K))
+				continue;
+			done = true;
+
+			report << "Nullspace vectors of [A|b]: " << K.rowdim () << std::endl;
+
+			for (size_t k = 0; k < K.rowdim (); ++k)
+				if (K.getEntry (k, n)) {
+					for (size_t j = 0; j < n; ++j)
+						x[j] = K.getEntry (k, j);
+					success = true;
+					break;
+				}
+		}
+
+		if (success && _traits.checkResult) {
+			BitVector Ax (A.rowdim ());
+
+			commentator().start ("Checking whether Ax=b");
+
+			A.apply (Ax, x);
+
+			for (size_t i = 0; success && i < A.rowdim (); ++i)
+				success = ((bool)Ax[i] == (bool)b[i]);
+
+			commentator().stop (success ? "passed" : "FAILED");
+		}
+
+		commentator().stop ("done", (success ? "Solve successful" : "Solve failed"), "MGBlockLanczosSolver::solve");
+
+		return success;
+	}
+
+	template <class Matrix>
+	template <class Blackbox, class Matrix1>
+	inline unsigned int MGBlockLanczosSolver<GF2, Matrix>::sampleNullspace (const Blackbox &A, Matrix1 &x)
+	{
+		linbox_check (x.rowdim () == A.coldim ());
+
+		commentator().start ("Sampling from nullspace (Montgomery's block Lanczos over GF2)", "MGBlockLanczosSolver::sampleNullspace");
+
+		load (A);
+		compress ();
+
+		unsigned int number = 0;
+		bool done = false;
+		M4RIMatrix K (field ());
+
+		for (unsigned int i = 0; !done && i < _traits.trialsBeforeFailure; ++i) {
+			std::ostream &report = commentator().report (Commentator::LEVEL_UNIMPORTANT, INTERNAL_DESCRIPTION);
+			report << "in try: " << i << std::endl;
+
+			if (!nullspace (K))
+				continue;
+			done = true;
+
+			number = (unsigned int) std::min (K.rowdim (), x.coldim ());
+			for (size_t k = 0; k < number; ++k)
+				for (size_t j = 0; j < _n; ++j)
+					x.setEntry (j, k, K.getEntry (k, j));
+		}
+
+		commentator().stop ("done", (const char *) 0, "MGBlockLanczosSolver::sampleNullspace");
+
+		return number;
+	}
+
+	template <class Matrix>
+	template <class Blackbox>
+	inline void MGBlockLanczosSolver<GF2, Matrix>::load (const Blackbox &A)
+	{
+		// indices are stored on 32 bits, one more column for [A | b]
+		linbox_check (A.rowdim () < ((size_t)1 << 32) && A.coldim () < ((size_t)1 << 32) - 1);
+
+		_m = A.rowdim ();
+		_n = A.coldim ();
+		_ei.clear ();
+		_ej.clear ();
+		entries (A, typename IndexedCategory<Blackbox>::Tag ());
+	}
+
+	template <class Matrix>
+	template <class Blackbox>
+	inline void MGBlockLanczosSolver<GF2, Matrix>::entries (const Blackbox &A, IndexedTags::HasNext)
+	{
+		size_t i, j;
+		typename Blackbox::Field::Element e;
+		A.firstTriple ();
+		while (A.nextTriple (i, j, e))
+			if (!A.field ().isZero (e)) {
+				_ei.push_back ((uint32_t)i);
+				_ej.push_back ((uint32_t)j);
+			}
+	}
+
+	template <class Matrix>
+	template <class Blackbox>
+	inline void MGBlockLanczosSolver<GF2, Matrix>::entries (const Blackbox &A, IndexedTags::HasIndexed)
+	{
+		for (typename Blackbox::ConstIndexedIterator it = A.IndexedBegin (); it != A.IndexedEnd (); ++it)
+			if (!A.field ().isZero (it.value ())) {
+				_ei.push_back ((uint32_t)it.rowIndex ());
+				_ej.push_back ((uint32_t)it.colIndex ());
+			}
+	}
+
+	template <class Matrix>
+	template <class Blackbox>
+	inline void MGBlockLanczosSolver<GF2, Matrix>::entries (const Blackbox &A, IndexedTags::NoIndexed)
+	{
+		// column by column, from A e_j
+		BitVector e (_n), c (_m);
+		for (size_t j = 0; j < _n; ++j) {
+			e[j] = true;
+			A.apply (c, e);
+			e[j] = false;
+			for (size_t i = 0; i < _m; ++i)
+				if (c[i]) {
+					_ei.push_back ((uint32_t)i);
+					_ej.push_back ((uint32_t)j);
+				}
+		}
+	}
+
+	template <class Matrix>
+	inline void MGBlockLanczosSolver<GF2, Matrix>::entries (const ZeroOne<GF2> &A, IndexedTags::NoIndexed)
+	{
+		for (size_t i = 0; i < _m; ++i)
+			for (ZeroOne<GF2>::Row_t::const_iterator it = A[i].begin (); it != A[i].end (); ++it) {
+				_ei.push_back ((uint32_t)i);
+				_ej.push_back ((uint32_t)*it);
+			}
+	}
+
+	template <class Matrix>
+	inline void MGBlockLanczosSolver<GF2, Matrix>::compress ()
+	{
+		const size_t nnz = _ei.size ();
+
+		_rowp.assign (_m+1, 0);
+		_colp.assign (_n+1, 0);
+		for (size_t k = 0; k < nnz; ++k) {
+			++_rowp[_ei[k]+1];
+			++_colp[_ej[k]+1];
+		}
+		for (size_t i = 0; i < _m; ++i)
+			_rowp[i+1] += _rowp[i];
+		for (size_t j = 0; j < _n; ++j)
+			_colp[j+1] += _colp[j];
+
+		_rowi.resize (nnz);
+		_coli.resize (nnz);
+		std::vector<size_t> r (_rowp.begin (), _rowp.end ()-1), c (_colp.begin (), _colp.end ()-1);
+		for (size_t k = 0; k < nnz; ++k) {
+			_rowi[r[_ei[k]]++] = _ej[k];
+			_coli[c[_ej[k]]++] = _ei[k];
+		}
+
+		std::vector<uint32_t> ().swap (_ei);
+		std::vector<uint32_t> ().swap (_ej);
+	}
+
+	template <class Matrix>
+	inline void MGBlockLanczosSolver<GF2, Matrix>::applyA (Word *y, const Word *x) const
+	{
+		const long m = (long)_m;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1024) if (m > 4096)
+#endif
+		for (long i = 0; i < m; ++i) {
+			Word s = 0;
+			for (size_t p = _rowp[(size_t)i]; p < _rowp[(size_t)i+1]; ++p)
+				s ^= x[_rowi[p]];
+			y[i] = s;
+		}
+	}
+
+	template <class Matrix>
+	inline void MGBlockLanczosSolver<GF2, Matrix>::applyAT (Word *y, const Word *x) const
+	{
+		const long n = (long)_n;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(dynamic, 1024) if (n > 4096)
+#endif
+		for (long j = 0; j < n; ++j) {
+			Word s = 0;
+			for (size_t p = _colp[(size_t)j]; p < _colp[(size_t)j+1]; ++p)
+				s ^= x[_coli[p]];
+			y[j] = s;
+		}
+	}
+
+	template <class Matrix>
+	inline bool MGBlockLanczosSolver<GF2, Matrix>::nullspace (M4RIMatrix &K)
+	{
+		if (_n < LINBOX_BLOCK_LANCZOS_GF2_DENSE) {
+			// K A^T = 0
+			M4RIMatrix AT (field (), _n, _m);
+			for (size_t j = 0; j < _n; ++j)
+				for (size_t p = _colp[j]; p < _colp[j+1]; ++p)
+					AT.setEntry (j, _coli[p], true);
+			M4RIDomain (field ()).nullspaceBasisLeft (K, AT);
+			return true;
+		}
+
+		Word seed = 0;
+		for (size_t k = 0; k < N; ++k) {
+			bool c;
+			_randiter.random (c);
+			seed = (seed << 1) | (Word)c;
+		}
+
+		std::vector<Word> X, V;
+		if (!iterate (X, V, seed))
+			return false;
+
+		return combine (K, X, V) != 0;
+	}
+
+	template <class Matrix>
+	inline bool MGBlockLanczosSolver<GF2, Matrix>::iterate (std::vector<Word> &X, std::vector<Word> &V, Word seed) const
+	{
+		const size_t n = _n;
+		const Word ones = ~(Word)0;
+
+		std::mt19937_64 gen (seed);
+		X.resize (n);
+		for (size_t i = 0; i < n; ++i)
+			X[i] = gen ();
+
+		std::vector<Word> V0 (n), V1 (n, 0), V2 (n, 0), AV (n), U (_m);
+
+		// V_0 = A^T A X, and B X = V_0 when the iteration succeeds, so
+		// that B (X + sum_i V_i Winv_i V_i^T V_0) = 0
+		applyA (U.data (), X.data ());
+		applyAT (V0.data (), U.data ());
+		V = V0;
+
+		Word VTAV[N], VTAAV[N], Winv[N], D[N], E[N], F[N], F2[N], VTV0[N];
+		Word VTAV1[N], VTAAV1[N], Winv1[N], Winv2[N];
+		std::fill (VTAV1, VTAV1+N, (Word)0);
+		std::fill (VTAAV1, VTAAV1+N, (Word)0);
+		std::fill (Winv1, Winv1+N, (Word)0);
+		std::fill (Winv2, Winv2+N, (Word)0);
+		Word S1 = ones;
+
+		const size_t maxIter = n / (N-1) + 20;
+
+		for (size_t iter = 0; ; ++iter) {
+			if (iter > maxIter)
+				return false;
+
+			// AV = A^T A V_i
+			applyA (U.data (), V.data ());
+			applyAT (AV.data (), U.data ());
+
+			innerProduct (VTAV, V.data (), AV.data (), n);
+			innerProduct (VTAAV, AV.data (), AV.data (), n);
+
+			// V_i^T A V_i = 0 : done
+			Word any = 0;
+			for (size_t k = 0; k < N; ++k)
+				any |= VTAV[k];
+			if (!any)
+				break;
+
+			Word S;
+			if (!compute_Winv_S (Winv, S, VTAV, S1))
+				return false;
+
+			// V_{i+1} = A V_i S_i S_i^T + V_i D_{i+1} + V_{i-1} E_{i+1} + V_{i-2} F_{i+1}
+			if (S != ones)
+				for (size_t i = 0; i < n; ++i)
+					AV[i] &= S;
+
+			// X = X + V_i Winv_i V_i^T V_0
+			innerProduct (VTV0, V.data (), V0.data (), n);
+			mul (D, Winv, VTV0);
+			mulAddin (X.data (), V.data (), D, n);
+
+			// D_{i+1} = I_N - Winv_i (V_i^T A^2 V_i S_i S_i^T + V_i^T A V_i)
+			for (size_t k = 0; k < N; ++k)
+				D[k] = (VTAAV[k] & S) ^ VTAV[k];
+			mul (D, Winv, D);
+			for (size_t k = 0; k < N; ++k)
+				D[k] ^= (Word)1 << k;
+			mulAddin (AV.data (), V.data (), D, n);
+
+			// E_{i+1} = - Winv_{i-1} V_i^T A V_i S_i S_i^T
+			mul (E, Winv1, VTAV);
+			for (size_t k = 0; k < N; ++k)
+				E[k] &= S;
+			mulAddin (AV.data (), V1.data (), E, n);
+
+			// F_{i+1} = - Winv_{i-2} (I_N - V_{i-1}^T A V_{i-1} Winv_{i-1})
+			//   (V_{i-1}^T A^2 V_{i-1} S_{i-1} S_{i-1}^T + V_{i-1}^T A V_{i-1}) S_i S_i^T,
+			// zero when S_{i-1} is I_N
+			if (S1 != ones) {
+				mul (F, VTAV1, Winv1);
+				for (size_t k = 0; k < N; ++k)
+					F[k] ^= (Word)1 << k;
+				mul (F, Winv2, F);
+				for (size_t k = 0; k < N; ++k)
+					F2[k] = ((VTAAV1[k] & S1) ^ VTAV1[k]) & S;
+				mul (F, F, F2);
+				mulAddin (AV.data (), V2.data (), F, n);
+			}
+
+			V2.swap (V1);
+			V1.swap (V);
+			V.swap (AV);
+			std::copy (Winv1, Winv1+N, Winv2);
+			std::copy (Winv, Winv+N, Winv1);
+			std::copy (VTAV, VTAV+N, VTAV1);
+			std::copy (VTAAV, VTAAV+N, VTAAV1);
+			S1 = S;
+		}
+
+		return true;
+	}
+
+	template <class Matrix>
+	inline size_t MGBlockLanczosSolver<GF2, Matrix>::combine (M4RIMatrix &K, const std::vector<Word> &X, const std::vector<Word> &V) const
+	{
+		const size_t mw = (_m+N-1)/N, nw = (_n+N-1)/N;
+
+		// the 128 columns of [AX | AV], as rows, and the combinations of
+		// the columns of [X | V] they are
+		std::vector<Word> AX (mw*N, 0), AV (mw*N, 0);
+		applyA (AX.data (), X.data ());
+		applyA (AV.data (), V.data ());
+
+		std::vector<Word> E (2*N*mw), C (2*N*2, 0);
+		transpose (E.data (), AX.data (), _m);
+		transpose (E.data ()+N*mw, AV.data (), _m);
+		for (size_t k = 0; k < 2*N; ++k)
+			C[2*k+k/N] = (Word)1 << (k%N);
+
+		echelon (E.data (), 2*N, mw, C.data (), 2);
+
+		// the zero rows give vectors of the nullspace, the columns of
+		// [X | V] [L | H]^T
+		Word L[N], H[N];
+		std::fill (L, L+N, (Word)0);
+		std::fill (H, H+N, (Word)0);
+		size_t t = 0;
+		for (size_t k = 0; k < 2*N && t < N; ++k) {
+			const Word *e = E.data ()+k*mw;
+			if (std::find_if (e, e+mw, [](Word w) { return w != 0; }) != e+mw)
+				continue;
+			for (Word w = C[2*k]; w; w &= w-1)
+				L[M4RIMatrix::lowBit (w)] |= (Word)1 << t;
+			for (Word w = C[2*k+1]; w; w &= w-1)
+				H[M4RIMatrix::lowBit (w)] |= (Word)1 << t;
+			++t;
+		}
+
+		std::vector<Word> Z (nw*N, 0), ZT (N*nw);
+		mulAddin (Z.data (), X.data (), L, _n);
+		mulAddin (Z.data (), V.data (), H, _n);
+
+		// an independent set : the echelon form of Z^T
+		transpose (ZT.data (), Z.data (), _n);
+		const size_t r = echelon (ZT.data (), N, nw, 0, 0);
+
+		K.init (r, _n);
+		for (size_t k = 0, i = 0; k < N; ++k) {
+			const Word *z = ZT.data ()+k*nw;
+			if (std::find_if (z, z+nw, [](Word w) { return w != 0; }) != z+nw)
+				std::copy (z, z+nw, K.row (i++));
+		}
+
+		commentator().report (Commentator::LEVEL_UNIMPORTANT, INTERNAL_DESCRIPTION)
+		<< "Nullspace vectors found: " << r << std::endl;
+
+		return r;
+	}
+
+	template <class Matrix>
+	inline bool MGBlockLanczosSolver<GF2, Matrix>::compute_Winv_S (Word *Winv, Word &S, const Word *T, Word lastS)
+	{
+		// [T | I_N], reduced with the columns not in S_{i-1} first
+		Word M[N][2];
+		size_t cols[N];
+		for (size_t i = 0; i < N; ++i) {
+			M[i][0] = T[i];
+			M[i][1] = (Word)1 << i;
+		}
+		size_t j = 0;
+		for (size_t i = 0; i < N; ++i)
+			if (!((lastS >> i) & 1))
+				cols[j++] = i;
+		for (size_t i = 0; i < N; ++i)
+			if ((lastS >> i) & 1)
+				cols[j++] = i;
+
+		S = 0;
+		for (size_t i = 0; i < N; ++i) {
+			const Word mask = (Word)1 << cols[i];
+			Word *ri = M[cols[i]];
+
+			for (j = i; j < N; ++j)
+				if (M[cols[j]][0] & mask) {
+					std::swap (M[cols[j]][0], ri[0]);
+					std::swap (M[cols[j]][1], ri[1]);
+					break;
+				}
+
+			if (j < N) {
+				// pivot in T : column cols[i] is in S_i
+				for (j = 0; j < N; ++j) {
+					Word *rj = M[cols[j]];
+					if ((rj != ri) && (rj[0] & mask)) {
+						rj[0] ^= ri[0];
+						rj[1] ^= ri[1];
+					}
+				}
+				S |= mask;
+				continue;
+			}
+
+			// else, pivot in I_N, and the row is dropped
+			for (j = i; j < N; ++j)
+				if (M[cols[j]][1] & mask) {
+					std::swap (M[cols[j]][0], ri[0]);
+					std::swap (M[cols[j]][1], ri[1]);
+					break;
+				}
+			if (j == N)
+				return false;
+
+			for (j = 0; j < N; ++j) {
+				Word *rj = M[cols[j]];
+				if ((rj != ri) && (rj[1] & mask)) {
+					rj[0] ^= ri[0];
+					rj[1] ^= ri[1];
+				}
+			}
+			ri[0] = ri[1] = 0;
+		}
+
+		for (size_t i = 0; i < N; ++i)
+			Winv[i] = M[i][1];
+
+		// the iteration needs every column in S_i or S_{i-1}
+		return (S | lastS) == ~(Word)0;
+	}
+
+	template <class Matrix>
+	inline void MGBlockLanczosSolver<GF2, Matrix>::innerProduct (Word *C, const Word *X, const Word *Y, size_t n)
+	{
+		// C[8b+t] is the sum of the Y[i] with bit 8b+t in X[i] : the Y[i]
+		// are first summed by the value of each byte of X[i]
+		std::fill (C, C+N, (Word)0);
+
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel if (n > 16384)
+#endif
+		{
+			std::vector<Word> T (8*256, 0);
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp for schedule(static)
+#endif
+			for (long i = 0; i < (long)n; ++i) {
+				const Word x = X[i], y = Y[i];
+				for (size_t b = 0; b < 8; ++b)
+					T[b*256+((x >> (8*b)) & 255)] ^= y;
+			}
+
+			Word c[N];
+			std::fill (c, c+N, (Word)0);
+			for (size_t b = 0; b < 8; ++b)
+				for (size_t v = 1; v < 256; ++v) {
+					const Word y = T[b*256+v];
+					if (y)
+						for (size_t w = v; w; w &= w-1)
+							c[8*b+M4RIMatrix::lowBit (w)] ^= y;
+				}
+
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp critical
+#endif
+			for (size_t k = 0; k < N; ++k)
+				C[k] ^= c[k];
+		}
+	}
+
+	template <class Matrix>
+	inline void MGBlockLanczosSolver<GF2, Matrix>::mulAddin (Word *Y, const Word *X, const Word *D, size_t n)
+	{
+		// T[b][v] is the sum of the rows 8b+t of D, for the bits t of v
+		std::vector<Word> T (8*256);
+		for (size_t b = 0; b < 8; ++b) {
+			Word *t = T.data ()+b*256;
+			t[0] = 0;
+			for (size_t v = 1; v < 256; ++v)
+				t[v] = t[v & (v-1)] ^ D[8*b+M4RIMatrix::lowBit (v)];
+		}
+
+		const Word *t = T.data ();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (n > 16384)
+#endif
+		for (long i = 0; i < (long)n; ++i) {
+			const Word x = X[i];
+			if (x)
+				Y[i] ^= t[x & 255] ^ t[256+((x >> 8) & 255)]
+				^ t[512+((x >> 16) & 255)] ^ t[768+((x >> 24) & 255)]
+				^ t[1024+((x >> 32) & 255)] ^ t[1280+((x >> 40) & 255)]
+				^ t[1536+((x >> 48) & 255)] ^ t[1792+(x >> 56)];
+		}
+	}
+
+	template <class Matrix>
+	inline void MGBlockLanczosSolver<GF2, Matrix>::mul (Word *C, const Word *A, const Word *B)
+	{
+		Word c[N];
+		for (size_t i = 0; i < N; ++i) {
+			Word s = 0;
+			for (Word a = A[i]; a; a &= a-1)
+				s ^= B[M4RIMatrix::lowBit (a)];
+			c[i] = s;
+		}
+		std::copy (c, c+N, C);
+	}
+
+	template <class Matrix>
+	inline void MGBlockLanczosSolver<GF2, Matrix>::transpose (Word *T, const Word *A)
+	{
+		// swap the off diagonal blocks of size s, s = 32, 16, ..., 1
+		std::copy (A, A+N, T);
+		Word m = 0xffffffffUL;
+		for (size_t s = 32; s; s >>= 1, m ^= m << s)
+			for (size_t k = 0; k < N; k = ((k | s) + 1) & ~s) {
+				const Word u = ((T[k] >> s) ^ T[k|s]) & m;
+				T[k] ^= u << s;
+				T[k|s] ^= u;
+			}
+	}
+
+	template <class Matrix>
+	inline void MGBlockLanczosSolver<GF2, Matrix>::transpose (Word *T, const Word *X, size_t n)
+	{
+		const size_t w = (n+N-1)/N;
+		Word a[N], t[N];
+		for (size_t b = 0; b < w; ++b) {
+			const size_t l = std::min (N, n-b*N);
+			std::copy (X+b*N, X+b*N+l, a);
+			std::fill (a+l, a+N, (Word)0);
+			transpose (t, a);
+			for (size_t k = 0; k < N; ++k)
+				T[k*w+b] = t[k];
+		}
+	}
+
+	template <class Matrix>
+	inline size_t MGBlockLanczosSolver<GF2, Matrix>::echelon (Word *E, size_t R, size_t w, Word *C, size_t cw)
+	{
+		size_t r = 0;
+		for (size_t k = 0; k < R; ++k) {
+			const Word *e = E+k*w;
+			size_t q = 0;
+			while (q < w && !e[q])
+				++q;
+			if (q == w)
+				continue;
+			++r;
+
+			// the lowest bit of row k is its pivot
+			const Word bit = e[q] & (~e[q]+1);
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (R*w > 16384)
+#endif
+			for (long l = 0; l < (long)R; ++l) {
+				Word *f = E+(size_t)l*w;
+				if (((size_t)l != k) && (f[q] & bit)) {
+					for (size_t p = q; p < w; ++p)
+						f[p] ^= e[p];
+					for (size_t p = 0; p < cw; ++p)
+						C[(size_t)l*cw+p] ^= C[k*cw+p];
+				}
+			}
+		}
+		return r;
+	}
+
+} // namespace LinBox
+
+#endif // __LINBOX_mg_block_lanczos_gf2_INL
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
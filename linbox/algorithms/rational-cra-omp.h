@@ -0,0 +1,169 @@
+/* linbox/algorithms/rational-cra-omp.h
+ * Copyright (C) 2007 LinBox
+ *
+ * Asynchronous parallel rational chinese remaindering:
+ * each OpenMP thread pulls the next coprime from the shared prime iterator,
+ * computes its residue and folds it into the builder as soon as it is done.
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+  * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file algorithms/rational-cra-omp.h
+ * @brief Parallel (OMP) version of RationalChineseRemainder
+ * @ingroup CRA
+ */
+
+#ifndef __LINBOX_rational_cra_omp_H
+#define __LINBOX_rational_cra_omp_H
+#include <omp.h>
+#include <set>
+#include <exception>
+#include "linbox/algorithms/rational-cra.h"
+
+namespace LinBox
+{
+
+	/** \brief Shared-memory parallel chinese remainder of rationals.
+	 *
+	 * Same interface as RationalChineseRemainder; the residues are computed
+	 * by all OpenMP threads and combined into the builder under a critical
+	 * section, in the order they complete.
+	 */
+	template<class RatCRABase>
+	struct RationalChineseRemainderOMP : public RationalChineseRemainder<RatCRABase> {
+		typedef typename RatCRABase::Domain		Domain;
+		typedef typename RatCRABase::DomainElement	DomainElement;
+		typedef RationalChineseRemainder<RatCRABase>	Father_t;
+
+		template<class Param>
+		RationalChineseRemainderOMP(const Param& b) :
+			Father_t(b)
+		{ }
+
+		/** \brief The Rational CRA loop, run by all OpenMP threads.
+		 *
+		 * \p Iteration must be reentrant and thread safe. What it reports to
+		 * commentator() is dropped, each thread having its own commentator.
+		 * \see RationalChineseRemainder::operator()
+		 */
+		template<class Function, class RandPrimeIterator>
+		Integer & operator() (Integer& num, Integer& den, Function& Iteration, RandPrimeIterator& genprime)
+		{
+			if (omp_get_max_threads() == 1) return Father_t::operator()(num, den, Iteration, genprime);
+			run(num, Iteration, genprime);
+			return this->Builder_.result(num, den);
+		}
+
+		template<class Function, class RandPrimeIterator>
+		BlasVector<Givaro::ZRing<Integer> > & operator() ( BlasVector<Givaro::ZRing<Integer> >& num, Integer& den, Function& Iteration, RandPrimeIterator& genprime)
+		{
+			if (omp_get_max_threads() == 1) return Father_t::operator()(num, den, Iteration, genprime);
+			run(num, Iteration, genprime);
+			return this->Builder_.result(num, den);
+		}
+
+	protected:
+		static DomainElement makeResidue(const Domain& D, const Integer&)
+		{
+			DomainElement r; D.init(r);
+			return r;
+		}
+
+		static BlasVector<Domain> makeResidue(const Domain& D, const BlasVector<Givaro::ZRing<Integer> >&)
+		{
+			return BlasVector<Domain>(D);
+		}
+
+		/** \brief Work-pulling loop shared by both result types.
+		 *
+		 * \p num is only used to select the residue type.
+		 */
+		template<class Result, class Function, class RandPrimeIterator>
+		void run(const Result& num, Function& Iteration, RandPrimeIterator& genprime)
+		{
+			std::set<Integer> inflight;	// primes handed out but not yet combined
+			bool initialized = false;
+			bool done = false;
+			std::exception_ptr failure;
+
+#pragma omp parallel shared(inflight, initialized, done, failure)
+			{
+				for (;;) {
+					Integer prime;
+					bool stop = false;
+
+#pragma omp critical (LinBoxRationalCRAOMP)
+					{
+						if (done)
+							stop = true;
+						else {
+							do {
+								++genprime;
+							} while ((initialized && this->Builder_.noncoprime(*genprime))
+								 || inflight.find(*genprime) != inflight.end());
+							prime = *genprime;
+							inflight.insert(prime);
+						}
+					}
+					if (stop) break;
+
+					Domain D(prime);
+					auto r = makeResidue(D, num);
+					try {
+						Iteration(r, D);
+					}
+					catch (...) {
+#pragma omp critical (LinBoxRationalCRAOMP)
+						{
+							if (! failure) failure = std::current_exception();
+							done = true;
+						}
+						break;
+					}
+
+#pragma omp critical (LinBoxRationalCRAOMP)
+					{
+						inflight.erase(prime);
+						if (! done) {
+							if (initialized)
+								this->Builder_.progress(D, r);
+							else {
+								this->Builder_.initialize(D, r);
+								initialized = true;
+							}
+							done = this->Builder_.terminated();
+						}
+					}
+				}
+			}
+
+			if (failure) std::rethrow_exception(failure);
+		}
+	};
+}
+
+#endif //__LINBOX_rational_cra_omp_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
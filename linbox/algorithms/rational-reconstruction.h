@@ -332,7 +332,6 @@ namespace LinBox
 #ifdef RSTIMING
 			tRecon.start();
 #endif
-			std::cout << "Start rational reconstruction:\n";
 			typename Vector::iterator num_p; typename IVector::iterator res_p;
 			Integer tmp_res, neg_res, abs_neg, l, g;
 			_r. assign(den, _r.one);
@@ -32,6 +32,7 @@
 #define __LINBOX_algorithms_rns_H
 
 #include "linbox/integer.h"
+#include <vector>
 #include <givaro/givrns.h> // Chinese Remainder of an array of elements
 
 #include <givaro/givrnsfixed.h>    // Chinese Remainder with fixed primes
@@ -69,6 +70,17 @@ namespace LinBox
 		CRTSystem     _CRT_ ;
 		Domains _PrimeDoms_ ;
 
+		// tables for the batched conversions
+		std::vector<double>  _chunkPow_; //!< \c 2^(16k) mod p_i, row \c i of length \c _chunks_
+		size_t             _chunks_; //!< number of 16-bit chunks in \c _chunkPow_
+		std::vector<double> _crtChunk_; //!< 16-bit chunks of \c q/p_i, row \c k of length \c _size_
+		std::vector<uint64_t> _crtInv_; //!< \c (q/p_i)^{-1} mod p_i
+		size_t          _crtChunks_; //!< number of 16-bit chunks in \c _crtChunk_
+
+		void initChunkPowers(size_t K) ;
+		void initCRTChunks() ;
+		size_t chunkBlock() const ;
+
 #ifdef __LINBOX_HAVE_IML
 		//! @todo IML wrapper here
 #endif
@@ -101,11 +113,34 @@ namespace LinBox
 		 *
 		 */
 		void cra(integer & result, const std::vector<double> & residues);
-		/*! Computes \c result corresponding to the \c residues.
+		/*! Computes \c result corresponding to the \c residues, for a whole vector at once.
 		 *
+		 * \c residues[i][j] is the j-th residue modulo the i-th prime.
+		 * The images <code>y_ij = r_ij (q/p_i)^{-1} mod p_i</code> are combined
+		 * by a matrix product with the 16-bit chunks of the \c q/p_i,
+		 * and each result is then reduced modulo \c q.
+		 * Does not need initCRA().
 		 */
 		void cra(std::vector<integer> & result, const std::vector<std::vector<double> > & residues);
 
+		/*! Reduces \c n integers modulo all the primes at once.
+		 *
+		 * The integers are cut in 16-bit chunks; the residues are then the
+		 * product of the table of <code>2^(16k) mod p_i</code> by the matrix of
+		 * the chunks, computed by BLAS over the doubles and reduced as soon as
+		 * more chunks would no longer be exact.
+		 * @param[out] residues \c residues[i][j] is the j-th integer modulo the i-th prime, in \c [0,p_i)
+		 * @param A iterator on the integers (e.g. the \c Begin() of a matrix)
+		 * @param n number of integers
+		 */
+		template<class IntIterator>
+		void reduce(std::vector<std::vector<double> > & residues, IntIterator A, size_t n) ;
+
+		void reduce(std::vector<std::vector<double> > & residues, const Ivect & A)
+		{
+			reduce(residues, A.begin(), A.size());
+		}
+
 		/*! Computes \c result corresponding to the iteration.
 		 *
 		 */
@@ -32,14 +32,19 @@
 #define __LINBOX_algorithms_rns_INL
 
 #include <set>
+#include <algorithm>
+#include <cmath>
+#include <givaro/zring.h>
+#include <fflas-ffpack/fflas/fflas.h>
 #include "linbox/util/debug.h"
+#include "linbox/randiter/random-prime.h"
 
 namespace LinBox
 {
 	/* Constructor */
 	template<bool Unsigned>
 	RNS<Unsigned>::RNS(size_t l, size_t ps) :
-		_bit_(l),  _ps_(ps)
+		_bit_(l),  _ps_(ps), _chunks_(0), _crtChunks_(0)
 	{
 		linbox_check(ps<30); // oupa, mais moins qu'un size_t
 		unsigned int nb_primes = (unsigned int) std::ceil(double(l)/double(ps));
@@ -104,6 +109,181 @@ namespace LinBox
 		return ;
 	}
 
+	namespace Protected {
+		/*! Writes the \c K least significant 16-bit chunks of \c |a|
+		 * to \c c[0], \c c[ld], \c c[2ld], ...
+		 */
+		inline void toChunks(double * c, size_t ld, size_t K, const integer & a)
+		{
+			mpz_srcptr z = a.get_mpz_const();
+			const size_t limbs = mpz_size(z);
+			size_t k = 0 ;
+			for (size_t l = 0 ; l < limbs && k < K ; ++l) {
+				mp_limb_t w = mpz_getlimbn(z, (mp_size_t)l);
+				for (size_t s = 0 ; s < GMP_NUMB_BITS/16 && k < K ; ++s, ++k, w >>= 16)
+					c[k*ld] = (double)(w & 0xFFFF);
+			}
+			for ( ; k < K ; ++k)
+				c[k*ld] = 0. ;
+		}
+	}
+
+	/*! Number of products of a chunk by a residue that can be summed
+	 * (on top of a residue) exactly in a double.
+	 */
+	template<bool Unsigned>
+	size_t
+	RNS<Unsigned>::chunkBlock() const
+	{
+		const double maxp = (double)*std::max_element(_primes_.begin(), _primes_.end());
+		const size_t kb = (size_t)((9007199254740992. - maxp) / ((maxp-1.)*65535.)); // 2^53
+		linbox_check(kb > 0);
+		return kb ;
+	}
+
+	template<bool Unsigned>
+	void
+	RNS<Unsigned>::initChunkPowers(size_t K)
+	{
+		if (K <= _chunks_)
+			return ;
+		_chunkPow_.resize(_size_*K);
+		for (size_t i = 0 ; i < _size_ ; ++i) {
+			const uint64_t p = _primes_[i];
+			uint64_t pw = 1 % p ;
+			for (size_t k = 0 ; k < K ; ++k) {
+				_chunkPow_[i*K+k] = (double)pw ;
+				pw = (pw << 16) % p ;
+			}
+		}
+		_chunks_ = K ;
+	}
+
+	template<bool Unsigned>
+	void
+	RNS<Unsigned>::initCRTChunks()
+	{
+		if (_crtChunks_)
+			return ;
+		const size_t K = (_maxint_.bitsize()+15)/16 ;
+		_crtChunk_.resize(K*_size_);
+		_crtInv_.resize(_size_);
+		integer Mi, u ;
+		for (size_t i = 0 ; i < _size_ ; ++i) {
+			const integer p(_primes_[i]);
+			Integer::div(Mi, _maxint_, p);
+			inv(u, Mi % p, p); // u <- (q/p_i)^{-1} mod p_i
+			_crtInv_[i] = (uint64_t)u ;
+			Protected::toChunks(_crtChunk_.data()+i, _size_, K, Mi);
+		}
+		_crtChunks_ = K ;
+	}
+
+	template<bool Unsigned>
+	template<class IntIterator>
+	void
+	RNS<Unsigned>::reduce(std::vector<std::vector<double> > & residues, IntIterator A, size_t n)
+	{
+		// chunks of the largest integer
+		size_t K = 1 ;
+		IntIterator a = A ;
+		for (size_t j = 0 ; j < n ; ++j, ++a)
+			K = std::max(K, (size_t)((*a).bitsize()+15)/16);
+		initChunkPowers(K);
+
+		// C (K x n) : column j holds the chunks of the j-th integer
+		std::vector<double> C(K*n);
+		std::vector<char> negative(n);
+		a = A ;
+		for (size_t j = 0 ; j < n ; ++j, ++a) {
+			Protected::toChunks(C.data()+j, n, K, *a);
+			negative[j] = (*a < 0);
+		}
+
+		// R (_size_ x n) = Pow . C, by blocks of chunks small enough to stay exact
+		std::vector<double> R(_size_*n, 0.);
+		Givaro::ZRing<double> Z ;
+		const size_t kb = chunkBlock();
+		for (size_t k0 = 0 ; k0 < K ; k0 += kb) {
+			const size_t kk = std::min(kb, K-k0);
+			FFLAS::fgemm(Z, FFLAS::FflasNoTrans, FFLAS::FflasNoTrans, _size_, n, kk,
+				     Z.one, _chunkPow_.data()+k0, _chunks_, C.data()+k0*n, n,
+				     Z.one, R.data(), n);
+			for (size_t i = 0 ; i < _size_ ; ++i) {
+				const double p = (double)_primes_[i];
+				double * Ri = R.data()+i*n ;
+				for (size_t j = 0 ; j < n ; ++j)
+					Ri[j] = std::fmod(Ri[j], p);
+			}
+		}
+
+		residues.resize(_size_);
+		for (size_t i = 0 ; i < _size_ ; ++i) {
+			const double p = (double)_primes_[i];
+			const double * Ri = R.data()+i*n ;
+			residues[i].resize(n);
+			for (size_t j = 0 ; j < n ; ++j)
+				residues[i][j] = (negative[j] && Ri[j] != 0.) ? p - Ri[j] : Ri[j] ;
+		}
+		return ;
+	}
+
+	template<bool Unsigned>
+	void
+	RNS<Unsigned>::cra(std::vector<integer> & result, const std::vector<std::vector<double> > & residues)
+	{
+		linbox_check(residues.size() == _size_);
+		const size_t n = _size_ ? residues[0].size() : 0 ;
+		initCRTChunks();
+		const size_t K = _crtChunks_ ;
+
+		// Y (_size_ x n) : y_ij = r_ij (q/p_i)^{-1} mod p_i
+		std::vector<double> Y(_size_*n);
+		for (size_t i = 0 ; i < _size_ ; ++i) {
+			const uint64_t p = _primes_[i];
+			for (size_t j = 0 ; j < n ; ++j)
+				Y[i*n+j] = (double)( ((uint64_t)residues[i][j] * _crtInv_[i]) % p );
+		}
+
+		// S (K x n) = chunks(q/p_i) . Y, by blocks of primes small enough to stay exact
+		std::vector<double> Sb(K*n);
+		std::vector<uint64_t> S(K*n, 0u);
+		Givaro::ZRing<double> Z ;
+		const size_t ib = chunkBlock();
+		for (size_t i0 = 0 ; i0 < _size_ ; i0 += ib) {
+			const size_t ii = std::min(ib, _size_-i0);
+			FFLAS::fgemm(Z, FFLAS::FflasNoTrans, FFLAS::FflasNoTrans, K, n, ii,
+				     Z.one, _crtChunk_.data()+i0, _size_, Y.data()+i0*n, n,
+				     Z.zero, Sb.data(), n);
+			for (size_t l = 0 ; l < K*n ; ++l)
+				S[l] += (uint64_t)Sb[l] ;
+		}
+
+		// result_j = sum_k S_kj 2^(16k), by carry propagation, then mod q
+		result.resize(n);
+		std::vector<uint16_t> digits(K+4);
+		for (size_t j = 0 ; j < n ; ++j) {
+			uint64_t carry = 0 ;
+			size_t k = 0 ;
+			for ( ; k < K ; ++k) {
+				carry += S[k*n+j] ;
+				digits[k] = (uint16_t)(carry & 0xFFFF);
+				carry >>= 16 ;
+			}
+			for ( ; carry ; ++k) {
+				digits[k] = (uint16_t)(carry & 0xFFFF);
+				carry >>= 16 ;
+			}
+			mpz_import(result[j].get_mpz(), k, -1, sizeof(uint16_t), 0, 0, digits.data());
+			Integer::modin(result[j], _maxint_);
+			linbox_check(result[j] >=0);
+			if (!Unsigned)
+				if (result[j]>_midint_)
+					Integer::subin(result[j],_maxint_);
+		}
+		return ;
+	}
+
 	template<bool Unsigned>
 	void
 	RNS<Unsigned>::cra(integer & result, const std::vector<double> & residues)
@@ -0,0 +1,352 @@
+/* linbox/algorithms/sparse-reordering.h
+ * Copyright (C) LinBox
+ *
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ *.
+ */
+
+/*! @file algorithms/sparse-reordering.h
+ * @ingroup algorithms
+ * @brief Bandwidth reducing permutations of sparse matrices.
+ *
+ * The reverse Cuthill-McKee ordering gathers the nonzeros of a sparse
+ * matrix around its diagonal, so that the rows close in the matrix use
+ * entries close in the vector during an apply.
+ */
+
+#ifndef __LINBOX_sparse_reordering_H
+#define __LINBOX_sparse_reordering_H
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include "linbox/matrix/matrix-traits.h"
+#include "linbox/matrix/sparse-matrix.h"
+#include "linbox/blackbox/permutation.h"
+
+namespace LinBox
+{
+
+	namespace Protected {
+
+		/// a nonzero entry of a sparse matrix.
+		template<class Element>
+		struct SparseEntry {
+			size_t row ;
+			size_t col ;
+			Element value ;
+		};
+
+		template<class Matrix>
+		void sparseEntries(std::vector<SparseEntry<typename Matrix::Element> > & E, const Matrix & A,
+				   IndexedTags::HasIndexed)
+		{
+			for (auto it = A.IndexedBegin(); it != A.IndexedEnd(); ++it) {
+				SparseEntry<typename Matrix::Element> e ;
+				e.row = (size_t)it.rowIndex() ;
+				e.col = (size_t)it.colIndex() ;
+				e.value = it.value() ;
+				E.push_back(e);
+			}
+		}
+
+		template<class Matrix>
+		void sparseEntries(std::vector<SparseEntry<typename Matrix::Element> > & E, const Matrix & A,
+				   IndexedTags::HasNext)
+		{
+			SparseEntry<typename Matrix::Element> e ;
+			A.firstTriple();
+			while (A.nextTriple(e.row, e.col, e.value))
+				E.push_back(e);
+			A.firstTriple();
+		}
+
+		/// nonzero entries of \p A, in any order.
+		template<class Matrix>
+		void sparseEntries(std::vector<SparseEntry<typename Matrix::Element> > & E, const Matrix & A)
+		{
+			E.clear();
+			sparseEntries(E, A, typename IndexedCategory<Matrix>::Tag());
+		}
+
+		/** Reverse Cuthill-McKee order of the vertices of a graph.
+		 * Each connected component starts from a pseudo-peripheral vertex,
+		 * found as in George and Liu.
+		 * @param adj adjacency lists, without loops nor repetitions.
+		 */
+		class CuthillMcKee {
+			const std::vector<std::vector<size_t> > & _adj ;
+			std::vector<long>   _level ;
+			std::vector<bool>   _done ;
+
+		public:
+			CuthillMcKee(const std::vector<std::vector<size_t> > & adj) :
+				_adj(adj), _level(adj.size(),-1), _done(adj.size(),false)
+			{}
+
+			std::vector<size_t> & order(std::vector<size_t> & perm)
+			{
+				const size_t N = _adj.size() ;
+				perm.clear();
+				perm.reserve(N);
+
+				std::vector<size_t> bydegree(N);
+				for (size_t v = 0 ; v < N ; ++v)
+					bydegree[v] = v ;
+				std::stable_sort(bydegree.begin(), bydegree.end(), ByDegree(_adj));
+
+				for (size_t k = 0 ; k < N ; ++k) {
+					if (_done[bydegree[k]])
+						continue ;
+					number(perm, peripheral(bydegree[k]));
+				}
+				std::reverse(perm.begin(), perm.end());
+				return perm ;
+			}
+
+		private:
+			struct ByDegree {
+				const std::vector<std::vector<size_t> > & adj ;
+				ByDegree(const std::vector<std::vector<size_t> > & a) : adj(a) {}
+				bool operator()(size_t u, size_t v) const
+				{
+					return adj[u].size() < adj[v].size() ;
+				}
+			};
+
+			/// breadth first levels from \p root, returns the depth and the last level.
+			long levels(size_t root, std::vector<size_t> & last)
+			{
+				std::vector<size_t> seen(1,root);
+				_level[root] = 0 ;
+				for (size_t h = 0 ; h < seen.size() ; ++h) {
+					const size_t u = seen[h] ;
+					for (size_t k = 0 ; k < _adj[u].size() ; ++k) {
+						const size_t v = _adj[u][k] ;
+						if (_level[v] < 0) {
+							_level[v] = _level[u]+1 ;
+							seen.push_back(v);
+						}
+					}
+				}
+				const long depth = _level[seen.back()] ;
+				last.clear();
+				for (size_t h = seen.size() ; h-- > 0 && _level[seen[h]] == depth ; )
+					last.push_back(seen[h]);
+				for (size_t h = 0 ; h < seen.size() ; ++h)
+					_level[seen[h]] = -1 ;
+				return depth ;
+			}
+
+			size_t peripheral(size_t root)
+			{
+				std::vector<size_t> last ;
+				long depth = levels(root, last);
+				for (;;) {
+					size_t v = *std::min_element(last.begin(), last.end(), ByDegree(_adj));
+					std::vector<size_t> vlast ;
+					const long vdepth = levels(v, vlast);
+					if (vdepth <= depth)
+						return root ;
+					root = v ;
+					depth = vdepth ;
+					last.swap(vlast);
+				}
+			}
+
+			/// Cuthill-McKee numbering of the component of \p root.
+			void number(std::vector<size_t> & perm, size_t root)
+			{
+				std::deque<size_t> queue(1,root);
+				_done[root] = true ;
+				std::vector<size_t> next ;
+				while (!queue.empty()) {
+					const size_t u = queue.front() ;
+					queue.pop_front();
+					perm.push_back(u);
+					next.clear();
+					for (size_t k = 0 ; k < _adj[u].size() ; ++k)
+						if (!_done[_adj[u][k]]) {
+							_done[_adj[u][k]] = true ;
+							next.push_back(_adj[u][k]);
+						}
+					std::stable_sort(next.begin(), next.end(), ByDegree(_adj));
+					queue.insert(queue.end(), next.begin(), next.end());
+				}
+			}
+		};
+
+		inline void addEdge(std::vector<std::vector<size_t> > & adj, size_t u, size_t v)
+		{
+			adj[u].push_back(v);
+			adj[v].push_back(u);
+		}
+
+	} // Protected
+
+	/** Reverse Cuthill-McKee ordering of the rows and columns of \p A.
+	 *
+	 * Row \p rowOrder[i] (resp. column \p colOrder[j]) of \p A becomes row
+	 * \p i (resp. column \p j) of the reordered matrix.
+	 *
+	 * @param symmetric if true, \p A is square and the rows and columns are
+	 * ordered alike, following the graph of \f$A+A^T\f$. Otherwise they are
+	 * ordered separately, following the bipartite graph of \p A.
+	 */
+	template<class Matrix>
+	void reverseCuthillMcKee(std::vector<size_t> & rowOrder, std::vector<size_t> & colOrder,
+				 const Matrix & A, bool symmetric)
+	{
+		const size_t m = A.rowdim() ;
+		const size_t n = A.coldim() ;
+		linbox_check(!symmetric || m == n);
+
+		std::vector<Protected::SparseEntry<typename Matrix::Element> > E ;
+		Protected::sparseEntries(E, A);
+
+		std::vector<std::vector<size_t> > adj(symmetric ? m : m+n) ;
+		for (size_t k = 0 ; k < E.size() ; ++k) {
+			if (symmetric) {
+				if (E[k].row != E[k].col)
+					Protected::addEdge(adj, E[k].row, E[k].col);
+			}
+			else
+				Protected::addEdge(adj, E[k].row, m+E[k].col);
+		}
+		for (size_t v = 0 ; v < adj.size() ; ++v) {
+			std::sort(adj[v].begin(), adj[v].end());
+			adj[v].erase(std::unique(adj[v].begin(), adj[v].end()), adj[v].end());
+		}
+
+		std::vector<size_t> perm ;
+		Protected::CuthillMcKee(adj).order(perm);
+
+		if (symmetric) {
+			rowOrder = perm ;
+			colOrder = perm ;
+			return ;
+		}
+		rowOrder.clear();
+		colOrder.clear();
+		for (size_t k = 0 ; k < perm.size() ; ++k) {
+			if (perm[k] < m)
+				rowOrder.push_back(perm[k]);
+			else
+				colOrder.push_back(perm[k]-m);
+		}
+	}
+
+	/// same, symmetric when \p A is square.
+	template<class Matrix>
+	void reverseCuthillMcKee(std::vector<size_t> & rowOrder, std::vector<size_t> & colOrder,
+				 const Matrix & A)
+	{
+		reverseCuthillMcKee(rowOrder, colOrder, A, A.rowdim() == A.coldim());
+	}
+
+	/** \p B <- \p P \p A \p Q^T, for the reverse Cuthill-McKee permutations
+	 * \p P and \p Q.
+	 *
+	 * B(i,j) = A(P[i],Q[j]). The results on \p B map back to \p A :
+	 * - rank(A) = rank(B), and det(A) = det(P) det(Q) det(B) ;
+	 * - A x = b iff B y = P b, with x = Q^T y ;
+	 * - when \p A is square, P = Q : \p B is similar to \p A and has
+	 *   the same minimal and characteristic polynomials.
+	 *
+	 * @param B sparse matrix, of any format, resized.
+	 */
+	template<class Matrix, class OutMatrix>
+	OutMatrix & reorder(OutMatrix & B,
+			    Permutation<typename Matrix::Field> & P,
+			    Permutation<typename Matrix::Field> & Q,
+			    const Matrix & A)
+	{
+		const size_t m = A.rowdim() ;
+		const size_t n = A.coldim() ;
+		std::vector<size_t> rows, cols ;
+		reverseCuthillMcKee(rows, cols, A);
+		P.init(rows.data(), m);
+		Q.init(cols.data(), n);
+
+		std::vector<size_t> newrow(m), newcol(n) ;
+		for (size_t i = 0 ; i < m ; ++i)
+			newrow[rows[i]] = i ;
+		for (size_t j = 0 ; j < n ; ++j)
+			newcol[cols[j]] = j ;
+
+		typedef Protected::SparseEntry<typename Matrix::Element> Entry ;
+		std::vector<Entry> E ;
+		Protected::sparseEntries(E, A);
+		for (size_t k = 0 ; k < E.size() ; ++k) {
+			E[k].row = newrow[E[k].row] ;
+			E[k].col = newcol[E[k].col] ;
+		}
+		std::sort(E.begin(), E.end(), [](const Entry & a, const Entry & b) {
+			return a.row < b.row || (a.row == b.row && a.col < b.col) ; });
+
+		B.resize(m, n);
+		for (size_t k = 0 ; k < E.size() ; ++k)
+			B.appendEntry(E[k].row, E[k].col, E[k].value);
+		B.finalize();
+		return B ;
+	}
+
+	/// largest |i-j| for a nonzero A(i,j).
+	template<class Matrix>
+	size_t bandwidth(const Matrix & A)
+	{
+		std::vector<Protected::SparseEntry<typename Matrix::Element> > E ;
+		Protected::sparseEntries(E, A);
+		size_t b = 0 ;
+		for (size_t k = 0 ; k < E.size() ; ++k)
+			b = std::max(b, E[k].row > E[k].col ? E[k].row - E[k].col : E[k].col - E[k].row);
+		return b ;
+	}
+
+	/// determinant of a permutation matrix, 1 or -1.
+	template<class Field>
+	int permutationSign(const Permutation<Field> & P)
+	{
+		const size_t n = P.rowdim() ;
+		std::vector<bool> seen(n,false);
+		int s = 1 ;
+		for (size_t i = 0 ; i < n ; ++i) {
+			if (seen[i]) continue ;
+			// a cycle of length l has sign (-1)^(l-1)
+			for (size_t j = (size_t)P.getStorage()[i] ; j != i ; j = (size_t)P.getStorage()[j]) {
+				seen[j] = true ;
+				s = -s ;
+			}
+			seen[i] = true ;
+		}
+		return s ;
+	}
+
+}
+
+#endif // __LINBOX_sparse_reordering_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -35,6 +35,7 @@
 #include "givaro-config.h"
 #include "linbox/integer.h"
 #include "linbox/util/debug.h"
+#include "linbox/util/thread-scratch.h"
 // #if defined(__LINBOX_field_multimod_field_H) && !defined(__LINBOX_blas_matrix_domain_H)
 // #error "you need to include \"multimod-field.h\" before \"blas-domain.h\""
 // #endif
@@ -45,6 +46,7 @@
 #include "linbox/matrix/dense-matrix.h"
 #include "linbox/algorithms/lifting-container.h"
 #include <vector>
+#include <type_traits>
 #include "linbox/vector/blas-vector.h"
 
 
@@ -336,7 +338,7 @@ namespace LinBox
 			_domain(D), _matM(Mat), _MD(D), _m(Mat.rowdim()), _n(Mat.coldim())
 			,use_chunks(false),use_neg(false),chunk_size(0)
 			,num_chunks(0)
-			,chunks(NULL),vchunks(NULL)
+			,chunks(NULL)
 		{
 			_switcher= Classic;_rns=NULL;
 		}
@@ -345,7 +347,7 @@ namespace LinBox
 		~BlasMatrixApplyDomain ()
 		{
 			if (_switcher==MatrixQadic) delete[] chunks;
-			if (_switcher==VectorQadic) {delete[] chunks;delete[] vchunks;}
+			if (_switcher==VectorQadic) delete[] chunks;
 			if (_switcher== CRT) delete _rns;
 			//std::cout<<"time convert data = "<<_convert_data<<std::endl;
 			//std::cout<<"time apply   = "<<_apply<<std::endl;
@@ -355,6 +357,13 @@ namespace LinBox
 		ApplyChoice  setup(LinBox::integer prime)
 		{ //setup
 
+			// release the buffers of a previous setup
+			if (_switcher==MatrixQadic) delete[] chunks;
+			if (_switcher==VectorQadic) delete[] chunks;
+			if (_switcher== CRT) delete _rns;
+			chunks = NULL; _rns = NULL;
+			_switcher= Classic;
+
 			_domain.init(_prime,prime);
 			_apply.clear();
 			_convert_data.clear();
@@ -483,9 +492,6 @@ namespace LinBox
 						chunks[i]+=sh;
 
 				}
-
-				// allocate memory for the vector chunks
-				vchunks = new double[_n*num_chunks];
 				break;
 
 			case Classic:
@@ -497,21 +503,23 @@ namespace LinBox
 					// maxBitSize+=1;
 				}
 				integer a_bound= maxValue*uint64_t(_n)+1;
-				integer b_bound= sqrt(integer("9007199254740992")/uint64_t(_n));	std::cout<<"max prime: "<<b_bound<<" max rns: "<<a_bound<<std::endl;
+				integer b_bound= sqrt(integer("9007199254740992")/uint64_t(_n));
+#ifdef DEBUG_CHUNK_SETUP
+				std::cout<<"max prime: "<<b_bound<<" max rns: "<<a_bound<<std::endl;
+#endif
 				MultiModRandomPrime mmrp;
 				std::vector<integer> rns_basis = mmrp.createPrimes(b_bound, a_bound);
 				_rns = new MultiModDouble(rns_basis);
 
+#ifdef DEBUG_CHUNK_SETUP
 				std::cout<<" CRT basi length= "<<_rns->size()<<std::endl;
+#endif
 
 				// convert integer matrix to rns double matrix
 				chunks  = new double[_m*_n*_rns->size()];
 				memset(chunks, 0, sizeof(double)*_m*_n*_rns->size());
 				create_MatrixRNS(*_rns, _domain, _matM, chunks);
 
-				// allocate memory for the rns vector
-				vchunks = new double[_n*_rns->size()];
-
 				// prepare special CRT
 				Element g, s, q, two;
 				_q= _rns->getCRTmodulo();
@@ -562,19 +570,17 @@ namespace LinBox
 					_MD.vectorMul (y, _matM, x);
 					break;
 #endif
-					double* dx = new double[_n];
+					double* dx = scratch<double, DX>(_n);
 					for (size_t i=0; i<_n; i++) {
 						_domain.convert(dx[i], x[i]);
 					}
 					if (num_chunks == 1) {
-						double *ctd = new double[_m];
+						double *ctd = scratch<double, CTD>(_m);
 						cblas_dgemv(CblasRowMajor, CblasNoTrans, (int) _m, (int) _n,
 							    1,  chunks, (int) _n, dx, 1, 0,  ctd, 1);
 
-						for (size_t i=0;i<_n;++i)
+						for (size_t i=0;i<_m;++i)
 							_domain.init(y[i],ctd[i]);
-						delete[] ctd;
-						delete[] dx;
 					}
 					else {
 						/*
@@ -593,13 +599,13 @@ namespace LinBox
 						 */
 						int rclen = (int)num_chunks*2 + 5;
 
-						unsigned char* combined = new unsigned char[(size_t)rc*_n*(size_t)rclen];
+						unsigned char* combined = scratch<unsigned char, Combined>((size_t)rc*_n*(size_t)rclen);
 						memset(combined, 0, (size_t)rc*_n*(size_t)rclen);
 
 						//order from major index to minor: combining index, component of sol'n, byte
 						//compute a product (chunk times x) for each chunk
 
-						double* ctd = new double[_n];
+						double* ctd = scratch<double, CTD>(_n);
 #ifdef DEBUG_CHUNK_APPLY
 
 
@@ -638,9 +644,8 @@ namespace LinBox
 								memcpy(bitDest,&tmp,sizeof(long long));
 							}
 						}
-						delete[] dx;
+						LinBox::integer result, tmp;
 						for (size_t i=0; i<_n; i++) {
-							LinBox::integer result, tmp;
 							/*
 							   if (use_neg) {
 							   result = -ctd[i];
@@ -668,8 +673,6 @@ namespace LinBox
 							for (size_t i=0;i<y.size();++i)
 								_domain.subin(y[i], acc);
 						}
-						delete[] combined;
-						delete[] ctd;
 					}
 				}
 				break;
@@ -682,6 +685,7 @@ namespace LinBox
 					chrono.start();
 #endif
 					// fill vector chunks with zero
+					double *vchunks = scratch<double, VChunks>(_n*num_chunks);
 					memset(vchunks, 0, sizeof(double)*_n*num_chunks);
 
 					// smallest distance of non-overlaping chunks results
@@ -693,9 +697,9 @@ namespace LinBox
 					// number of byte to store
 					size_t rclen = num_chunks*chunk_byte + 5;
 
-					unsigned char* combined = new unsigned char[rclen];
+					unsigned char* combined = scratch<unsigned char, Combined>(rclen);
 
-					double *ctd= new double[_m*num_chunks];
+					double *ctd= scratch<double, CTD>(_m*num_chunks);
 					if (chunk_size >=32)
 						create_VectorQadic_32 (_domain, x, vchunks, num_chunks);
 					else
@@ -740,8 +744,9 @@ namespace LinBox
 						std::cout<<std::endl;
 					}
 #endif
+					integer result, val;
 					for (size_t i=0; i< _m; ++i){
-						integer result=0, val;
+						result=0;
 						for (size_t k=0; k< rc;++k){
 							memset(combined, 0, rclen);
 							unsigned char* BitDest = combined+chunk_byte*k;
@@ -771,8 +776,6 @@ namespace LinBox
 							_domain.subin(y[i], acc);
 					}
 
-					delete[] combined;
-					delete[] ctd;
 #ifdef TIMING_APPLY
 					chrono.stop();
 					_convert_result+=chrono;
@@ -798,10 +801,11 @@ namespace LinBox
 					//memset(vchunks, 0, sizeof(double)*_n*rns_size);
 
 					// create rns vector
+					double *vchunks = scratch<double, VChunks>(_n*rns_size);
 					create_VectorRNS (*_rns, _domain, x, vchunks);
 
 					// allocate memory for the result
-					double *ctd= new double[_m*rns_size];
+					double *ctd= scratch<double, CTD>(_m*rns_size);
 #ifdef TIMING_APPLY
 					chrono.stop();
 					_convert_data+=chrono;
@@ -856,7 +860,6 @@ namespace LinBox
 						_domain.init(y[j], res);
 						//if (y[j] > hmod) y[j]-=mod;
 					}
-					delete[] ctd;
 
 #if 0
 					std::cout << "y mod q: ";
@@ -1047,13 +1050,25 @@ namespace LinBox
 		size_t         chunk_size;
 		size_t         num_chunks;
 		double *           chunks;
-		double *          vchunks;
 		integer             shift;
 		ApplyChoice     _switcher;
 		MultiModDouble      *_rns;
 		Element            _prime, _q, _inv_q, _pq, _h_pq;
 		mutable Timer              _apply, _convert_data, _convert_result;
 
+		// scratch buffers of applyV
+		enum ScratchBuffer { DX, CTD, VChunks, Combined };
+
+		// returns a buffer of at least n entries, only reallocated when it grows.
+		// The buffers are per thread, so that applyV may run in several threads at once.
+		template <class T, int Buffer>
+		static T* scratch(size_t n)
+		{
+			std::vector<T> & buf = threadScratch<std::vector<T>, std::integral_constant<int, Buffer> >();
+			if (buf.size() < n) buf.resize(n);
+			return buf.data();
+		}
+
 
 
 
@@ -79,7 +79,8 @@ namespace LinBox
 		std::vector< std::pair<size_t, size_t> >::const_iterator idx_iter = _indices.begin ();
 		typename std::vector<Switch>::const_iterator switch_iter = _switches.begin ();
 
-		_VD.copy (y, x);
+		if ((const void*)&y != (const void*)&x)
+			_VD.copy (y, x);
 
 		for (; idx_iter != _indices.end (); ++idx_iter, ++switch_iter)
 			switch_iter->apply (field(), y[idx_iter->first], y[idx_iter->second]);
@@ -94,7 +95,8 @@ namespace LinBox
 		std::vector< std::pair<size_t, size_t> >::const_reverse_iterator idx_iter = _indices.rbegin ();
 		typename std::vector<Switch>::const_reverse_iterator switch_iter = _switches.rbegin ();
 
-		_VD.copy (y, x);
+		if ((const void*)&y != (const void*)&x)
+			_VD.copy (y, x);
 
 		for (; idx_iter != _indices.rend (); ++idx_iter, ++switch_iter)
 			switch_iter->applyTranspose (field(), y[idx_iter->first], y[idx_iter->second]);
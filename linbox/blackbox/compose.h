@@ -32,6 +32,10 @@
 #include "linbox/linbox-config.h"
 #include "linbox/blackbox/blackbox-interface.h"
 #include "linbox/vector/blas-vector.h"
+#include "linbox/vector/scratch-vector.h"
+#include "linbox/vector/vector-traits.h"
+
+#include <type_traits>
 
 namespace LinBox
 {
@@ -40,12 +44,78 @@ namespace LinBox
 
 	template <class _Blackbox1, class _Blackbox2 = _Blackbox1>
 	class ComposeOwner;
+
+	template <class Field, class Trait>
+	class Diagonal;
+
+	template <class _Field, class Switch>
+	class Butterfly;
+
+	/** Whether <code>A.apply (y, y)</code> and <code>A.applyTranspose (y, y)</code>
+	 * are allowed, for a square black box A.
+	 *
+	 * A composition whose outer factor has this property is applied
+	 * without an intermediate vector.
+	 */
+	template <class Blackbox>
+	struct ApplyInPlace : public std::false_type {};
+
+	template <class Field>
+	struct ApplyInPlace<Diagonal<Field, VectorCategories::DenseVectorTag> > : public std::true_type {};
+
+	template <class Field, class Switch>
+	struct ApplyInPlace<Butterfly<Field, Switch> > : public std::true_type {};
 }
 
 
 namespace LinBox
 {
 
+	namespace Protected {
+
+		// y = A (B x), through a scratch vector
+		template <class OutVector, class Blackbox1, class Blackbox2, class InVector>
+		inline OutVector& composeApply (OutVector& y, const Blackbox1& A, const Blackbox2& B,
+						const InVector& x, std::false_type)
+		{
+			ScratchVector<typename Blackbox2::Field> z (B.field(), A.coldim());
+			B.apply (*z, x);
+			return A.apply (y, *z);
+		}
+
+		// y = A (B x), A applied in place in y
+		template <class OutVector, class Blackbox1, class Blackbox2, class InVector>
+		inline OutVector& composeApply (OutVector& y, const Blackbox1& A, const Blackbox2& B,
+						const InVector& x, std::true_type)
+		{
+			if ((const void*)&y == (const void*)&x)
+				return composeApply (y, A, B, x, std::false_type ());
+			B.apply (y, x);
+			return A.apply (y, y);
+		}
+
+		// y = B^T (A^T x), through a scratch vector
+		template <class OutVector, class Blackbox1, class Blackbox2, class InVector>
+		inline OutVector& composeApplyTranspose (OutVector& y, const Blackbox1& A, const Blackbox2& B,
+							 const InVector& x, std::false_type)
+		{
+			ScratchVector<typename Blackbox2::Field> z (B.field(), A.coldim());
+			A.applyTranspose (*z, x);
+			return B.applyTranspose (y, *z);
+		}
+
+		// y = B^T (A^T x), B^T applied in place in y
+		template <class OutVector, class Blackbox1, class Blackbox2, class InVector>
+		inline OutVector& composeApplyTranspose (OutVector& y, const Blackbox1& A, const Blackbox2& B,
+							 const InVector& x, std::true_type)
+		{
+			if ((const void*)&y == (const void*)&x)
+				return composeApplyTranspose (y, A, B, x, std::false_type ());
+			A.applyTranspose (y, x);
+			return B.applyTranspose (y, y);
+		}
+	}
+
 	/**
 	 * Blackbox of a product: \f$C = AB\f$, i.e \f$Cx \gets A(Bx)\f$.
 
@@ -81,14 +151,8 @@ namespace LinBox
 		 * @param B blackbox
 		 */
 		Compose (const Blackbox1 &A, const Blackbox2 &B) :
-			_A_ptr(&A), _B_ptr(&B),_z(A.field())
-		{
-			// Rich Seagraves - "It seems VectorWrapper somehow
-			// became depricated.  Makes the assumption that
-			// this vector type supports resize"
-			// VectorWrapper::ensureDim (_z, _A_ptr->coldim ());
-			_z.resize(_A_ptr->coldim());
-		}
+			_A_ptr(&A), _B_ptr(&B)
+		{}
 
 		/** Constructor of C := (*A_ptr)*(*B_ptr).
 		 * This constructor creates a matrix that is a product of two black box
@@ -97,14 +161,11 @@ namespace LinBox
 		 * @param B_ptr blackbox
 		 */
 		Compose (const Blackbox1 *A_ptr, const Blackbox2 *B_ptr) :
-			_A_ptr(A_ptr), _B_ptr(B_ptr),_z(A_ptr->field())
+			_A_ptr(A_ptr), _B_ptr(B_ptr)
 		{
 			linbox_check (A_ptr != (Blackbox1 *) 0);
 			linbox_check (B_ptr != (Blackbox2 *) 0);
 			linbox_check (A_ptr->coldim () == B_ptr->rowdim ());
-
-			//			VectorWrapper::ensureDim (_z, _A_ptr->coldim ());
-			_z.resize(_A_ptr->coldim());
 		}
 
 		/** Copy constructor.
@@ -113,10 +174,8 @@ namespace LinBox
 		 * @param[in] Mat blackbox to copy.
 		 */
 		Compose (const Compose<Blackbox1, Blackbox2>& Mat) :
-			_A_ptr ( Mat._A_ptr), _B_ptr ( Mat._B_ptr),_z(Mat.field())
-		{
-			_z.resize(_A_ptr->coldim());
-		}
+			_A_ptr ( Mat._A_ptr), _B_ptr ( Mat._B_ptr)
+		{}
 
 		/// Destructor
 		~Compose () {}
@@ -134,7 +193,9 @@ namespace LinBox
 
 		/** Matrix * column vector product.
 		 * \f$ y \gets (A\cdot B)\cdot x\f$
-		 * Applies B, then A.
+		 * Applies B, then A, in place in y when \c ApplyInPlace<Blackbox1>.
+		 * The intermediate vector is a \ref ScratchVector, so that the
+		 * composition may be applied from several threads at once.
 		 * @return reference to vector y containing output.
 		 * @param  x constant reference to vector to contain input
 		 * @param[out] y the result.
@@ -142,10 +203,8 @@ namespace LinBox
 		template <class OutVector, class InVector>
 		inline OutVector& apply (OutVector& y, const InVector& x) const
 		{
-			if ((_A_ptr != 0) && (_B_ptr != 0)) {
-				_B_ptr->apply (_z, x);
-				_A_ptr->apply (y, _z);
-			}
+			if ((_A_ptr != 0) && (_B_ptr != 0))
+				Protected::composeApply (y, *_A_ptr, *_B_ptr, x, ApplyInPlace<Blackbox1> ());
 
 			return y;
 		}
@@ -160,10 +219,8 @@ namespace LinBox
 		template <class OutVector, class InVector>
 		inline OutVector& applyTranspose (OutVector& y, const InVector& x) const
 		{
-			if ((_A_ptr != 0) && (_B_ptr != 0)) {
-				_A_ptr->applyTranspose (_z, x);
-				_B_ptr->applyTranspose (y, _z);
-			}
+			if ((_A_ptr != 0) && (_B_ptr != 0))
+				Protected::composeApplyTranspose (y, *_A_ptr, *_B_ptr, x, ApplyInPlace<Blackbox2> ());
 
 			return y;
 		}
@@ -234,9 +291,6 @@ namespace LinBox
 		// Pointers to A and B matrices
 		const Blackbox1 *_A_ptr;
 		const Blackbox2 *_B_ptr;
-
-		// local intermediate vector
-		mutable BlasVector<Field> _z;
 	};
 
 	/// specialization for _Blackbox1 = _Blackbox2
@@ -257,18 +311,11 @@ namespace LinBox
 		Compose (const Blackbox& A, const Blackbox& B) {
 			_BlackboxL.push_back(&A);
 			_BlackboxL.push_back(&B);
-
-			_zl.clear();
-            _zl.emplace_back(B.field(), B.rowdim());
-
 		}
 
 		Compose (const Blackbox* Ap, const Blackbox* Bp) {
 			_BlackboxL.push_back(Ap);
 			_BlackboxL.push_back(Bp);
-
-			_zl.clear();
-            _zl.emplace_back(Bp->field(), Bp->rowdim());
 		}
 
 		/** Constructor of C := prod Ai from blackbox matrices Ai.
@@ -280,36 +327,38 @@ namespace LinBox
 		{
 
 			linbox_check(v.size() > 0);
-			_zl.clear();
-			// it would be good to use just 2 vectors and flip/flop.
-			for (const auto& b_p : _BlackboxL)
-                _zl.emplace_back( b_p.field(), b_p.coldim());
 		}
 
 		~Compose () {}
 
+		/** Application of BlackBox matrix.
+		 * <code>y= (A*B)*x</code>.
+		 * The factors are applied from the last one, flip-flopping between
+		 * two \ref ScratchVector.
+		 * @return reference to vector y containing output.
+		 * @param  x constant reference to vector to contain input
+		 * \param y result
+		 */
 		template <class OutVector, class InVector>
 		inline OutVector& apply (OutVector& y, const InVector& x) const
 		{
-
-			typename std::vector<const Blackbox*>::const_reverse_iterator b_p;
-			typename std::vector<DenseVector<Field> >::reverse_iterator z_p, pz_p;
-			b_p = _BlackboxL.rbegin();
-			pz_p = z_p = _zl.rbegin();
-			typedef DenseSubvector<Field> BSub;
-			BSub pz_p_vec(*pz_p);
-
-			(*b_p) -> apply(pz_p_vec, x);
-			++ b_p;  ++ z_p;
-
-			for (; z_p != _zl.rend(); ++ b_p, ++ z_p, ++ pz_p) {
-				 BSub z_p_vec(*z_p);
-				(*b_p) -> apply (z_p_vec,pz_p_vec);
+			typedef DenseVector<Field> Vector;
+			const size_t k = _BlackboxL.size();
+			if (k == 1)
+				return _BlackboxL[0] -> apply (y, x);
+
+			ScratchVector<Field, Vector> z1 (field(), _BlackboxL[k-1] -> rowdim());
+			ScratchVector<Field, Vector> z2 (field(), 0);
+			Vector *z = &*z1, *nz = &*z2;
+
+			_BlackboxL[k-1] -> apply (*z, x);
+			for (size_t i = k-2; i > 0; --i) {
+				nz -> resize (_BlackboxL[i] -> rowdim());
+				_BlackboxL[i] -> apply (*nz, *z);
+				std::swap (z, nz);
 			}
 
-			(*b_p) -> apply(y, pz_p_vec);
-
-			return y;
+			return _BlackboxL[0] -> apply (y, *z);
 		}
 
 		/*! Application of BlackBox matrix transpose.
@@ -324,22 +373,23 @@ namespace LinBox
 		template <class OutVector, class InVector>
 		inline OutVector& applyTranspose (OutVector& y, const InVector& x) const
 		{
-			typename std::vector<const Blackbox*>::reverse_iterator b_p;
-			typename std::vector<std::vector<Element> >::reverse_iterator z_p, nz_p;
-
-			b_p = _BlackboxL.rbegin();
-			z_p = nz_p = _zl.rbegin();
-
-			(*b_p) -> applyTranspose (*z_p, x);
-
-			++ b_p; ++ nz_p;
-
-			for (; nz_p != _zl.rend(); ++ z_p, ++ nz_p, ++ b_p)
-				(*b_p) -> applyTranspose (*nz_p, *z_p);
-
-			(*b_p) -> applyTranspose (y, *z_p);
+			typedef DenseVector<Field> Vector;
+			const size_t k = _BlackboxL.size();
+			if (k == 1)
+				return _BlackboxL[0] -> applyTranspose (y, x);
+
+			ScratchVector<Field, Vector> z1 (field(), _BlackboxL[0] -> coldim());
+			ScratchVector<Field, Vector> z2 (field(), 0);
+			Vector *z = &*z1, *nz = &*z2;
+
+			_BlackboxL[0] -> applyTranspose (*z, x);
+			for (size_t i = 1; i < k-1; ++i) {
+				nz -> resize (_BlackboxL[i] -> coldim());
+				_BlackboxL[i] -> applyTranspose (*nz, *z);
+				std::swap (z, nz);
+			}
 
-			return y;
+			return _BlackboxL[k-1] -> applyTranspose (y, *z);
 		}
 
 		template<typename _Tp1>
@@ -393,9 +443,6 @@ namespace LinBox
 
 		// Pointers to A and B matrices
 		std::vector<const Blackbox*> _BlackboxL;
-
-		// local intermediate vector
-		mutable std::vector<DenseVector<Field> > _zl;
 	};
 
 	//@}
@@ -466,14 +513,7 @@ namespace LinBox
 		 */
 		ComposeOwner (const Blackbox1 &A, const Blackbox2 &B) :
 			_A_data(A), _B_data(B)
-			,_z(A.field())
-		{
-			// Rich Seagraves - "It seems VectorWrapper somehow
-			// became depricated.  Makes the assumption that
-			// this vector type supports resize"
-			// VectorWrapper::ensureDim (_z, _A_data.coldim ());
-			_z.resize(_A_data.coldim());
-		}
+		{}
 
 		/** Constructor of C := (*A_data)*(*B_data).
 		 * This constructor creates a matrix that is a product of two black box
@@ -481,14 +521,10 @@ namespace LinBox
 		 */
 		ComposeOwner (const Blackbox1 *A_data, const Blackbox2 *B_data) :
 			_A_data(*A_data), _B_data(*B_data)
-			,_z(A_data->field())
 		{
 			linbox_check (A_data != (Blackbox1 *) 0);
 			linbox_check (B_data != (Blackbox2 *) 0);
 			linbox_check (A_data->coldim () == B_data->rowdim ());
-
-			// VectorWrapper::ensureDim (_z, _A_data.coldim ());
-			_z.resize(_A_data.coldim());
 		}
 
 		/** Copy constructor.
@@ -498,10 +534,7 @@ namespace LinBox
 		 */
 		ComposeOwner (const ComposeOwner<Blackbox1, Blackbox2>& Mat) :
 			_A_data ( Mat.getLeftData()), _B_data ( Mat.getRightData())
-			,_z(Mat.field())
-		{
-			_z.resize(_A_data.coldim());
-		}
+		{}
 
 
 		/// Destructor
@@ -530,7 +563,7 @@ namespace LinBox
 		template <class OutVector, class InVector>
 		inline OutVector& apply (OutVector& y, const InVector& x) const
 		{
-			return _A_data.apply (y, _B_data.apply (_z, x));
+			return Protected::composeApply (y, _A_data, _B_data, x, ApplyInPlace<Blackbox1> ());
 		}
 
 		/** row vector * matrix product \f$y= (A \times B)^T \cdot x\f$.
@@ -542,7 +575,7 @@ namespace LinBox
 		template <class OutVector, class InVector>
 		inline OutVector& applyTranspose (OutVector& y, const InVector& x) const
 		{
-			return _B_data.applyTranspose (y, _A_data.applyTranspose (_z, x));
+			return Protected::composeApplyTranspose (y, _A_data, _B_data, x, ApplyInPlace<Blackbox2> ());
 		}
 
 		template<typename _Tp1, typename _Tp2 = _Tp1>
@@ -563,8 +596,7 @@ namespace LinBox
 		template<typename _BBt1, typename _BBt2, typename Field>
 		ComposeOwner (const Compose<_BBt1, _BBt2> &Mat, const Field& F) :
 			_A_data(*(Mat.getLeftPtr()), F),
-			_B_data(*(Mat.getRightPtr()), F),
-			_z(F,_A_data.coldim())
+			_B_data(*(Mat.getRightPtr()), F)
 		{
 			typename Compose<_BBt1, _BBt2>::template rebind<Field>()(*this,Mat);
 		}
@@ -572,8 +604,7 @@ namespace LinBox
 		template<typename _BBt1, typename _BBt2, typename Field>
 		ComposeOwner (const ComposeOwner<_BBt1, _BBt2> &Mat, const Field& F) :
 			_A_data(Mat.getLeftData(), F),
-			_B_data(Mat.getRightData(), F) ,
-			_z(F,_A_data.coldim())
+			_B_data(Mat.getRightData(), F)
 		{
 			typename ComposeOwner<_BBt1, _BBt2>::template rebind<Field>()(*this,Mat);
 		}
@@ -618,9 +649,6 @@ namespace LinBox
 		// A and B matrices
 		Blackbox1 _A_data;
 		Blackbox2 _B_data;
-
-		// local intermediate vector
-		mutable BlasVector<Field> _z;
 	};
 
 } // LinBox
@@ -30,6 +30,7 @@
 #define __LINBOX_sum_H
 
 #include "linbox/vector/vector-domain.h"
+#include "linbox/vector/scratch-vector.h"
 #include "linbox/util/debug.h"
 #include "linbox/blackbox/blackbox-interface.h"
 
@@ -76,9 +77,6 @@ namespace LinBox
 		{
 			linbox_check (A.coldim () == B.coldim ());
 			linbox_check (A.rowdim () == B.rowdim ());
-
-			VectorWrapper::ensureDim (_z1, A.rowdim ());
-			VectorWrapper::ensureDim (_z2, A.coldim ());
 		}
 
 		/** Constructor from black box pointers.
@@ -94,9 +92,6 @@ namespace LinBox
 			linbox_check (B_ptr != 0);
 			linbox_check (A_ptr->coldim () == B_ptr->coldim ());
 			linbox_check (A_ptr->rowdim () == B_ptr->rowdim ());
-
-			VectorWrapper::ensureDim (_z1, A_ptr->rowdim ());
-			VectorWrapper::ensureDim (_z2, A_ptr->coldim ());
 		}
 
 		/** Copy constructor.
@@ -105,10 +100,7 @@ namespace LinBox
 		 */
 		Sum (const Sum<Blackbox1, Blackbox2> &M) :
 			_A_ptr (M._A_ptr), _B_ptr (M._B_ptr), VD(M.VD)
-		{
-			VectorWrapper::ensureDim (_z1, _A_ptr->rowdim ());
-			VectorWrapper::ensureDim (_z2, _A_ptr->coldim ());
-		}
+		{}
 
 		/// Destructor
 		~Sum (void)
@@ -127,9 +119,10 @@ namespace LinBox
 		template<class OutVector, class InVector>
 		inline OutVector &apply (OutVector &y, const InVector &x) const
 		{
+			ScratchVector<Field, std::vector<Element> > z (field(), rowdim ());
 			_A_ptr->apply (y, x);
-			_B_ptr->apply (_z1, x);
-			VD.addin (y, _z1);
+			_B_ptr->apply (*z, x);
+			VD.addin (y, *z);
 
 			return y;
 		}
@@ -146,9 +139,10 @@ namespace LinBox
 		template<class OutVector, class InVector>
 		inline OutVector &applyTranspose (OutVector &y, const InVector &x) const
 		{
+			ScratchVector<Field, std::vector<Element> > z (field(), coldim ());
 			_A_ptr->applyTranspose (y, x);
-			_B_ptr->applyTranspose (_z2, x);
-			VD.addin (y, _z2);
+			_B_ptr->applyTranspose (*z, x);
+			VD.addin (y, *z);
 
 			return y;
 		}
@@ -201,9 +195,6 @@ namespace LinBox
 		const Blackbox1       *_A_ptr;
 		const Blackbox2       *_B_ptr;
 
-		mutable std::vector<Element>  _z1;
-		mutable std::vector<Element>  _z2;
-
 		VectorDomain<Field> VD;
 	}; // template <Field, Vector> class Sum
 
@@ -241,9 +232,6 @@ namespace LinBox
 		{
 			linbox_check (A.coldim () == B.coldim ());
 			linbox_check (A.rowdim () == B.rowdim ());
-
-			VectorWrapper::ensureDim (_z1, A.rowdim ());
-			VectorWrapper::ensureDim (_z2, A.coldim ());
 		}
 
 		/** Constructor from black box pointers.
@@ -259,9 +247,6 @@ namespace LinBox
 			linbox_check (B_data != 0);
 			linbox_check (A_data->coldim () == B_data->coldim ());
 			linbox_check (A_data->rowdim () == B_data->rowdim ());
-
-			VectorWrapper::ensureDim (_z1, A_data->rowdim ());
-			VectorWrapper::ensureDim (_z2, A_data->coldim ());
 		}
 
 		/** Copy constructor.
@@ -270,10 +255,7 @@ namespace LinBox
 		 */
 		SumOwner (const SumOwner<Blackbox1, Blackbox2> &M) :
 			_A_data (M._A_data), _B_data (M._B_data), VD(M.VD)
-		{
-			VectorWrapper::ensureDim (_z1, _A_data.rowdim ());
-			VectorWrapper::ensureDim (_z2, _A_data.coldim ());
-		}
+		{}
 
 		/// Destructor
 		~SumOwner (void)
@@ -292,9 +274,10 @@ namespace LinBox
 		template<class OutVector, class InVector>
 		inline OutVector &apply (OutVector &y, const InVector &x) const
 		{
+			ScratchVector<Field, std::vector<Element> > z (field(), rowdim ());
 			_A_data.apply (y, x);
-			_B_data.apply (_z1, x);
-			VD.addin (y, _z1);
+			_B_data.apply (*z, x);
+			VD.addin (y, *z);
 			return y;
 		}
 
@@ -310,9 +293,10 @@ namespace LinBox
 		template<class OutVector, class InVector>
 		inline OutVector &applyTranspose (OutVector &y, const InVector &x) const
 		{
+			ScratchVector<Field, std::vector<Element> > z (field(), coldim ());
 			_A_data.applyTranspose (y, x);
-			_B_data.applyTranspose (_z2, x);
-			VD.addin (y, _z2);
+			_B_data.applyTranspose (*z, x);
+			VD.addin (y, *z);
 
 			return y;
 		}
@@ -333,8 +317,6 @@ namespace LinBox
 		SumOwner (const Sum<_BBt1, _BBt2> &M, const Field& F) :
 			_A_data(*(M.getLeftPtr()), F),
 			_B_data(*(M.getRightPtr()), F),
-			_z1(_A_data.rowdim()),
-			_z2(_A_data.coldim()),
 			VD(F)
 		{
 			typename Sum<_BBt1, _BBt2>::template rebind<Field>()(*this,M);
@@ -344,8 +326,6 @@ namespace LinBox
 		SumOwner (const SumOwner<_BBt1, _BBt2> &M, const Field& F) :
 			_A_data(M.getLeftData(), F),
 			_B_data(M.getRightData(), F) ,
-			_z1(_A_data.rowdim()),
-			_z2(_A_data.coldim()) ,
 			VD(F)
 		{
 			typename SumOwner<_BBt1, _BBt2>::template rebind<Field>()(*this,M);
@@ -410,9 +390,6 @@ namespace LinBox
 		Blackbox1       _A_data;
 		Blackbox2       _B_data;
 
-		mutable std::vector<Element>  _z1;
-		mutable std::vector<Element>  _z2;
-
 		VectorDomain<Field> VD;
 	}; // template <Field, Vector> class SumOwner
 
@@ -0,0 +1,280 @@
+/* linbox/matrix/densematrix/m4ri-matrix.h
+ * Copyright (C) 2013 the LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file matrix/densematrix/m4ri-matrix.h
+ * @ingroup densematrix
+ * A \c M4RIMatrix is a dense matrix over \c GF2, packed 64 entries per
+ * machine word.
+ *
+ * The products (M4RM) and the elimination (M4RI) on these matrices are in
+ * matrix/matrixdomain/matrix-domain-m4ri.h.
+ */
+
+#ifndef __LINBOX_matrix_densematrix_m4ri_matrix_H
+#define __LINBOX_matrix_densematrix_m4ri_matrix_H
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "linbox/linbox-config.h"
+#include "linbox/util/debug.h"
+#include "linbox/field/gf2.h"
+#include "linbox/matrix/matrix-traits.h"
+
+namespace LinBox
+{
+
+	/** Dense matrix over \c GF2, 64 entries per word.
+	 * @ingroup matrix
+	 *
+	 * Row \p i is the array of \c stride() words starting at \c row(i) ;
+	 * entry \f$(i,j)\f$ is the bit <code>j%64</code> of its word
+	 * <code>j/64</code>. The stride is padded to a multiple of \c pad
+	 * words, so that the row operations (XOR of whole rows) run on full
+	 * SIMD registers. The padding bits are kept to zero.
+	 */
+	class M4RIMatrix {
+	public:
+		typedef GF2               Field;
+		typedef bool            Element;
+		typedef uint64_t           Word;
+		typedef M4RIMatrix       Self_t;
+
+		static const size_t bits = 64 ; //!< entries per word
+		static const size_t pad  = 4 ;  //!< the stride is a multiple of \c pad words
+
+		M4RIMatrix (const GF2 & F) :
+			_field(&F), _row(0), _col(0), _stride(0)
+		{}
+
+		M4RIMatrix (const GF2 & F, size_t m, size_t n) :
+			_field(&F)
+		{
+			init(m, n);
+		}
+
+		/// copy of any matrix over \c GF2.
+		template<class Matrix>
+		explicit M4RIMatrix (const Matrix & A) :
+			_field(&A.field())
+		{
+			init(A.rowdim(), A.coldim());
+			copyFrom(A, typename IndexedCategory<Matrix>::Tag());
+		}
+
+		M4RIMatrix (const M4RIMatrix & A) :
+			_field(A._field), _row(A._row), _col(A._col), _stride(A._stride), _rep(A._rep)
+		{}
+
+		M4RIMatrix & operator= (const M4RIMatrix & A)
+		{
+			_field = A._field ;
+			_row = A._row ;
+			_col = A._col ;
+			_stride = A._stride ;
+			_rep = A._rep ;
+			return *this ;
+		}
+
+		/// \p m x \p n, zero.
+		void init (size_t m, size_t n)
+		{
+			_row = m ;
+			_col = n ;
+			_stride = (n+bits*pad-1)/(bits*pad)*pad ;
+			_rep.assign(_row*_stride, 0);
+		}
+
+		void resize (size_t m, size_t n) { init(m, n); }
+
+		size_t rowdim () const { return _row ; }
+		size_t coldim () const { return _col ; }
+		size_t stride () const { return _stride ; }
+		const Field & field () const { return *_field ; }
+
+		Word *       row (size_t i)       { return _rep.data()+i*_stride ; }
+		const Word * row (size_t i) const { return _rep.data()+i*_stride ; }
+
+		Element & getEntry (Element & x, size_t i, size_t j) const
+		{
+			return x = getEntry(i, j);
+		}
+
+		Element getEntry (size_t i, size_t j) const
+		{
+			linbox_check(i < _row && j < _col);
+			return (row(i)[j/bits] >> (j%bits)) & 1 ;
+		}
+
+		void setEntry (size_t i, size_t j, const Element & a)
+		{
+			linbox_check(i < _row && j < _col);
+			Word & w = row(i)[j/bits] ;
+			const Word b = (Word)1 << (j%bits) ;
+			if (a)
+				w |= b ;
+			else
+				w &= ~b ;
+		}
+
+		void zero () { std::fill(_rep.begin(), _rep.end(), (Word)0); }
+
+		void swapRows (size_t i, size_t k)
+		{
+			if (i != k)
+				std::swap_ranges(row(i), row(i)+_stride, row(k));
+		}
+
+		bool operator== (const M4RIMatrix & A) const
+		{
+			return _row == A._row && _col == A._col && _rep == A._rep ;
+		}
+
+		bool operator!= (const M4RIMatrix & A) const { return !(*this == A); }
+
+		/// y <- A x.
+		template<class OutVector, class InVector>
+		OutVector & apply (OutVector & y, const InVector & x) const
+		{
+			linbox_check(x.size() == _col && y.size() == _row);
+			std::vector<Word> xw(_stride, 0);
+			for (size_t j = 0 ; j < _col ; ++j)
+				if (x[j])
+					xw[j/bits] |= (Word)1 << (j%bits) ;
+			for (size_t i = 0 ; i < _row ; ++i) {
+				const Word * r = row(i) ;
+				Word acc = 0 ;
+				for (size_t k = 0 ; k < _stride ; ++k)
+					acc ^= r[k] & xw[k] ;
+				y[i] = parity(acc) ;
+			}
+			return y ;
+		}
+
+		/// y <- A^T x, the rows of A selected by x added up.
+		template<class OutVector, class InVector>
+		OutVector & applyTranspose (OutVector & y, const InVector & x) const
+		{
+			linbox_check(x.size() == _row && y.size() == _col);
+			std::vector<Word> yw(_stride, 0);
+			for (size_t i = 0 ; i < _row ; ++i)
+				if (x[i]) {
+					const Word * r = row(i) ;
+					for (size_t k = 0 ; k < _stride ; ++k)
+						yw[k] ^= r[k] ;
+				}
+			for (size_t j = 0 ; j < _col ; ++j)
+				y[j] = (yw[j/bits] >> (j%bits)) & 1 ;
+			return y ;
+		}
+
+		/// in the SMS format, which MatrixStream reads back.
+		std::ostream & write (std::ostream & os) const
+		{
+			os << _row << ' ' << _col << " M" << std::endl ;
+			for (size_t i = 0 ; i < _row ; ++i) {
+				const Word * r = row(i) ;
+				for (size_t k = 0 ; k < _stride ; ++k)
+					for (Word w = r[k] ; w ; w &= w-1)
+						os << i+1 << ' ' << k*bits+lowBit(w)+1 << " 1" << std::endl ;
+			}
+			return os << "0 0 0" << std::endl ;
+		}
+
+		/// parity of the number of bits of \p w.
+		static bool parity (Word w)
+		{
+			w ^= w >> 32 ;
+			w ^= w >> 16 ;
+			w ^= w >> 8 ;
+			w ^= w >> 4 ;
+			w ^= w >> 2 ;
+			w ^= w >> 1 ;
+			return w & 1 ;
+		}
+
+		/// index of the lowest bit set in \p w, which is not zero.
+		static size_t lowBit (Word w)
+		{
+			size_t l = 0 ;
+			if (!(w & 0xffffffff)) { w >>= 32 ; l += 32 ; }
+			if (!(w & 0xffff)) { w >>= 16 ; l += 16 ; }
+			if (!(w & 0xff)) { w >>= 8 ; l += 8 ; }
+			if (!(w & 0xf)) { w >>= 4 ; l += 4 ; }
+			if (!(w & 0x3)) { w >>= 2 ; l += 2 ; }
+			if (!(w & 0x1)) { l += 1 ; }
+			return l ;
+		}
+
+	private:
+
+		template<class Matrix>
+		void copyFrom (const Matrix & A, IndexedTags::HasNext)
+		{
+			size_t i, j ;
+			typename Matrix::Field::Element e ;
+			A.firstTriple();
+			while (A.nextTriple(i, j, e))
+				setEntry(i, j, !A.field().isZero(e));
+		}
+
+		template<class Matrix>
+		void copyFrom (const Matrix & A, IndexedTags::HasIndexed)
+		{
+			for (typename Matrix::ConstIndexedIterator it = A.IndexedBegin() ; it != A.IndexedEnd() ; ++it)
+				setEntry(it.rowIndex(), it.colIndex(), !A.field().isZero(it.value()));
+		}
+
+		template<class Matrix>
+		void copyFrom (const Matrix & A, IndexedTags::NoIndexed)
+		{
+			typename Matrix::Field::Element e ;
+			for (size_t i = 0 ; i < _row ; ++i)
+				for (size_t j = 0 ; j < _col ; ++j)
+					setEntry(i, j, !A.field().isZero(A.getEntry(e, i, j)));
+		}
+
+		const Field *     _field ;
+		size_t              _row ;
+		size_t              _col ;
+		size_t           _stride ;
+		std::vector<Word>   _rep ;
+	};
+
+	inline std::ostream& operator<< (std::ostream & os, const M4RIMatrix & A)
+	{
+		return A.write(os);
+	}
+
+} // LinBox
+
+#endif // __LINBOX_matrix_densematrix_m4ri_matrix_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
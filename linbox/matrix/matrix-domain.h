@@ -68,7 +68,7 @@ namespace LinBox {
 #include "linbox/matrix/matrixdomain/matrix-domain.h" // needed by BlasMatrix
 #include "linbox/matrix/matrixdomain/blas-matrix-domain.h"
 #include "linbox/matrix/matrixdomain/matrix-domain-gf2.h"
-// #include "matrixdomain/matrix-domain-m4ri.h"
+#include "linbox/matrix/matrixdomain/matrix-domain-m4ri.h"
 #include "linbox/matrix/matrixdomain/plain-domain.h"
 
 #include "linbox/matrix/matrixdomain/opencl-domain.h"
@@ -40,13 +40,14 @@
 
 #include "linbox/field/gf2.h"
 #include "linbox/matrix/matrix-domain.h"
+#include "linbox/matrix/matrixdomain/matrix-domain-m4ri.h"
 
 // Specialization of MatrixDomain for GF2
 namespace LinBox
 {
 	/*! Specialization of MatrixDomain for GF2.
 	 * @bug this is half done and makes MatrixDomain on GF2 hardly usable.
-	 * @todo this is where m4ri will play.
+	 * The products of word packed matrices (M4RIMatrix) go to M4RIDomain.
 	 */
 	template <>
 	class MatrixDomain<GF2> {
@@ -55,6 +56,24 @@ namespace LinBox
 			_VD (F)
 		{}
 
+		//! C <- A B, by M4RM.
+		M4RIMatrix &mul (M4RIMatrix &C, const M4RIMatrix &A, const M4RIMatrix &B) const
+		{
+			return M4RIDomain (_VD.field ()).mul (C, A, B);
+		}
+
+		//! C <- C + A B, by M4RM.
+		M4RIMatrix &axpyin (M4RIMatrix &C, const M4RIMatrix &A, const M4RIMatrix &B) const
+		{
+			return M4RIDomain (_VD.field ()).axpyin (C, A, B);
+		}
+
+		//! C <- C + A.
+		M4RIMatrix &addin (M4RIMatrix &C, const M4RIMatrix &A) const
+		{
+			return M4RIDomain (_VD.field ()).addin (C, A);
+		}
+
 		template <class Vector1, class Matrix, class Vector2>
 		Vector1 &vectorMul (Vector1 &w, const Matrix &A, const Vector2 &v) const
 		{
@@ -0,0 +1,413 @@
+/* linbox/matrix/matrixdomain/matrix-domain-m4ri.h
+ * Copyright (C) 2013 the LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file matrix/matrixdomain/matrix-domain-m4ri.h
+ * @ingroup matrixdomain
+ * @brief Products and elimination on the word packed \c GF2 matrices
+ * (M4RIMatrix), by the Method of the Four Russians.
+ *
+ * Both rely on the same idea : the \f$2^k\f$ sums of \f$k\f$ rows are
+ * tabulated once (one XOR of rows each), and a row which needs some of
+ * these \f$k\f$ rows gets their sum with a single XOR, found from its
+ * \f$k\f$ bits in the window. The row XORs are plain loops on words, which
+ * the compiler vectorizes.
+ */
+
+#ifndef __LINBOX_matrix_matrixdomain_matrix_domain_m4ri_H
+#define __LINBOX_matrix_matrixdomain_matrix_domain_m4ri_H
+
+#include <vector>
+#include <algorithm>
+
+#include "linbox/linbox-config.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/error.h"
+#include "linbox/field/gf2.h"
+#include "linbox/matrix/densematrix/m4ri-matrix.h"
+
+#ifndef LINBOX_M4RI_K
+/// bits of the window, the tables have 2^LINBOX_M4RI_K rows.
+#define LINBOX_M4RI_K 8
+#endif
+
+#ifndef LINBOX_M4RM_WORDS
+/// words of the column slices in M4RM, for the tables to stay in cache.
+#define LINBOX_M4RM_WORDS 32
+#endif
+
+namespace LinBox
+{
+
+	/** Domain of the M4RIMatrix.
+	 * @ingroup matrixdomain
+	 *
+	 * \c mul is M4RM (Arlazarov, Dinic, Kronrod, Faradzev) ; the
+	 * elimination is M4RI (Bard) : \c LINBOX_M4RI_K pivots are found at a
+	 * time, and all the other rows are reduced by them with one table
+	 * lookup and one row XOR.
+	 */
+	class M4RIDomain {
+	public:
+		typedef GF2                  Field;
+		typedef bool               Element;
+		typedef M4RIMatrix          Matrix;
+		typedef M4RIMatrix::Word      Word;
+
+		M4RIDomain (const GF2 & F) :
+			_field(&F)
+		{}
+
+		const Field & field () const { return *_field ; }
+
+		/// y <- y + x, on \p len words.
+		static void xorin (Word * y, const Word * x, size_t len)
+		{
+			for (size_t k = 0 ; k < len ; ++k)
+				y[k] ^= x[k] ;
+		}
+
+		/// C <- A + B.
+		Matrix & add (Matrix & C, const Matrix & A, const Matrix & B) const
+		{
+			C = A ;
+			return addin(C, B);
+		}
+
+		/// C <- C + A.
+		Matrix & addin (Matrix & C, const Matrix & A) const
+		{
+			linbox_check(C.rowdim() == A.rowdim() && C.coldim() == A.coldim());
+			for (size_t i = 0 ; i < C.rowdim() ; ++i)
+				xorin(C.row(i), A.row(i), C.stride());
+			return C ;
+		}
+
+		/// C <- A B.
+		Matrix & mul (Matrix & C, const Matrix & A, const Matrix & B) const
+		{
+			C.init(A.rowdim(), B.coldim());
+			return axpyin(C, A, B);
+		}
+
+		/// C <- C + A B, by M4RM.
+		Matrix & axpyin (Matrix & C, const Matrix & A, const Matrix & B) const
+		{
+			linbox_check(A.coldim() == B.rowdim());
+			linbox_check(C.rowdim() == A.rowdim() && C.coldim() == B.coldim());
+
+			const size_t m = A.rowdim() ;
+			const size_t l = A.coldim() ;
+			const size_t s = B.stride() ;
+			const size_t K = LINBOX_M4RI_K ;
+			std::vector<Word> T(((size_t)1<<K)*LINBOX_M4RM_WORDS);
+
+			// the table of the rows c..c+k-1 of B, on a slice of words,
+			// serves all the rows of A.
+			for (size_t w0 = 0 ; w0 < s ; w0 += LINBOX_M4RM_WORDS) {
+				const size_t len = std::min((size_t)LINBOX_M4RM_WORDS, s-w0) ;
+				for (size_t c = 0 ; c < l ; c += K) {
+					const size_t k = std::min(K, l-c) ;
+					makeTable(T.data(), len, B, c, k, w0);
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if (m*len > 4096)
+#endif
+					for (long i = 0 ; i < (long)m ; ++i) {
+						const size_t g = window(A.row((size_t)i), c, k) ;
+						if (g)
+							xorin(C.row((size_t)i)+w0, T.data()+g*len, len);
+					}
+				}
+			}
+			return C ;
+		}
+
+		/// rank of \p A.
+		size_t rank (const Matrix & A) const
+		{
+			Matrix B(A);
+			return rankInPlace(B);
+		}
+
+		/// rank of \p A, which is turned into a row echelon form.
+		size_t rankInPlace (Matrix & A) const
+		{
+			std::vector<size_t> P ;
+			return echelonize(A, P, false);
+		}
+
+		/// determinant of the square matrix \p A.
+		Element det (const Matrix & A) const
+		{
+			Matrix B(A);
+			return detInPlace(B);
+		}
+
+		/// determinant of the square matrix \p A, which is modified.
+		Element detInPlace (Matrix & A) const
+		{
+			if (A.rowdim() != A.coldim())
+				throw LinboxError("LinBox ERROR: matrix must be square for determinant computation\n");
+			return rankInPlace(A) == A.rowdim() ;
+		}
+
+		/** Row echelon form.
+		 * The first \p r rows of \p A become the basis of its row space,
+		 * row \p i starting with a one in the column \p P[i], increasing.
+		 * The last rows are zero.
+		 * @return the rank \p r.
+		 */
+		size_t rowEchelon (Matrix & A, std::vector<size_t> & P) const
+		{
+			return echelonize(A, P, false);
+		}
+
+		/** Reduced row echelon form.
+		 * The first \p r rows of \p A become the basis of its row space,
+		 * with a one in the column \p P[i] of row \p i, and zeros in the
+		 * columns \p P[j] of the other rows. The last rows are zero.
+		 * @return the rank \p r.
+		 */
+		size_t reducedRowEchelon (Matrix & A, std::vector<size_t> & P) const
+		{
+			return echelonize(A, P, true);
+		}
+
+		/** A solution \p x of \f$Ax=b\f$, its free variables set to zero.
+		 * @throws LinboxMathInconsistentSystem when there is none.
+		 */
+		template<class OutVector, class InVector>
+		OutVector & solve (OutVector & x, const Matrix & A, const InVector & b) const
+		{
+			linbox_check(x.size() == A.coldim() && b.size() == A.rowdim());
+			const size_t n = A.coldim() ;
+			Matrix Ab(field(), A.rowdim(), n+1);
+			for (size_t i = 0 ; i < A.rowdim() ; ++i) {
+				std::copy(A.row(i), A.row(i)+A.stride(), Ab.row(i));
+				Ab.setEntry(i, n, (bool)b[i]);
+			}
+			std::vector<size_t> P ;
+			const size_t r = echelonize(Ab, P, true);
+			if (r && P[r-1] == n)
+				throw LinboxMathInconsistentSystem("Linear system is inconsistent");
+			for (size_t j = 0 ; j < n ; ++j)
+				x[j] = false ;
+			for (size_t i = 0 ; i < r ; ++i)
+				x[P[i]] = Ab.getEntry(i, n);
+			return x ;
+		}
+
+		/** Basis of the right nullspace : \f$AK=0\f$.
+		 * \p K has \c A.coldim() rows, one column per vector.
+		 * @return the dimension of the nullspace.
+		 */
+		size_t nullspaceBasisRight (Matrix & K, const Matrix & A) const
+		{
+			Matrix R(A), L(field());
+			std::vector<size_t> P ;
+			const size_t r = echelonize(R, P, true);
+			kernelRows(L, R, P, r);
+			transpose(K, L);
+			return K.coldim() ;
+		}
+
+		/** Basis of the left nullspace : \f$KA=0\f$.
+		 * \p K has \c A.rowdim() columns, one row per vector.
+		 * @return the dimension of the nullspace.
+		 */
+		size_t nullspaceBasisLeft (Matrix & K, const Matrix & A) const
+		{
+			Matrix R(field());
+			transpose(R, A);
+			std::vector<size_t> P ;
+			const size_t r = echelonize(R, P, true);
+			kernelRows(K, R, P, r);
+			return K.rowdim() ;
+		}
+
+		/// T <- A^T.
+		Matrix & transpose (Matrix & T, const Matrix & A) const
+		{
+			T.init(A.coldim(), A.rowdim());
+			for (size_t i = 0 ; i < A.rowdim() ; ++i) {
+				const Word * r = A.row(i) ;
+				for (size_t k = 0 ; k < A.stride() ; ++k)
+					for (Word w = r[k] ; w ; w &= w-1)
+						T.setEntry(k*Matrix::bits+Matrix::lowBit(w), i, true);
+			}
+			return T ;
+		}
+
+		bool areEqual (const Matrix & A, const Matrix & B) const
+		{
+			return A == B ;
+		}
+
+		bool isZero (const Matrix & A) const
+		{
+			for (size_t i = 0 ; i < A.rowdim() ; ++i)
+				for (size_t k = 0 ; k < A.stride() ; ++k)
+					if (A.row(i)[k])
+						return false ;
+			return true ;
+		}
+
+	private:
+
+		/// the \p k bits of \p r from column \p c on, \p k < 64.
+		static size_t window (const Word * r, size_t c, size_t k)
+		{
+			const size_t q = c/Matrix::bits, o = c%Matrix::bits ;
+			Word w = r[q] >> o ;
+			if (o+k > Matrix::bits)
+				w |= r[q+1] << (Matrix::bits-o) ;
+			return (size_t)(w & (((Word)1<<k)-1)) ;
+		}
+
+		/// the sums of the rows c..c+k-1 of \p B, on \p len words from \p w0.
+		static void makeTable (Word * T, size_t len, const Matrix & B, size_t c, size_t k, size_t w0)
+		{
+			std::fill(T, T+len, (Word)0);
+			for (size_t g = 1 ; g < ((size_t)1<<k) ; ++g) {
+				const size_t h = g & (g-1) ;
+				const Word * b = B.row(c+Matrix::lowBit(g^h))+w0 ;
+				const Word * t = T+h*len ;
+				Word * u = T+g*len ;
+				for (size_t q = 0 ; q < len ; ++q)
+					u[q] = t[q] ^ b[q] ;
+			}
+		}
+
+		/** Gaussian elimination, \c LINBOX_M4RI_K columns at a time.
+		 * The pivots of a window are searched on the window bits only, the
+		 * candidate rows being reduced there by the pivots already found ;
+		 * the few pivot rows are then reduced against each other, and all
+		 * the other rows (those above too, if \p reduced) by a table of
+		 * their sums.
+		 */
+		size_t echelonize (Matrix & A, std::vector<size_t> & P, bool reduced) const
+		{
+			const size_t m = A.rowdim(), n = A.coldim(), s = A.stride() ;
+			P.clear();
+			std::vector<Word> T(((size_t)1<<LINBOX_M4RI_K)*s);
+			std::vector<size_t> idx((size_t)1<<LINBOX_M4RI_K);
+			size_t pc[LINBOX_M4RI_K], pw[LINBOX_M4RI_K] ;
+			size_t r = 0 ;
+			for (size_t c = 0 ; c < n && r < m ; ) {
+				// no point in a table larger than the rows it reduces
+				size_t k = std::min((size_t)LINBOX_M4RI_K, n-c) ;
+				const size_t todo = (reduced ? m : m-r) ;
+				while (k > 1 && ((size_t)1<<k) > todo)
+					--k ;
+
+				size_t np = 0 ;
+				for (size_t t = 0 ; t < k && r+np < m ; ++t) {
+					size_t i = r+np ;
+					for ( ; i < m ; ++i) {
+						size_t w = window(A.row(i), c, k) ;
+						for (size_t p = 0 ; p < np ; ++p)
+							if ((w >> pc[p]) & 1)
+								w ^= pw[p] ;
+						if ((w >> t) & 1)
+							break ;
+					}
+					if (i == m)
+						continue ;
+					Word * u = A.row(i) ;
+					const size_t w0 = c/Matrix::bits ;
+					for (size_t p = 0 ; p < np ; ++p)
+						if ((window(u, c, k) >> pc[p]) & 1)
+							xorin(u+w0, A.row(r+p)+w0, s-w0);
+					A.swapRows(i, r+np);
+					u = A.row(r+np) ;
+					for (size_t p = 0 ; p < np ; ++p)
+						if ((window(A.row(r+p), c, k) >> t) & 1) {
+							xorin(A.row(r+p)+w0, u+w0, s-w0);
+							pw[p] = window(A.row(r+p), c, k) ;
+						}
+					pc[np] = t ;
+					pw[np] = window(u, c, k) ;
+					++np ;
+				}
+
+				if (np) {
+					const size_t w0 = c/Matrix::bits, len = s-w0 ;
+					makeTable(T.data(), len, A, r, np, w0);
+					for (size_t w = 0 ; w < ((size_t)1<<k) ; ++w) {
+						size_t g = 0 ;
+						for (size_t p = 0 ; p < np ; ++p)
+							g |= ((w >> pc[p]) & 1) << p ;
+						idx[w] = g ;
+					}
+					const long beg = (long)(reduced ? 0 : r+np) ;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static) if ((size_t)m*len > 4096)
+#endif
+					for (long i = beg ; i < (long)m ; ++i) {
+						if ((size_t)i >= r && (size_t)i < r+np)
+							continue ;
+						const size_t g = idx[window(A.row((size_t)i), c, k)] ;
+						if (g)
+							xorin(A.row((size_t)i)+w0, T.data()+g*len, len);
+					}
+					for (size_t p = 0 ; p < np ; ++p)
+						P.push_back(c+pc[p]);
+					r += np ;
+				}
+				c += k ;
+			}
+			return r ;
+		}
+
+		/// one kernel vector per non pivot column of the reduced echelon form \p R.
+		void kernelRows (Matrix & K, const Matrix & R, const std::vector<size_t> & P, size_t r) const
+		{
+			const size_t n = R.coldim() ;
+			K.init(n-r, n);
+			std::vector<bool> piv(n, false);
+			for (size_t i = 0 ; i < r ; ++i)
+				piv[P[i]] = true ;
+			size_t l = 0 ;
+			for (size_t j = 0 ; j < n ; ++j) {
+				if (piv[j])
+					continue ;
+				K.setEntry(l, j, true);
+				for (size_t i = 0 ; i < r ; ++i)
+					if (R.getEntry(i, j))
+						K.setEntry(l, P[i], true);
+				++l ;
+			}
+		}
+
+		const Field * _field ;
+	};
+
+} // LinBox
+
+#endif // __LINBOX_matrix_matrixdomain_matrix_domain_m4ri_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -51,6 +51,7 @@ namespace LinBox {
 		class CSR         : public ANY {} ; //!< compressed row
 		// template<typename Row_t>
 		class CSR1        : public ANY {} ; //!< implicit value CSR (with only ones, or mones, or..)
+		class CSR16       : public ANY {} ; //!< CSR with 16 bits column offsets
 		// template<typename Row_t>
 		class ELL         : public ANY {} ; //!< ellpack
 		// template<typename Row_t>
@@ -64,6 +65,8 @@ namespace LinBox {
 		class TPL_omp     : public ANY {} ; //!< triplesbb for openmp
 		class LIL         : public ANY {} ; //!< vector of pairs
 		class SMM         : public ANY {} ; //!< Sparse Map of Maps
+		class Auto        : public ANY {} ; //!< chosen by finalize() among the above
+		class MMAP        : public ANY {} ; //!< CSR in a memory mapped file
 
 		// the old sparse matrix reps.
 		// class VVP : public ANY {} ; // vector of vector of pairs
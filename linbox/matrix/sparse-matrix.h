@@ -72,12 +72,16 @@ namespace LinBox {
 #include "linbox/matrix/sparsematrix/sparse-coo-matrix.h"
 // #include "linbox/matrix/sparsematrix/sparse-coo-1-matrix.h"
 #include "linbox/matrix/sparsematrix/sparse-csr-matrix.h"
+#include "linbox/matrix/sparsematrix/sparse-csr16-matrix.h"
 // #include "linbox/matrix/sparsematrix/sparse-csr-1-matrix.h"
 #include "linbox/matrix/sparsematrix/sparse-ell-matrix.h"
 #include "linbox/matrix/sparsematrix/sparse-ellr-matrix.h"
 // #include "linbox/matrix/sparsematrix/sparse-ellr-1-matrix.h"
-// #include "linbox/matrix/sparsematrix/sparse-bcsr-matrix.h"
-// #include "linbox/matrix/sparsematrix/sparse-dia-matrix.h"
+#include "linbox/matrix/sparsematrix/sparse-bcsr-matrix.h"
+#include "linbox/matrix/sparsematrix/sparse-dia-matrix.h"
+#include "linbox/matrix/sparsematrix/sparse-lil-matrix.h"
+#include "linbox/matrix/sparsematrix/sparse-auto-matrix.h"
+#include "linbox/matrix/sparsematrix/sparse-mmap-matrix.h"
 // #include "linbox/matrix/sparsematrix/sparse-hyb-matrix.h"
 #include "linbox/matrix/sparsematrix/sparse-map-map-matrix.h"
 
@@ -200,6 +204,11 @@ namespace LinBox { /*  IndexedCategory */
 		typedef IndexedTags::HasNext Tag;
 	};
 
+	template<class Field>
+	struct IndexedCategory< SparseMatrix<Field,SparseMatrixFormat::CSR16> > 	{
+		typedef IndexedTags::HasNext Tag;
+	};
+
 	template<class Field>
 	struct IndexedCategory< SparseMatrix<Field,SparseMatrixFormat::COO> > 	{
 		typedef IndexedTags::HasNext Tag;
@@ -215,6 +224,31 @@ namespace LinBox { /*  IndexedCategory */
 		typedef IndexedTags::HasNext Tag;
 	};
 
+	template<class Field>
+	struct IndexedCategory< SparseMatrix<Field,SparseMatrixFormat::DIA> > 	{
+		typedef IndexedTags::HasNext Tag;
+	};
+
+	template<class Field>
+	struct IndexedCategory< SparseMatrix<Field,SparseMatrixFormat::BCSR> > 	{
+		typedef IndexedTags::HasNext Tag;
+	};
+
+	template<class Field>
+	struct IndexedCategory< SparseMatrix<Field,SparseMatrixFormat::LIL> > 	{
+		typedef IndexedTags::HasNext Tag;
+	};
+
+	template<class Field>
+	struct IndexedCategory< SparseMatrix<Field,SparseMatrixFormat::Auto> > 	{
+		typedef IndexedTags::HasNext Tag;
+	};
+
+	template<class Field>
+	struct IndexedCategory< SparseMatrix<Field,SparseMatrixFormat::MMAP> > 	{
+		typedef IndexedTags::HasNext Tag;
+	};
+
 #endif
 
 
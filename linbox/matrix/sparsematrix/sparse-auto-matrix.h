@@ -0,0 +1,637 @@
+/* linbox/matrix/sparsematrix/sparse-auto-matrix.h
+ * Copyright (C) 2013 the LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file matrix/sparsematrix/sparse-auto-matrix.h
+ * @ingroup sparsematrix
+ * @brief
+ * A <code>SparseMatrix<_Field, SparseMatrixFormat::Auto ></code>
+ * is built as a LIL matrix and converted by finalize() to the layout
+ * that suits its structure best : CSR, ELL_R, DIA or BCSR.
+ *
+ * The choice is made on the shape of the matrix (row lengths, number of
+ * diagonals, filling of small blocks), or by timing a few applies with
+ * tune().
+ */
+
+
+#ifndef __LINBOX_matrix_sparsematrix_sparse_auto_matrix_H
+#define __LINBOX_matrix_sparsematrix_sparse_auto_matrix_H
+
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <memory>
+
+#include "linbox/linbox-config.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/timer.h"
+#include "linbox/field/hom.h"
+#include "linbox/matrix/matrix-domain.h"
+#include "linbox/blackbox/blockbb.h"
+#include "sparse-domain.h"
+#include "sparse-csr-matrix.h"
+#include "sparse-ellr-matrix.h"
+#include "sparse-dia-matrix.h"
+#include "sparse-bcsr-matrix.h"
+#include "sparse-lil-matrix.h"
+
+#ifndef LINBOX_SPARSE_AUTO_TRIALS
+#define LINBOX_SPARSE_AUTO_TRIALS 3 //!< number of timed applies per layout in tune()
+#endif
+
+namespace LinBox
+{
+
+	/** Sparse matrix choosing its own storage.
+	 *
+	 * Entries are set in a LIL matrix. finalize() inspects it and converts
+	 * it to one of :
+	 * - DIA when the nonzeros lie on few, mostly full, diagonals ;
+	 * - BCSR when they fill small square blocks (2, 3, 4 or 6) ;
+	 * - ELL_R when the rows all have about the same length ;
+	 * - CSR otherwise.
+	 *
+	 * tune() times the plausible layouts instead and keeps the fastest.
+	 * Modifying the matrix after that brings it back to LIL until the
+	 * next finalize().
+	 *
+	 * \ingroup matrix
+	 * \ingroup sparse
+	 */
+	template<class _Field>
+	class SparseMatrix<_Field, SparseMatrixFormat::Auto > {
+	public :
+		typedef _Field                             Field ; //!< Field
+		typedef typename _Field::Element         Element ; //!< Element
+		typedef SparseMatrixFormat::Auto         Storage ; //!< Matrix Storage Format
+		typedef SparseMatrix<_Field,Storage>      Self_t ; //!< Self type
+
+		typedef SparseMatrix<_Field,SparseMatrixFormat::LIL>   LIL_t ;
+		typedef SparseMatrix<_Field,SparseMatrixFormat::CSR>   CSR_t ;
+		typedef SparseMatrix<_Field,SparseMatrixFormat::ELL_R> ELL_R_t ;
+		typedef SparseMatrix<_Field,SparseMatrixFormat::DIA>   DIA_t ;
+		typedef SparseMatrix<_Field,SparseMatrixFormat::BCSR>  BCSR_t ;
+
+		//! Storage in use.
+		enum Layout { LIL, CSR, ELL_R, DIA, BCSR } ;
+
+		//! What finalize() looks at.
+		struct Profile {
+			size_t nbnz ;      //!< nonzero entries
+			size_t maxrow ;    //!< largest row
+			size_t diagonals ; //!< diagonals holding a nonzero
+			size_t block ;     //!< best square block size for BCSR
+			double fill ;      //!< proportion of nonzeros in the blocks of that size
+		} ;
+
+		/*! Constructors.
+		 */
+		//@{
+		SparseMatrix<_Field, SparseMatrixFormat::Auto> (const _Field & F, size_t m = 0, size_t n = 0) :
+			_rownb(m),_colnb(n)
+			,_layout(LIL)
+			,_lil(new LIL_t(F,m,n))
+			,_field(F)
+		{}
+
+		SparseMatrix<_Field, SparseMatrixFormat::Auto> (const SparseMatrix<_Field, SparseMatrixFormat::Auto> & S) :
+			_rownb(S._rownb),_colnb(S._colnb)
+			,_layout(LIL)
+			,_lil(new LIL_t(S._field,S._rownb,S._colnb))
+			,_field(S._field)
+		{
+			copyTriples(*_lil,S);
+			if (S._layout != LIL)
+				select(S._layout, S._layout == BCSR ? S._bcsr->blockRowdim() : 0);
+		}
+
+		SparseMatrix<_Field, SparseMatrixFormat::Auto> ( MatrixStream<Field>& ms ):
+			_rownb(0),_colnb(0)
+			,_layout(LIL)
+			,_lil(new LIL_t(ms.field()))
+			,_field(ms.field())
+		{
+			size_t m, n ;
+			if( !ms.getDimensions( m, n ) )
+				throw ms.reportError(__func__,__LINE__);
+			resize(m,n);
+			Element val;
+			size_t i, j;
+			while( ms.nextTriple(i,j,val) )
+				appendEntry(i,j,val);
+			if( ms.getError() > END_OF_MATRIX )
+				throw ms.reportError(__func__,__LINE__);
+			finalize();
+		}
+
+		template<typename _Tp1, typename _Rw1 = SparseMatrixFormat::Auto>
+		struct rebind {
+			typedef SparseMatrix<_Tp1, _Rw1> other;
+
+			void operator() (other & Ap, const Self_t& A)
+			{
+				typename _Tp1::Element e;
+				Hom<typename Self_t::Field, _Tp1> hom(A.field(), Ap.field());
+				Ap.resize(A.rowdim(), A.coldim());
+				size_t i, j ;
+				Element f ;
+				A.firstTriple();
+				while ( A.nextTriple(i,j,f) ) {
+					hom. image ( e, f );
+					if (! Ap.field().isZero(e) )
+						Ap.appendEntry(i,j,e);
+				}
+				A.firstTriple();
+				Ap.finalize();
+			}
+		};
+
+		template<typename _Tp1, typename _Rw1>
+		SparseMatrix (const SparseMatrix<_Tp1, _Rw1> &S, const Field& F) :
+			_rownb(S.rowdim()),_colnb(S.coldim())
+			,_layout(LIL)
+			,_lil(new LIL_t(F,S.rowdim(),S.coldim()))
+			,_field(F)
+		{
+			typename SparseMatrix<_Tp1,_Rw1>::template rebind<Field,Storage>()(*this, S);
+		}
+		//@}
+
+		void resize(const size_t & mm, const size_t & nn, const size_t & = 0)
+		{
+			reopen();
+			_rownb = mm ;
+			_colnb = nn ;
+			_lil->resize(mm,nn);
+		}
+
+		size_t rowdim() const
+		{
+			return _rownb ;
+		}
+
+		size_t coldim() const
+		{
+			return _colnb ;
+		}
+
+		/// number of non zero entries.
+		size_t size() const
+		{
+			SizeOp op ;
+			visit(op);
+			return op.nbnz ;
+		}
+
+		const Field & field()  const
+		{
+			return _field ;
+		}
+
+		/// storage in use.
+		Layout layout() const
+		{
+			return _layout ;
+		}
+
+		/// Set an individual entry, the matrix goes back to LIL.
+		const Element& setEntry(const size_t &i, const size_t &j, const Element& e)
+		{
+			reopen();
+			return _lil->setEntry(i,j,e);
+		}
+
+		void appendEntry(const size_t &i, const size_t &j, const Element& e)
+		{
+			reopen();
+			_lil->appendEntry(i,j,e);
+		}
+
+		void clearEntry(const size_t &i, const size_t &j)
+		{
+			setEntry(i,j,field().zero);
+		}
+
+		/// converts the matrix to the layout suiting its profile.
+		void finalize()
+		{
+			if (_layout != LIL)
+				return ;
+			Profile P = profile();
+			select(choose(P), P.block);
+		}
+
+		/** converts the matrix to the layout with the fastest apply.
+		 * Each plausible layout is built and timed on \p trials applies.
+		 */
+		void tune(size_t trials = LINBOX_SPARSE_AUTO_TRIALS)
+		{
+			reopen();
+			Profile P = profile();
+			const size_t z = std::max(P.nbnz,(size_t)1);
+			std::vector<Element> x(_colnb, field().one), y(_rownb, field().zero);
+
+			Layout best = CSR ;
+			double besttime = -1 ;
+			const Layout candidates[] = { CSR, ELL_R, DIA, BCSR } ;
+			for (size_t c = 0 ; c < 4 ; ++c) {
+				const Layout l = candidates[c] ;
+				// leave out the layouts that would blow the memory up.
+				if (l == ELL_R && _rownb*P.maxrow > 4*z) continue ;
+				if (l == DIA && P.diagonals*std::min(_rownb,_colnb) > 4*z) continue ;
+				if (l == BCSR && P.fill < 0.25) continue ;
+
+				build(l,P.block);
+				ApplyOp<std::vector<Element>, std::vector<Element> > op(y,x);
+				Layout keep = _layout ;
+				_layout = l ;
+				visit(op); // warm up
+				Timer chrono ;
+				chrono.clear();
+				chrono.start();
+				for (size_t t = 0 ; t < trials ; ++t)
+					visit(op);
+				chrono.stop();
+				_layout = keep ;
+				if (besttime < 0 || chrono.realtime() < besttime) {
+					besttime = chrono.realtime();
+					if (c) release(best);
+					best = l ;
+				}
+				else
+					release(l);
+			}
+			_layout = best ;
+			_lil.reset();
+		}
+
+		/** converts the matrix to the layout \p l.
+		 * @param block block size for BCSR, 0 for the best one.
+		 */
+		void select(Layout l, size_t block = 0)
+		{
+			reopen();
+			if (l == LIL)
+				return ;
+			if (l == BCSR && block == 0)
+				block = profile().block ;
+			build(l,block);
+			_layout = l ;
+			_lil.reset();
+		}
+
+		/// shape of the matrix.
+		Profile profile() const
+		{
+			LIL_t * A = _lil.get() ;
+			std::unique_ptr<LIL_t> tmp ;
+			if (_layout != LIL) {
+				tmp.reset(new LIL_t(field(),_rownb,_colnb));
+				copyTriples(*tmp,*this);
+				A = tmp.get();
+			}
+
+			Profile P ;
+			P.nbnz = A->size();
+			P.maxrow = 0 ;
+			std::vector<bool> diag(_rownb+_colnb,false);
+			P.diagonals = 0 ;
+			for (size_t i = 0 ; i < _rownb ; ++i) {
+				const typename LIL_t::Row & row = A->getRow(i);
+				P.maxrow = std::max(P.maxrow,row.size());
+				for (size_t k = 0 ; k < row.size() ; ++k) {
+					const size_t d = row[k].first + _rownb - i ;
+					if (!diag[d]) {
+						diag[d] = true ;
+						++P.diagonals ;
+					}
+				}
+			}
+
+			P.block = 0 ;
+			P.fill = 0 ;
+			const size_t sizes[] = { 2, 3, 4, 6 } ;
+			std::vector<size_t> cols ;
+			for (size_t s = 0 ; s < 4 ; ++s) {
+				const size_t b = sizes[s] ;
+				size_t blocks = 0 ;
+				for (size_t I = 0 ; I < _rownb ; I += b) {
+					cols.clear();
+					for (size_t i = I ; i < std::min(I+b,_rownb) ; ++i)
+						for (size_t k = 0 ; k < A->getRow(i).size() ; ++k)
+							cols.push_back(A->getRow(i)[k].first / b);
+					std::sort(cols.begin(),cols.end());
+					blocks += std::unique(cols.begin(),cols.end()) - cols.begin() ;
+				}
+				const double fill = blocks ? (double)P.nbnz/(double)(blocks*b*b) : 0 ;
+				if (fill > P.fill) {
+					P.fill = fill ;
+					P.block = b ;
+				}
+			}
+			return P ;
+		}
+
+		/// the layout finalize() chooses for a matrix of profile \p P.
+		Layout choose(const Profile & P) const
+		{
+			const double z = (double)P.nbnz ;
+			if (P.nbnz == 0)
+				return CSR ;
+			if ((double)(P.diagonals*std::min(_rownb,_colnb)) <= 1.5*z)
+				return DIA ;
+			if (P.fill >= 0.7)
+				return BCSR ;
+			if ((double)(_rownb*P.maxrow) <= 1.2*z)
+				return ELL_R ;
+			return CSR ;
+		}
+
+		const Element & getEntry(const size_t &i, const size_t &j) const
+		{
+			GetEntryOp op(i,j);
+			visit(op);
+			return *op.e ;
+		}
+
+		Element      &getEntry (Element &x, size_t i, size_t j) const
+		{
+			return x = getEntry (i, j);
+		}
+
+		void firstTriple() const
+		{
+			FirstTripleOp op ;
+			visit(op);
+		}
+
+		bool nextTriple(size_t & i, size_t &j, Element &e) const
+		{
+			NextTripleOp op(i,j,e);
+			visit(op);
+			return op.more ;
+		}
+
+		/** Write a matrix to the given output stream using field read/write.
+		 * @param os Output stream to which to write the matrix
+		 * @param format Format with which to write
+		 */
+		std::ostream & write(std::ostream &os
+				     , Tag::FileFormat format  = Tag::FileFormat::MatrixMarket) const
+		{
+			return SparseMatrixWriteHelper<Self_t>::write(*this,os,format);
+		}
+
+		/** Read a matrix from the given input stream using field read/write
+		 * @param is Input stream from which to read the matrix
+		 * @param format Format of input matrix
+		 * @return ref to \p is.
+		 */
+		std::istream& read (std::istream &is
+				    , Tag::FileFormat format = Tag::FileFormat::Detect)
+		{
+			return SparseMatrixReadHelper<Self_t>::read(*this,is,format);
+		}
+
+		// y= Ax
+		template<class outVector, class inVector>
+		outVector& apply(outVector &y, const inVector& x ) const
+		{
+			ApplyOp<outVector,inVector> op(y,x);
+			visit(op);
+			return y;
+		}
+
+		// y= A^t x
+		template<class outVector, class inVector>
+		outVector& applyTranspose(outVector &y, const inVector& x ) const
+		{
+			ApplyTransposeOp<outVector,inVector> op(y,x);
+			visit(op);
+			return y;
+		}
+
+		/// Y <- A X.
+		template<class Mat1, class Mat2>
+		Mat1 & applyLeft(Mat1 &Y, const Mat2 &X) const
+		{
+			ApplyLeftOp<Mat1,Mat2> op(Y,X);
+			visit(op);
+			return Y;
+		}
+
+		/// Y <- X A.
+		template<class Mat1, class Mat2>
+		Mat1 & applyRight(Mat1 &Y, const Mat2 &X) const
+		{
+			ApplyRightOp<Mat1,Mat2> op(Y,X);
+			visit(op);
+			return Y;
+		}
+
+	private :
+		/// calls \p op on the matrix in use.
+		template<class Op>
+		void visit(Op & op) const
+		{
+			switch (_layout) {
+			case LIL   : op(*_lil);   break ;
+			case CSR   : op(*_csr);   break ;
+			case ELL_R : op(*_ellr);  break ;
+			case DIA   : op(*_dia);   break ;
+			case BCSR  : op(*_bcsr);  break ;
+			}
+		}
+
+		template<class Matrix>
+		static void copyTriples(LIL_t & L, const Matrix & A)
+		{
+			size_t i, j ;
+			Element e ;
+			A.firstTriple();
+			while (A.nextTriple(i,j,e))
+				L.appendEntry(i,j,e);
+			A.firstTriple();
+			L.finalize();
+		}
+
+		template<class Matrix>
+		void copyFromLIL(Matrix & A) const
+		{
+			for (size_t i = 0 ; i < _rownb ; ++i)
+				for (size_t k = 0 ; k < _lil->getRow(i).size() ; ++k)
+					A.appendEntry(i,_lil->getRow(i)[k].first,_lil->getRow(i)[k].second);
+			A.finalize();
+		}
+
+		/// builds layout \p l from the LIL matrix, which is kept.
+		void build(Layout l, size_t block)
+		{
+			switch (l) {
+			case LIL :
+				break ;
+			case CSR :
+				_csr.reset(new CSR_t(field(),_rownb,_colnb));
+				copyFromLIL(*_csr);
+				break ;
+			case ELL_R :
+				_ellr.reset(new ELL_R_t(field(),_rownb,_colnb));
+				copyFromLIL(*_ellr);
+				break ;
+			case DIA :
+				_dia.reset(new DIA_t(field(),_rownb,_colnb));
+				copyFromLIL(*_dia);
+				break ;
+			case BCSR :
+				if (block == 0) block = LINBOX_BCSR_BLOCK ;
+				_bcsr.reset(new BCSR_t(field(),_rownb,_colnb,block,block));
+				copyFromLIL(*_bcsr);
+				break ;
+			}
+		}
+
+		void release(Layout l)
+		{
+			switch (l) {
+			case LIL   : _lil.reset();  break ;
+			case CSR   : _csr.reset();  break ;
+			case ELL_R : _ellr.reset(); break ;
+			case DIA   : _dia.reset();  break ;
+			case BCSR  : _bcsr.reset(); break ;
+			}
+		}
+
+		/// brings the matrix back to LIL for modifications.
+		void reopen()
+		{
+			if (_layout == LIL)
+				return ;
+			_lil.reset(new LIL_t(field(),_rownb,_colnb));
+			size_t i, j ;
+			Element e ;
+			firstTriple();
+			while (nextTriple(i,j,e))
+				_lil->appendEntry(i,j,e);
+			_lil->finalize();
+			release(_layout);
+			_layout = LIL ;
+		}
+
+		struct SizeOp {
+			size_t nbnz ;
+			template<class Matrix>
+			void operator()(const Matrix & A) { nbnz = A.size(); }
+		} ;
+
+		struct GetEntryOp {
+			size_t i, j ;
+			const Element * e ;
+			GetEntryOp(size_t ii, size_t jj) : i(ii), j(jj), e(NULL) {}
+			template<class Matrix>
+			void operator()(const Matrix & A) { e = &(A.getEntry(i,j)); }
+		} ;
+
+		struct FirstTripleOp {
+			template<class Matrix>
+			void operator()(const Matrix & A) { A.firstTriple(); }
+		} ;
+
+		struct NextTripleOp {
+			size_t & i ;
+			size_t & j ;
+			Element & e ;
+			bool more ;
+			NextTripleOp(size_t & ii, size_t & jj, Element & ee) : i(ii), j(jj), e(ee), more(false) {}
+			template<class Matrix>
+			void operator()(const Matrix & A) { more = A.nextTriple(i,j,e); }
+		} ;
+
+		template<class outVector, class inVector>
+		struct ApplyOp {
+			outVector & y ;
+			const inVector & x ;
+			ApplyOp(outVector & yy, const inVector & xx) : y(yy), x(xx) {}
+			template<class Matrix>
+			void operator()(const Matrix & A) { A.apply(y,x); }
+		} ;
+
+		template<class outVector, class inVector>
+		struct ApplyTransposeOp {
+			outVector & y ;
+			const inVector & x ;
+			ApplyTransposeOp(outVector & yy, const inVector & xx) : y(yy), x(xx) {}
+			template<class Matrix>
+			void operator()(const Matrix & A) { A.applyTranspose(y,x); }
+		} ;
+
+		template<class Mat1, class Mat2>
+		struct ApplyLeftOp {
+			Mat1 & Y ;
+			const Mat2 & X ;
+			ApplyLeftOp(Mat1 & YY, const Mat2 & XX) : Y(YY), X(XX) {}
+			template<class Matrix>
+			void operator()(const Matrix & A) { A.applyLeft(Y,X); }
+		} ;
+
+		template<class Mat1, class Mat2>
+		struct ApplyRightOp {
+			Mat1 & Y ;
+			const Mat2 & X ;
+			ApplyRightOp(Mat1 & YY, const Mat2 & XX) : Y(YY), X(XX) {}
+			template<class Matrix>
+			void operator()(const Matrix & A) { A.applyRight(Y,X); }
+		} ;
+
+	protected :
+		friend class SparseMatrixWriteHelper<Self_t >;
+		friend class SparseMatrixReadHelper<Self_t >;
+
+		size_t              _rownb ;
+		size_t              _colnb ;
+
+		Layout             _layout ;
+
+		std::unique_ptr<LIL_t>   _lil ;
+		std::unique_ptr<CSR_t>   _csr ;
+		std::unique_ptr<ELL_R_t> _ellr ;
+		std::unique_ptr<DIA_t>   _dia ;
+		std::unique_ptr<BCSR_t>  _bcsr ;
+
+		const _Field & _field;
+	};
+
+	template<class Field>
+	struct is_blockbb<SparseMatrix<Field,SparseMatrixFormat::Auto> > {
+		static const bool value = true;
+	};
+
+} // LinBox
+
+#endif // __LINBOX_matrix_sparsematrix_sparse_auto_matrix_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
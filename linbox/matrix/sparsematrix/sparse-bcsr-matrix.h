@@ -0,0 +1,598 @@
+/* linbox/matrix/sparsematrix/sparse-bcsr-matrix.h
+ * Copyright (C) 2013 the LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file matrix/sparsematrix/sparse-bcsr-matrix.h
+ * @ingroup sparsematrix
+ * @brief
+ * A <code>SparseMatrix<_Field, SparseMatrixFormat::BCSR ></code>
+ * is a CSR matrix of small dense blocks.
+ *
+ * The matrix is cut in \c br x \c bc blocks ; the nonzero blocks are stored
+ * row major, with one column index per block instead of one per entry.
+ * The apply on 2x2, 3x3, 4x4 and 6x6 blocks uses kernels of fixed size,
+ * which the compiler unrolls and vectorizes.
+ */
+
+
+#ifndef __LINBOX_matrix_sparsematrix_sparse_bcsr_matrix_H
+#define __LINBOX_matrix_sparsematrix_sparse_bcsr_matrix_H
+
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <memory>
+
+#include "linbox/linbox-config.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/field-axpy.h"
+#include "linbox/util/thread-scratch.h"
+#include "linbox/field/hom.h"
+#include "linbox/matrix/matrix-domain.h"
+#include "linbox/blackbox/blockbb.h"
+#include "sparse-domain.h"
+
+#ifndef LINBOX_BCSR_BLOCK
+#define LINBOX_BCSR_BLOCK 3
+#endif
+
+namespace LinBox
+{
+
+	/** Sparse matrix, Block compressed row storage.
+	 *
+	 * \ingroup matrix
+	 * \ingroup sparse
+	 */
+	template<class _Field>
+	class SparseMatrix<_Field, SparseMatrixFormat::BCSR > {
+	public :
+		typedef _Field                             Field ; //!< Field
+		typedef typename _Field::Element         Element ; //!< Element
+		typedef SparseMatrixFormat::BCSR         Storage ; //!< Matrix Storage Format
+		typedef SparseMatrix<_Field,Storage>      Self_t ; //!< Self type
+
+		/*! Constructors.
+		 * @param br,bc dimensions of the blocks.
+		 */
+		//@{
+		SparseMatrix<_Field, SparseMatrixFormat::BCSR> (const _Field & F, size_t m = 0, size_t n = 0,
+								size_t br = LINBOX_BCSR_BLOCK, size_t bc = LINBOX_BCSR_BLOCK) :
+			_rownb(m),_colnb(n)
+			,_nbnz(0)
+			,_br(br),_bc(bc)
+			,_start((m+br-1)/br+1,0)
+			,_colid(0)
+			,_data(0)
+			,_field(F)
+		{
+			linbox_check(br && bc);
+		}
+
+		SparseMatrix<_Field, SparseMatrixFormat::BCSR> (const SparseMatrix<_Field, SparseMatrixFormat::BCSR> & S) :
+			_rownb(S._rownb),_colnb(S._colnb)
+			,_nbnz(S._nbnz)
+			,_br(S._br),_bc(S._bc)
+			,_start(S._start)
+			,_colid(S._colid)
+			,_data(S._data)
+			,_field(S._field)
+			,_pending(S._pending)
+		{}
+
+		SparseMatrix<_Field, SparseMatrixFormat::BCSR> ( MatrixStream<Field>& ms ):
+			_rownb(0),_colnb(0)
+			,_nbnz(0)
+			,_br(LINBOX_BCSR_BLOCK),_bc(LINBOX_BCSR_BLOCK)
+			,_start(1,0)
+			,_colid(0)
+			,_data(0)
+			,_field(ms.field())
+		{
+			size_t m, n ;
+			if( !ms.getDimensions( m, n ) )
+				throw ms.reportError(__func__,__LINE__);
+			resize(m,n);
+			Element val;
+			size_t i, j;
+			while( ms.nextTriple(i,j,val) )
+				appendEntry(i,j,val);
+			if( ms.getError() > END_OF_MATRIX )
+				throw ms.reportError(__func__,__LINE__);
+			finalize();
+		}
+
+		template<typename _Tp1, typename _Rw1 = SparseMatrixFormat::BCSR>
+		struct rebind {
+			typedef SparseMatrix<_Tp1, _Rw1> other;
+
+			void operator() (other & Ap, const Self_t& A)
+			{
+				typename _Tp1::Element e;
+				Hom<typename Self_t::Field, _Tp1> hom(A.field(), Ap.field());
+				Ap.resize(A.rowdim(), A.coldim());
+				size_t i, j ;
+				Element f ;
+				A.firstTriple();
+				while ( A.nextTriple(i,j,f) ) {
+					hom. image ( e, f) ;
+					if (! Ap.field().isZero(e) )
+						Ap.appendEntry(i,j,e);
+				}
+				A.firstTriple();
+				Ap.finalize();
+			}
+		};
+
+		template<typename _Tp1, typename _Rw1>
+		SparseMatrix (const SparseMatrix<_Tp1, _Rw1> &S, const Field& F,
+			      size_t br = LINBOX_BCSR_BLOCK, size_t bc = LINBOX_BCSR_BLOCK) :
+			_rownb(S.rowdim()),_colnb(S.coldim())
+			,_nbnz(0)
+			,_br(br),_bc(bc)
+			,_start((S.rowdim()+br-1)/br+1,0)
+			,_colid(0)
+			,_data(0)
+			,_field(F)
+		{
+			typename SparseMatrix<_Tp1,_Rw1>::template rebind<Field,Storage>()(*this, S);
+			finalize();
+		}
+		//@}
+
+		/// changes the dimensions ; the matrix becomes zero.
+		void resize(const size_t & mm, const size_t & nn, const size_t & = 0)
+		{
+			_rownb = mm ;
+			_colnb = nn ;
+			_nbnz = 0 ;
+			_start.assign(blockRows()+1,0);
+			_colid.clear();
+			_data.clear();
+			_pending.clear();
+			modified();
+		}
+
+		size_t rowdim() const
+		{
+			return _rownb ;
+		}
+
+		size_t coldim() const
+		{
+			return _colnb ;
+		}
+
+		/// number of non zero entries.
+		size_t size() const
+		{
+			return _nbnz ;
+		}
+
+		const Field & field()  const
+		{
+			return _field ;
+		}
+
+		/// number of rows in a block.
+		size_t blockRowdim() const
+		{
+			return _br ;
+		}
+
+		/// number of columns in a block.
+		size_t blockColdim() const
+		{
+			return _bc ;
+		}
+
+		/// number of stored blocks.
+		size_t blocks() const
+		{
+			return _colid.size();
+		}
+
+		/** Set an individual entry.
+		 * Setting the entry to 0 does not remove its block,
+		 * finalize() does it.
+		 */
+		const Element& setEntry(const size_t &i, const size_t &j, const Element& e)
+		{
+			linbox_check(i<_rownb);
+			linbox_check(j<_colnb);
+			const size_t I = i/_br, J = j/_bc ;
+			std::vector<size_t>::iterator beg = _colid.begin() ;
+			std::vector<size_t>::iterator low = std::lower_bound(beg+(ptrdiff_t)_start[I], beg+(ptrdiff_t)_start[I+1], J);
+			size_t k = (size_t)(low-beg) ;
+			if (k == _start[I+1] || *low != J) {
+				if (field().isZero(e))
+					return e ;
+				_colid.insert(low, J);
+				_data.insert(_data.begin()+(ptrdiff_t)(k*_br*_bc), _br*_bc, field().zero);
+				for (size_t L = I+1 ; L < _start.size() ; ++L)
+					_start[L] += 1 ;
+			}
+			modified();
+
+			Element & x = _data[k*_br*_bc+(i%_br)*_bc+j%_bc];
+			if (field().isZero(x) && !field().isZero(e))
+				++_nbnz ;
+			else if (!field().isZero(x) && field().isZero(e))
+				--_nbnz ;
+			field().assign(x,e);
+			return e ;
+		}
+
+		/** Adds an entry, in any order.
+		 * The entries are only stored by the next finalize(), which sorts
+		 * them once ; this is the fast way to build a large matrix.
+		 */
+		void appendEntry(const size_t &i, const size_t &j, const Element& e)
+		{
+			linbox_check(i<_rownb);
+			linbox_check(j<_colnb);
+			if (! field().isZero(e))
+				_pending.push_back(Triple(i,j,e));
+		}
+
+		void clearEntry(const size_t &i, const size_t &j)
+		{
+			setEntry(i,j,field().zero);
+		}
+
+		/** make matrix ready to use after a sequence of setEntry or appendEntry calls.
+		 * Pending entries are stored, zero blocks are removed.
+		 */
+		void finalize()
+		{
+			std::vector<Triple> entries ;
+			entries.reserve(_nbnz+_pending.size());
+			size_t i, j ;
+			Element e ;
+			firstTriple();
+			while (nextTriple(i,j,e))
+				entries.push_back(Triple(i,j,e));
+			entries.insert(entries.end(), _pending.begin(), _pending.end());
+			_pending.clear();
+
+			const size_t br = _br, bc = _bc ;
+			// stable : the last entry set at some position wins.
+			std::stable_sort(entries.begin(), entries.end(),
+					 [br,bc](const Triple & a, const Triple & b) {
+					 return (a.row/br < b.row/br) || (a.row/br == b.row/br && a.col/bc < b.col/bc) ; });
+
+			_start.assign(blockRows()+1,0);
+			_colid.clear();
+			_data.clear();
+			_nbnz = 0 ;
+			for (size_t k = 0 ; k < entries.size() ; ) {
+				const size_t I = entries[k].row/br, J = entries[k].col/bc ;
+				const size_t base = _data.size() ;
+				_data.resize(base+br*bc, field().zero);
+				for ( ; k < entries.size() && entries[k].row/br == I && entries[k].col/bc == J ; ++k)
+					field().assign(_data[base+(entries[k].row%br)*bc+entries[k].col%bc], entries[k].elt);
+				size_t nz = 0 ;
+				for (size_t p = base ; p < _data.size() ; ++p)
+					if (! field().isZero(_data[p])) ++nz ;
+				if (nz == 0)
+					_data.resize(base);
+				else {
+					_colid.push_back(J);
+					_start[I+1] += 1 ;
+					_nbnz += nz ;
+				}
+			}
+			for (size_t I = 0 ; I+1 < _start.size() ; ++I)
+				_start[I+1] += _start[I] ;
+
+			_triples.reset();
+			modified();
+		}
+
+		/// entry (i,j) ; entries from appendEntry are seen after finalize().
+		const Element & getEntry(const size_t &i, const size_t &j) const
+		{
+			linbox_check(i<_rownb);
+			linbox_check(j<_colnb);
+			const size_t I = i/_br, J = j/_bc ;
+			std::vector<size_t>::const_iterator beg = _colid.begin() ;
+			std::vector<size_t>::const_iterator low = std::lower_bound(beg+(ptrdiff_t)_start[I], beg+(ptrdiff_t)_start[I+1], J);
+			size_t k = (size_t)(low-beg) ;
+			if (k == _start[I+1] || *low != J)
+				return field().zero ;
+			return _data[k*_br*_bc+(i%_br)*_bc+j%_bc] ;
+		}
+
+		Element      &getEntry (Element &x, size_t i, size_t j) const
+		{
+			return x = getEntry (i, j);
+		}
+
+		void firstTriple() const
+		{
+			_triples.reset();
+		}
+
+		/// entries block by block.
+		bool nextTriple(size_t & i, size_t &j, Element &e) const
+		{
+			const size_t bs = _br*_bc ;
+			for (;;) {
+				if (_triples._pos == bs) {
+					++_triples._blk ;
+					_triples._pos = 0 ;
+				}
+				if (_triples._blk >= _colid.size()) {
+					_triples.reset();
+					return false ;
+				}
+				while (_start[_triples._brow+1] <= _triples._blk)
+					++_triples._brow ;
+				const size_t p = _triples._pos++ ;
+				e = _data[_triples._blk*bs+p] ;
+				if (field().isZero(e))
+					continue ;
+				i = _triples._brow*_br + p/_bc ;
+				j = _colid[_triples._blk]*_bc + p%_bc ;
+				return true ;
+			}
+		}
+
+		/** Write a matrix to the given output stream using field read/write.
+		 * @param os Output stream to which to write the matrix
+		 * @param format Format with which to write
+		 */
+		std::ostream & write(std::ostream &os
+				     , Tag::FileFormat format  = Tag::FileFormat::MatrixMarket) const
+		{
+			return SparseMatrixWriteHelper<Self_t>::write(*this,os,format);
+		}
+
+		/** Read a matrix from the given input stream using field read/write
+		 * @param is Input stream from which to read the matrix
+		 * @param format Format of input matrix
+		 * @return ref to \p is.
+		 */
+		std::istream& read (std::istream &is
+				    , Tag::FileFormat format = Tag::FileFormat::Detect)
+		{
+			return SparseMatrixReadHelper<Self_t>::read(*this,is,format);
+		}
+
+		// y= Ax
+		template<class outVector, class inVector>
+		outVector& apply(outVector &y, const inVector& x ) const
+		{
+			linbox_check(y.size() == rowdim() && x.size() == coldim());
+			if (_br == 2 && _bc == 2) return applyBlocks<2,2>(y,x);
+			if (_br == 3 && _bc == 3) return applyBlocks<3,3>(y,x);
+			if (_br == 4 && _bc == 4) return applyBlocks<4,4>(y,x);
+			if (_br == 6 && _bc == 6) return applyBlocks<6,6>(y,x);
+			return applyBlocks<0,0>(y,x);
+		}
+
+		// y= A^t x
+		template<class outVector, class inVector>
+		outVector& applyTranspose(outVector &y, const inVector& x ) const
+		{
+			linbox_check(y.size() == coldim() && x.size() == rowdim());
+			const std::shared_ptr<const Self_t> T = _transpose.get(size(), [this]() { return transpose(); });
+			if (T)
+				return T->apply(y,x);
+
+			const FieldAXPY<Field> accu0(field());
+			std::vector<FieldAXPY<Field> > Y(_colnb, accu0);
+			for (size_t I = 0 ; I < blockRows() ; ++I) {
+				const size_t rows = std::min(_br, _rownb-I*_br) ;
+				for (size_t k = _start[I] ; k < _start[I+1] ; ++k) {
+					const Element * blk = &_data[k*_br*_bc] ;
+					const size_t j0 = _colid[k]*_bc ;
+					const size_t cols = std::min(_bc, _colnb-j0) ;
+					for (size_t r = 0 ; r < rows ; ++r)
+						for (size_t c = 0 ; c < cols ; ++c)
+							Y[j0+c].mulacc(blk[r*_bc+c], x[I*_br+r]);
+				}
+			}
+			for (size_t j = 0 ; j < _colnb ; ++j)
+				Y[j].get(y[j]);
+			return y;
+		}
+
+		/** Keep the transpose (with \p bc x \p br blocks) for
+		 * \c applyTranspose, which is then a parallel apply of it. It is
+		 * built at the first \c applyTranspose and dropped when the
+		 * matrix is modified.
+		 * @param on \c false to never keep it, \c applyTranspose then
+		 * scatters the blocks in one accumulator per column.
+		 */
+		void cacheTranspose(bool on = true)
+		{
+			_transpose.policy(on);
+		}
+
+		/// Y <- A X.
+		template<class Mat1, class Mat2>
+		Mat1 & applyLeft(Mat1 &Y, const Mat2 &X) const
+		{
+			return applyLeftByTriples(MatrixDomain<Field>(field()), Y, *this, X);
+		}
+
+		/// Y <- X A.
+		template<class Mat1, class Mat2>
+		Mat1 & applyRight(Mat1 &Y, const Mat2 &X) const
+		{
+			return applyRightByTriples(MatrixDomain<Field>(field()), Y, *this, X);
+		}
+
+		/// block rows split by number of blocks, for the (parallel) apply.
+		RowPartition::Blocks partition() const
+		{
+			const std::vector<size_t> & start = _start ;
+			return _partition.update(blockRows(), _colid.size(),
+						 [&start](size_t I) { return start[I+1]-start[I]; });
+		}
+
+	private :
+		size_t blockRows() const
+		{
+			return (_rownb+_br-1)/_br ;
+		}
+
+		/// drops what was computed from the entries (partition, transpose).
+		void modified()
+		{
+			_partition.clear();
+			_transpose.clear();
+		}
+
+		/// a new matrix, the transpose, read from the blocks (not through the triples, which are not thread safe).
+		Self_t * transpose() const
+		{
+			Self_t * T = new Self_t(field(), _colnb, _rownb, _bc, _br);
+			for (size_t I = 0 ; I < blockRows() ; ++I) {
+				const size_t rows = std::min(_br, _rownb-I*_br) ;
+				for (size_t k = _start[I] ; k < _start[I+1] ; ++k) {
+					const Element * blk = &_data[k*_br*_bc] ;
+					const size_t j0 = _colid[k]*_bc ;
+					const size_t cols = std::min(_bc, _colnb-j0) ;
+					for (size_t r = 0 ; r < rows ; ++r)
+						for (size_t c = 0 ; c < cols ; ++c)
+							T->appendEntry(j0+c, I*_br+r, blk[r*_bc+c]);
+				}
+			}
+			T->finalize();
+			return T ;
+		}
+
+		/** y = A x with \p R x \p C blocks, \p R = 0 or \p C = 0 for the
+		 * dimensions given at run time.
+		 */
+		template<size_t R, size_t C, class outVector, class inVector>
+		outVector& applyBlocks(outVector &y, const inVector& x ) const
+		{
+			const size_t br = R ? R : _br ;
+			const size_t bc = C ? C : _bc ;
+			const RowPartition::Blocks part = partition();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static,1) if(part.blocks() > 1)
+#endif
+			for (size_t b = 0 ; b < part.blocks() ; ++b) {
+				std::vector<FieldAXPY<Field> > & accu = accumulators(field(), br);
+				for (size_t I = part.begin(b) ; I < part.end(b) ; ++I) {
+					for (size_t r = 0 ; r < br ; ++r)
+						accu[r].reset();
+					for (size_t k = _start[I] ; k < _start[I+1] ; ++k) {
+						const Element * blk = &_data[k*br*bc] ;
+						const size_t j0 = _colid[k]*bc ;
+						if (j0+bc <= _colnb) {
+							for (size_t r = 0 ; r < br ; ++r)
+								for (size_t c = 0 ; c < bc ; ++c)
+									accu[r].mulacc(blk[r*bc+c], x[j0+c]);
+						}
+						else { // last block column, partly outside
+							for (size_t r = 0 ; r < br ; ++r)
+								for (size_t c = 0 ; j0+c < _colnb ; ++c)
+									accu[r].mulacc(blk[r*bc+c], x[j0+c]);
+						}
+					}
+					const size_t rows = std::min(br, _rownb-I*br) ;
+					for (size_t r = 0 ; r < rows ; ++r)
+						accu[r].get(y[I*br+r]);
+				}
+			}
+			return y;
+		}
+
+		// returns the n accumulators of a block row over F, per thread so
+		// that the partition blocks of applyBlocks do not allocate them.
+		static std::vector<FieldAXPY<Field> > & accumulators(const Field & F, size_t n)
+		{
+			std::vector<FieldAXPY<Field> > & accu = threadScratch<std::vector<FieldAXPY<Field> >, Self_t>();
+			accu.assign(n, FieldAXPY<Field>(F));
+			return accu;
+		}
+
+		struct Triple {
+			size_t row ;
+			size_t col ;
+			Element elt ;
+			Triple(size_t i, size_t j, const Element & e) :
+				row(i), col(j), elt(e)
+			{}
+		};
+
+	protected :
+		friend class SparseMatrixWriteHelper<Self_t >;
+		friend class SparseMatrixReadHelper<Self_t >;
+
+		size_t              _rownb ;
+		size_t              _colnb ;
+		size_t               _nbnz ;
+		size_t                 _br ; //!< rows in a block
+		size_t                 _bc ; //!< columns in a block
+
+		std::vector<size_t> _start ; //!< blocks of block row \p I are <code>_start[I].._start[I+1]</code>
+		std::vector<size_t> _colid ; //!< block column of each block
+		std::vector<Element> _data ; //!< the blocks, \p _br x \p _bc each, row major
+
+		const _Field & _field;
+
+		std::vector<Triple> _pending ; //!< appended, not yet stored
+
+		mutable RowPartition _partition ;
+		mutable TransposeCache<Self_t> _transpose ;
+
+		mutable struct _triples {
+			size_t _blk ;
+			size_t _pos ;
+			size_t _brow ;
+			_triples() :
+				_blk(0)
+				, _pos(0)
+				, _brow(0)
+			{}
+
+			void reset()
+			{
+				_blk = 0 ;
+				_pos = 0 ;
+				_brow = 0 ;
+			}
+		}_triples;
+	};
+
+	template<class Field>
+	struct is_blockbb<SparseMatrix<Field,SparseMatrixFormat::BCSR> > {
+		static const bool value = true;
+	};
+
+} // LinBox
+
+#endif // __LINBOX_matrix_sparsematrix_sparse_bcsr_matrix_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
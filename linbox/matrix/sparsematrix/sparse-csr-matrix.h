@@ -33,13 +33,16 @@
 #define __LINBOX_sparse_matrix_sparse_csr_matrix_H
 
 #include <utility>
+#include <memory>
 #include <iostream>
 #include <algorithm>
 
 #include "linbox/linbox-config.h"
 #include "linbox/util/debug.h"
 #include "linbox/field/hom.h"
+#include "linbox/blackbox/blockbb.h"
 #include "sparse-domain.h"
+#include "sparse-row-dot.h"
 #include "givaro/zring.h"
 
 #ifndef LINBOX_CSR_TRANSPOSE
@@ -128,7 +131,7 @@ namespace LinBox {
 			,_nbnz(0)
 			,_start(1,0),_colid(0),_data(0)
 			, _field()
-			, _helper()
+			, _transpose(LINBOX_CSR_TRANSPOSE)
 		{
 			_start[0] = 0 ;
 		}
@@ -141,7 +144,7 @@ namespace LinBox {
 			,_colid(0)
 			,_data(0)
 			, _field(F)
-			, _helper()
+			, _transpose(LINBOX_CSR_TRANSPOSE)
 		{
 			_start[0] = 0 ;
 		}
@@ -153,7 +156,7 @@ namespace LinBox {
 			,_colid(0)
 			,_data(0)
 			, _field(F)
-			, _helper()
+			, _transpose(LINBOX_CSR_TRANSPOSE)
 		{
 			_start[0] = 0 ;
 		}
@@ -167,7 +170,7 @@ namespace LinBox {
 			, _colid(z)
 			,_data(z)
 			, _field(F)
-			, _helper()
+			, _transpose(LINBOX_CSR_TRANSPOSE)
 		{
 			_start[0] = 0 ;
 		}
@@ -179,7 +182,7 @@ namespace LinBox {
 			, _colid(S._colid)
 			,_data(S._data)
 			, _field(S._field)
-			, _helper()
+			, _transpose(S._transpose)
 		{
 		}
 
@@ -302,6 +305,7 @@ namespace LinBox {
 			, _colid(0)
 			,_data(0)
 			, _field(F)
+			, _transpose(LINBOX_CSR_TRANSPOSE)
 		{
 			{
 				_start[0] = 0 ;
@@ -331,6 +335,7 @@ namespace LinBox {
 			,_colid(0)
 			,_data(0)
 			,_field(ms.field())
+			,_transpose(LINBOX_CSR_TRANSPOSE)
 		{
 			firstTriple();
 
@@ -374,6 +379,7 @@ namespace LinBox {
 			_colid.resize(nn);
 			_data.resize(nn);
 			_nbnz = nn ;
+			modified();
 		}
 
 		void resize(const size_t & mm, const size_t & nn, const size_t & zz = 0)
@@ -385,6 +391,19 @@ namespace LinBox {
 			resize(zz);
 		}
 
+		/** Keep the transpose of the matrix for \c applyTranspose.
+		 * The transpose is built at the first \c applyTranspose, then
+		 * applyTranspose is a (parallel) apply of it, without scattering
+		 * nor allocation. It is dropped when the matrix is modified.
+		 * @param on \c true to always keep it, \c false to never keep it.
+		 * Without a call, it is kept for matrices with more than
+		 * \c LINBOX_CSR_TRANSPOSE entries.
+		 */
+		void cacheTranspose(bool on = true)
+		{
+			_transpose.policy(on);
+		}
+
 		/*! Default converter.
 		 * @param S a sparse matrix in any storage.
 		 */
@@ -392,7 +411,8 @@ namespace LinBox {
 		SparseMatrix<_Field, SparseMatrixFormat::CSR> (const SparseMatrix<_Field, _OtherStorage> & S) :
 			_rownb(S.rowdim()),_colnb(S.coldim()),
 			_start(S.rowdim()+1,0),_colid(S.size()),_data(S.size()),
-			_field(S.field())
+			_field(S.field()),
+			_transpose(LINBOX_CSR_TRANSPOSE)
 		{
 			this->importe(S); // convert Temp from anything
 			finalize();
@@ -550,6 +570,12 @@ namespace LinBox {
 			return _nbnz ;
 		}
 
+		/// bytes used by the entries and their indices.
+		size_t memoryUsage() const
+		{
+			return (_start.size()+_colid.size())*sizeof(index_t) + _data.size()*sizeof(Element) ;
+		}
+
 		void setSize(const size_t & z)
 		{
 			_nbnz = z ;
@@ -641,6 +667,7 @@ namespace LinBox {
 				linbox_check(_start[rowdim()] == (index_t)_nbnz);
 			}
 			_triples.reset();
+			modified();
 
 		} // end construction after a sequence of setEntry calls.
 
@@ -665,6 +692,7 @@ namespace LinBox {
 				clearEntry(i,j);
                 return e;
 			}
+			modified();
 
 			// nothing has been done yet
 			typedef typename svector_t::iterator myIterator ;
@@ -793,6 +821,7 @@ namespace LinBox {
 				_colid.erase(_colid.begin()+(ptrdiff_t)la);
 				_data. erase(_data. begin()+(ptrdiff_t)la);
 				--_nbnz;
+				modified();
 				return  ;
 			}
 		}
@@ -813,6 +842,7 @@ namespace LinBox {
 				else
 					++i ;
 			}
+			modified();
 			return ;
 		}
 
@@ -827,18 +857,80 @@ namespace LinBox {
 
 
 			// std::cout << "apply" << std::endl;
-			FieldAXPY<Field> accu(field());
-			for (size_t i = 0 ; i < _rownb ; ++i) {
-				accu.reset();
-				for (index_t k = _start[i] ; k < _start[i+1] ; ++k)
-					// field().axpyin( y[i], _data[k], x[_colid[k]] ); //! @todo delay !!!
-					accu.mulacc(_data[k],x[_colid[k]]);
-				accu.get(y[i]);
+			const RowPartition::Blocks part = partition();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static,1) if(part.blocks() > 1)
+#endif
+			for (size_t b = 0 ; b < part.blocks() ; ++b) {
+				FieldAXPY<Field> accu(field());
+				const SparseRowDot<Field> dot(field());
+				for (size_t i = part.begin(b) ; i < part.end(b) ; ++i) {
+					accu.reset();
+					dot.mulacc(accu, _data.data()+_start[i], _colid.data()+_start[i],
+					    (size_t)(_start[i+1]-_start[i]), x);
+					accu.get(y[i]);
+				}
 			}
 
 			return y;
 		}
 
+		/// rows split by number of entries, for the (parallel) apply.
+		RowPartition::Blocks partition() const
+		{
+			const svector_t & start = _start ;
+			return _partition.update(_rownb, _nbnz,
+						 [&start](size_t i) { return (size_t)(start[i+1]-start[i]); });
+		}
+
+		/** Y <- A X, for dense row-major blocks.
+		 * Each entry of \p A is read once for all the columns of \p X.
+		 */
+		template<class Mat1, class Mat2>
+		Mat1 & applyLeft(Mat1 &Y, const Mat2 &X) const
+		{
+			linbox_check(Y.rowdim() == rowdim() && X.rowdim() == coldim() && Y.coldim() == X.coldim());
+			const RowPartition::Blocks part = partition();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static,1) if(part.blocks() > 1)
+#endif
+			for (size_t b = 0 ; b < part.blocks() ; ++b) {
+				SparseRowBlock<Field> row(field(), X.coldim());
+				for (size_t i = part.begin(b) ; i < part.end(b) ; ++i) {
+					row.mul(Y.getPointer()+i*Y.getStride(), _data.data()+_start[i], _colid.data()+_start[i],
+						(size_t)(_start[i+1]-_start[i]), X.getPointer(), X.getStride());
+				}
+			}
+			return Y;
+		}
+
+		/** Y <- X A, for dense row-major blocks.
+		 * Each entry of \p A is read once for all the rows of \p X.
+		 */
+		template<class Mat1, class Mat2>
+		Mat1 & applyRight(Mat1 &Y, const Mat2 &X) const
+		{
+			linbox_check(Y.coldim() == coldim() && X.coldim() == rowdim() && Y.rowdim() == X.rowdim());
+			SparseColBlock<Field> col(field(), coldim(), X.rowdim());
+			for (size_t i = 0 ; i < rowdim() ; ++i) {
+				col.mulacc(_data.data()+_start[i], _colid.data()+_start[i], (size_t)(_start[i+1]-_start[i]),
+					   X.getPointer(), X.getStride(), i);
+			}
+			col.get(Y.getPointer(), Y.getStride());
+			return Y;
+		}
+
+		/*! @internal
+		 * drops what was computed from the entries (transpose, partition).
+		 * Direct changes by \c setStart, \c setColid, \c setData
+		 * must be followed by \c finalize().
+		 */
+		void modified()
+		{
+			_transpose.clear();
+			_partition.clear();
+		}
+
 
 		// y= A^t x
 		// y[i] = sum(A(j,i) x(j)
@@ -846,9 +938,13 @@ namespace LinBox {
 		outVector& applyTranspose(outVector &y, const inVector& x, const Element & a) const
 		{
 			linbox_check(consistent());
-			if (_helper.optimized(*this)) {
-				return _helper.matrix().apply(y,x,a) ; // NEVER use applyTranspose on that thing.
-			}
+			const std::shared_ptr<const Self_t> T = _transpose.get(size(), [this]() {
+				Self_t * AT = new Self_t(field(), coldim(), rowdim());
+				transpose(*AT);
+				return AT;
+			});
+			if (T)
+				return T->apply(y,x,a) ; // NEVER use applyTranspose on that thing.
 
 			prepare(field(),y,a);
 
@@ -903,54 +999,6 @@ namespace LinBox {
 
 	private :
 
-		class Helper {
-			bool _useable ;
-			bool _optimized ;
-			bool blackbox_usage ;
-			Self_t *_AT ;
-		public:
-
-			Helper() :
-				_useable(false)
-				,_optimized(false)
-				, blackbox_usage(true)
-				, _AT(NULL)
-			{}
-
-			~Helper()
-			{
-				if ( _AT ) {
-					delete _AT ;
-				}
-			}
-
-			bool optimized(const Self_t & A)
-			{
-				if (!_useable) {
-					getHelp(A);
-					_useable = true;
-				}
-				return	_optimized;
-			}
-
-			void getHelp(const Self_t & A)
-			{
-				if ( A.size() > LINBOX_CSR_TRANSPOSE ) { // and/or A.rowDensity(), A.coldim(),...
-					// std::cout << "optimizing..." ;
-					_optimized = true ;
-					_AT = new Self_t(A.field(),A.coldim(),A.rowdim());
-					A.transpose(*_AT);
-					// std::cout << "done!" << std::endl;
-				}
-			}
-
-			const Self_t & matrix() const
-			{
-				return *_AT ;
-			}
-
-		};
-
 	public:
 		// pseudo iterators
 		index_t getStart(const size_t & i) const
@@ -995,6 +1043,7 @@ namespace LinBox {
 					break;
 			}
 			_rownb = i ;
+			modified();
 
 		}
 
@@ -1442,7 +1491,8 @@ namespace LinBox {
 
 		const _Field & _field;
 
-		mutable Helper _helper ;
+		mutable TransposeCache<Self_t> _transpose ;
+		mutable RowPartition _partition ;
 
 		mutable struct _triples {
 			ptrdiff_t _row ;
@@ -1469,6 +1519,11 @@ namespace LinBox {
 		}_triples;
 	};
 
+	template<class Field>
+	struct is_blockbb<SparseMatrix<Field,SparseMatrixFormat::CSR> > {
+		static const bool value = true;
+	};
+
 #if 1
 
 	// template<>
@@ -0,0 +1,619 @@
+/* linbox/matrix/sparsematrix/sparse-csr16-matrix.h
+ * Copyright (C) 2013 the LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file matrix/sparsematrix/sparse-csr16-matrix.h
+ * @ingroup sparsematrix
+ * @brief
+ * A <code>SparseMatrix<_Field, SparseMatrixFormat::CSR16 ></code>
+ * is a CSR matrix with 16 bits column indices.
+ *
+ * The columns are cut in slices of 2^16. Each entry keeps only its offset
+ * in its slice, on 2 bytes instead of the <code>sizeof(index_t)</code> of
+ * CSR. The entries of a row are in slice 0 until a segment, stored where
+ * the row starts in another slice or moves to the next one, says
+ * otherwise. A matrix with fewer than 2^16 columns has no segment, and one
+ * with its entries close to the diagonal (see algorithms/sparse-reordering.h)
+ * has at most about one per row : past the few bytes of a segment, the
+ * indices take 2 bytes per entry and <code>sizeof(size_t)</code> per row.
+ */
+
+
+#ifndef __LINBOX_matrix_sparsematrix_sparse_csr16_matrix_H
+#define __LINBOX_matrix_sparsematrix_sparse_csr16_matrix_H
+
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+
+#include "linbox/linbox-config.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/field-axpy.h"
+#include "linbox/field/hom.h"
+#include "linbox/blackbox/blockbb.h"
+#include "sparse-domain.h"
+#include "sparse-row-dot.h"
+
+namespace LinBox
+{
+
+	/** Sparse matrix, Compressed row storage with 16 bits column offsets.
+	 *
+	 * \ingroup matrix
+	 * \ingroup sparse
+	 */
+	template<class _Field>
+	class SparseMatrix<_Field, SparseMatrixFormat::CSR16 > {
+	public :
+		typedef _Field                             Field ; //!< Field
+		typedef typename _Field::Element         Element ; //!< Element
+		typedef SparseMatrixFormat::CSR16        Storage ; //!< Matrix Storage Format
+		typedef SparseMatrix<_Field,Storage>      Self_t ; //!< Self type
+		typedef uint16_t                          Offset ; //!< column in a slice
+
+		/*! Constructors.
+		 */
+		//@{
+		SparseMatrix<_Field, SparseMatrixFormat::CSR16> (const _Field & F, size_t m = 0, size_t n = 0) :
+			_rownb(m),_colnb(n)
+			,_nbnz(0)
+			,_start(m+1,0)
+			,_segs(0)
+			,_colid(0)
+			,_data(0)
+			,_field(F)
+		{}
+
+		SparseMatrix<_Field, SparseMatrixFormat::CSR16> (const SparseMatrix<_Field, SparseMatrixFormat::CSR16> & S) :
+			_rownb(S._rownb),_colnb(S._colnb)
+			,_nbnz(S._nbnz)
+			,_start(S._start)
+			,_segs(S._segs)
+			,_colid(S._colid)
+			,_data(S._data)
+			,_field(S._field)
+			,_pending(S._pending)
+		{}
+
+		SparseMatrix<_Field, SparseMatrixFormat::CSR16> ( MatrixStream<Field>& ms ):
+			_rownb(0),_colnb(0)
+			,_nbnz(0)
+			,_start(1,0)
+			,_segs(0)
+			,_colid(0)
+			,_data(0)
+			,_field(ms.field())
+		{
+			size_t m, n ;
+			if( !ms.getDimensions( m, n ) )
+				throw ms.reportError(__func__,__LINE__);
+			resize(m,n);
+			Element val;
+			size_t i, j;
+			while( ms.nextTriple(i,j,val) )
+				appendEntry(i,j,val);
+			if( ms.getError() > END_OF_MATRIX )
+				throw ms.reportError(__func__,__LINE__);
+			finalize();
+		}
+
+		template<typename _Tp1, typename _Rw1 = SparseMatrixFormat::CSR16>
+		struct rebind {
+			typedef SparseMatrix<_Tp1, _Rw1> other;
+
+			void operator() (other & Ap, const Self_t& A)
+			{
+				typename _Tp1::Element e;
+				Hom<typename Self_t::Field, _Tp1> hom(A.field(), Ap.field());
+				Ap.resize(A.rowdim(), A.coldim());
+				size_t i, j ;
+				Element f ;
+				A.firstTriple();
+				while ( A.nextTriple(i,j,f) ) {
+					hom. image ( e, f) ;
+					if (! Ap.field().isZero(e) )
+						Ap.appendEntry(i,j,e);
+				}
+				A.firstTriple();
+				Ap.finalize();
+			}
+		};
+
+		template<typename _Tp1, typename _Rw1>
+		SparseMatrix (const SparseMatrix<_Tp1, _Rw1> &S, const Field& F) :
+			_rownb(S.rowdim()),_colnb(S.coldim())
+			,_nbnz(0)
+			,_start(S.rowdim()+1,0)
+			,_segs(0)
+			,_colid(0)
+			,_data(0)
+			,_field(F)
+		{
+			typename SparseMatrix<_Tp1,_Rw1>::template rebind<Field,Storage>()(*this, S);
+			finalize();
+		}
+		//@}
+
+		/// changes the dimensions ; the matrix becomes zero.
+		void resize(const size_t & mm, const size_t & nn, const size_t & = 0)
+		{
+			_rownb = mm ;
+			_colnb = nn ;
+			_nbnz = 0 ;
+			_start.assign(mm+1,0);
+			_segs.clear();
+			_colid.clear();
+			_data.clear();
+			_pending.clear();
+			_partition.clear();
+		}
+
+		size_t rowdim() const
+		{
+			return _rownb ;
+		}
+
+		size_t coldim() const
+		{
+			return _colnb ;
+		}
+
+		/// number of non zero entries.
+		size_t size() const
+		{
+			return _nbnz ;
+		}
+
+		const Field & field()  const
+		{
+			return _field ;
+		}
+
+		/// number of segments, none when the columns fit in a slice.
+		size_t segments() const
+		{
+			return _segs.size();
+		}
+
+		/// bytes used by the entries and their indices.
+		size_t memoryUsage() const
+		{
+			return _start.size()*sizeof(size_t) + _segs.size()*sizeof(Segment)
+			+ _colid.size()*sizeof(Offset) + _data.size()*sizeof(Element) ;
+		}
+
+		/** Set an individual entry.
+		 * Row \p i is stored again : this is as slow as an insertion in CSR.
+		 */
+		const Element& setEntry(const size_t &i, const size_t &j, const Element& e)
+		{
+			linbox_check(i<_rownb);
+			linbox_check(j<_colnb);
+			std::vector<size_t> cols ;
+			getColumns(cols, i);
+			std::vector<size_t>::iterator low = std::lower_bound(cols.begin(), cols.end(), j);
+			const size_t k = (size_t)(low-cols.begin()) ;
+			const bool found = (low != cols.end() && *low == j) ;
+			typename std::vector<Element>::iterator dat = _data.begin()+(ptrdiff_t)(_start[i]+k) ;
+			if (found) {
+				if (! field().isZero(e)) {
+					field().assign(*dat,e);
+					return e ;
+				}
+				cols.erase(low);
+				_data.erase(dat);
+				--_nbnz ;
+			}
+			else {
+				if (field().isZero(e))
+					return e ;
+				cols.insert(low,j);
+				_data.insert(dat,e);
+				++_nbnz ;
+			}
+
+			// row i again, then the following rows shifted
+			std::vector<Segment> segs ;
+			std::vector<Offset> offs ;
+			for (size_t k = 0 ; k < cols.size() ; ++k)
+				push(segs, offs, _start[i], _start[i]+k, cols[k]);
+			const ptrdiff_t dk = found ? -1 : 1 ;
+			const size_t s0 = firstSegment(_start[i]), s1 = firstSegment(_start[i+1]) ;
+			_colid.erase(_colid.begin()+(ptrdiff_t)_start[i], _colid.begin()+(ptrdiff_t)(_start[i+1]));
+			_colid.insert(_colid.begin()+(ptrdiff_t)_start[i], offs.begin(), offs.end());
+			_segs.erase(_segs.begin()+(ptrdiff_t)s0, _segs.begin()+(ptrdiff_t)s1);
+			_segs.insert(_segs.begin()+(ptrdiff_t)s0, segs.begin(), segs.end());
+			for (size_t l = i+1 ; l <= _rownb ; ++l)
+				_start[l] = (size_t)((ptrdiff_t)_start[l]+dk) ;
+			for (size_t s = s0+segs.size() ; s < _segs.size() ; ++s)
+				_segs[s].begin = (size_t)((ptrdiff_t)_segs[s].begin+dk) ;
+			_triples.reset();
+			_partition.clear();
+			return e ;
+		}
+
+		/** Adds an entry, in any order.
+		 * The entries are only stored by the next finalize(), which sorts
+		 * them once ; this is the fast way to build a large matrix.
+		 */
+		void appendEntry(const size_t &i, const size_t &j, const Element& e)
+		{
+			linbox_check(i<_rownb);
+			linbox_check(j<_colnb);
+			if (! field().isZero(e))
+				_pending.push_back(Triple(i,j,e));
+		}
+
+		void clearEntry(const size_t &i, const size_t &j)
+		{
+			setEntry(i,j,field().zero);
+		}
+
+		/// make matrix ready to use after a sequence of setEntry or appendEntry calls.
+		void finalize()
+		{
+			if (! _pending.empty()) {
+				std::vector<Triple> entries ;
+				entries.reserve(_nbnz+_pending.size());
+				size_t i, j ;
+				Element e ;
+				firstTriple();
+				while (nextTriple(i,j,e))
+					entries.push_back(Triple(i,j,e));
+				entries.insert(entries.end(), _pending.begin(), _pending.end());
+				_pending.clear();
+
+				// stable : the last entry set at some position wins.
+				std::stable_sort(entries.begin(), entries.end(),
+						 [](const Triple & a, const Triple & b) {
+						 return (a.row < b.row) || (a.row == b.row && a.col < b.col) ; });
+
+				_start.assign(_rownb+1,0);
+				_segs.clear();
+				_colid.clear();
+				_data.clear();
+				_data.reserve(entries.size());
+				_colid.reserve(entries.size());
+				size_t row = 0 ;
+				for (size_t k = 0 ; k < entries.size() ; ++k) {
+					if (k+1 < entries.size() && entries[k+1].row == entries[k].row && entries[k+1].col == entries[k].col)
+						continue ;
+					for ( ; row < entries[k].row ; ++row)
+						_start[row+1] = _data.size() ;
+					push(_segs, _colid, _start[row], _data.size(), entries[k].col);
+					_data.push_back(entries[k].elt);
+				}
+				for ( ; row < _rownb ; ++row)
+					_start[row+1] = _data.size() ;
+				_nbnz = _data.size() ;
+			}
+			_triples.reset();
+			_partition.clear();
+		}
+
+		/// entry (i,j) ; entries from appendEntry are seen after finalize().
+		const Element & getEntry(const size_t &i, const size_t &j) const
+		{
+			linbox_check(i<_rownb);
+			linbox_check(j<_colnb);
+			size_t s = firstSegment(_start[i]) ;
+			size_t k = _start[i], end, base = 0 ;
+			for ( ; k < _start[i+1] ; k = end) {
+				nextSegment(s, k, _start[i+1], end, base);
+				if (base == slice(j)) {
+					const Offset * beg = _colid.data() ;
+					const Offset * low = std::lower_bound(beg+k, beg+end, (Offset)(j-base));
+					if (low != beg+end && base+*low == j)
+						return _data[(size_t)(low-beg)] ;
+					break ;
+				}
+			}
+			return field().zero ;
+		}
+
+		Element      &getEntry (Element &x, size_t i, size_t j) const
+		{
+			return x = getEntry (i, j);
+		}
+
+		void firstTriple() const
+		{
+			_triples.reset();
+		}
+
+		bool nextTriple(size_t & i, size_t &j, Element &e) const
+		{
+			const size_t k = _triples._k ;
+			if (k >= _data.size()) {
+				_triples.reset();
+				return false ;
+			}
+			while (_start[_triples._row+1] <= k)
+				++_triples._row ;
+			if (k == _start[_triples._row])
+				_triples._base = 0 ;
+			if (_triples._seg < _segs.size() && _segs[_triples._seg].begin == k)
+				_triples._base = _segs[_triples._seg++].base ;
+			i = _triples._row ;
+			j = _triples._base + _colid[k] ;
+			e = _data[k] ;
+			++_triples._k ;
+			return true ;
+		}
+
+		/** Write a matrix to the given output stream using field read/write.
+		 * @param os Output stream to which to write the matrix
+		 * @param format Format with which to write
+		 */
+		std::ostream & write(std::ostream &os
+				     , Tag::FileFormat format  = Tag::FileFormat::MatrixMarket) const
+		{
+			return SparseMatrixWriteHelper<Self_t>::write(*this,os,format);
+		}
+
+		/** Read a matrix from the given input stream using field read/write
+		 * @param is Input stream from which to read the matrix
+		 * @param format Format of input matrix
+		 * @return ref to \p is.
+		 */
+		std::istream& read (std::istream &is
+				    , Tag::FileFormat format = Tag::FileFormat::Detect)
+		{
+			return SparseMatrixReadHelper<Self_t>::read(*this,is,format);
+		}
+
+		/** y= Ax.
+		 * Each segment is done by SparseRowDot as a CSR row, on the slice
+		 * of \p x it refers to.
+		 */
+		template<class outVector, class inVector>
+		outVector& apply(outVector &y, const inVector& x ) const
+		{
+			linbox_check(y.size() == rowdim() && x.size() == coldim());
+			const RowPartition::Blocks part = partition();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static,1) if(part.blocks() > 1)
+#endif
+			for (size_t b = 0 ; b < part.blocks() ; ++b) {
+				FieldAXPY<Field> accu(field());
+				const SparseRowDot<Field> dot(field());
+				size_t s = firstSegment(_start[part.begin(b)]) ;
+				for (size_t i = part.begin(b) ; i < part.end(b) ; ++i) {
+					accu.reset();
+					size_t end, base = 0 ;
+					for (size_t k = _start[i] ; k < _start[i+1] ; k = end) {
+						nextSegment(s, k, _start[i+1], end, base);
+						dot.mulacc(accu, _data.data()+k, _colid.data()+k, end-k,
+							   Slice<inVector>(x, base));
+					}
+					accu.get(y[i]);
+				}
+			}
+			return y;
+		}
+
+		// y= A^t x
+		template<class outVector, class inVector>
+		outVector& applyTranspose(outVector &y, const inVector& x ) const
+		{
+			linbox_check(y.size() == coldim() && x.size() == rowdim());
+			const FieldAXPY<Field> accu0(field());
+			std::vector<FieldAXPY<Field> > Y(_colnb, accu0);
+			size_t s = 0 ;
+			for (size_t i = 0 ; i < _rownb ; ++i) {
+				size_t end, base = 0 ;
+				for (size_t k = _start[i] ; k < _start[i+1] ; ) {
+					nextSegment(s, k, _start[i+1], end, base);
+					FieldAXPY<Field> * Ys = Y.data()+base ;
+					for ( ; k < end ; ++k)
+						Ys[_colid[k]].mulacc(_data[k], x[i]);
+				}
+			}
+			for (size_t j = 0 ; j < _colnb ; ++j)
+				Y[j].get(y[j]);
+			return y;
+		}
+
+		/** Y <- A X, for dense row-major blocks.
+		 * Each entry of \p A is read once for all the columns of \p X.
+		 */
+		template<class Mat1, class Mat2>
+		Mat1 & applyLeft(Mat1 &Y, const Mat2 &X) const
+		{
+			linbox_check(Y.rowdim() == rowdim() && X.rowdim() == coldim() && Y.coldim() == X.coldim());
+			const RowPartition::Blocks part = partition();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static,1) if(part.blocks() > 1)
+#endif
+			for (size_t b = 0 ; b < part.blocks() ; ++b) {
+				SparseRowBlock<Field> row(field(), X.coldim());
+				std::vector<size_t> cols ;
+				for (size_t i = part.begin(b) ; i < part.end(b) ; ++i) {
+					getColumns(cols, i);
+					row.mul(Y.getPointer()+i*Y.getStride(), _data.data()+_start[i], cols.data(),
+						cols.size(), X.getPointer(), X.getStride());
+				}
+			}
+			return Y;
+		}
+
+		/** Y <- X A, for dense row-major blocks.
+		 * Each entry of \p A is read once for all the rows of \p X.
+		 */
+		template<class Mat1, class Mat2>
+		Mat1 & applyRight(Mat1 &Y, const Mat2 &X) const
+		{
+			linbox_check(Y.coldim() == coldim() && X.coldim() == rowdim() && Y.rowdim() == X.rowdim());
+			SparseColBlock<Field> col(field(), coldim(), X.rowdim());
+			std::vector<size_t> cols ;
+			for (size_t i = 0 ; i < rowdim() ; ++i) {
+				getColumns(cols, i);
+				col.mulacc(_data.data()+_start[i], cols.data(), cols.size(),
+					   X.getPointer(), X.getStride(), i);
+			}
+			col.get(Y.getPointer(), Y.getStride());
+			return Y;
+		}
+
+		/// rows split by number of entries, for the (parallel) apply.
+		RowPartition::Blocks partition() const
+		{
+			const std::vector<size_t> & start = _start ;
+			return _partition.update(_rownb, _nbnz,
+						 [&start](size_t i) { return start[i+1]-start[i]; });
+		}
+
+	private :
+		/// entries from \p begin to the next segment or the end of the row are in columns <code>base+_colid[k]</code>.
+		struct Segment {
+			size_t begin ;
+			size_t base ;
+		};
+
+		/// index of the first segment at or after entry \p k.
+		size_t firstSegment(size_t k) const
+		{
+			return (size_t)(std::lower_bound(_segs.begin(), _segs.end(), k,
+							  [](const Segment & a, size_t b) { return a.begin < b; })
+					- _segs.begin());
+		}
+
+		/** entries <code>[k, end)</code> of a row ending at \p rowend are
+		 * in the slice \p base. \p base is 0 at the start of a row, \p s
+		 * the first segment at or after \p k, and both are moved on.
+		 */
+		void nextSegment(size_t & s, size_t k, size_t rowend, size_t & end, size_t & base) const
+		{
+			if (s < _segs.size() && _segs[s].begin == k)
+				base = _segs[s++].base ;
+			end = (s < _segs.size() && _segs[s].begin < rowend) ? _segs[s].begin : rowend ;
+		}
+
+		/// first column of the slice of \p j.
+		static size_t slice(size_t j)
+		{
+			return j & ~(size_t)0xFFFF ;
+		}
+
+		/// \p x seen from column \p base.
+		template<class Vector>
+		struct Slice {
+			const Vector & x ;
+			const size_t base ;
+			Slice(const Vector & xx, size_t b) : x(xx), base(b) {}
+			auto operator[](size_t j) const -> decltype(x[j]) { return x[base+j]; }
+		};
+
+		/// stores column \p j of entry \p k, the last so far of its row, which starts at entry \p rowstart.
+		static void push(std::vector<Segment> & segs, std::vector<Offset> & offs, size_t rowstart, size_t k, size_t j)
+		{
+			const size_t base = slice(j) ;
+			const size_t cur = (!segs.empty() && segs.back().begin >= rowstart) ? segs.back().base : 0 ;
+			if (base != cur) {
+				Segment s ;
+				s.begin = k ;
+				s.base = base ;
+				segs.push_back(s);
+			}
+			offs.push_back((Offset)(j-base));
+		}
+
+		/// columns of row \p i.
+		void getColumns(std::vector<size_t> & cols, size_t i) const
+		{
+			cols.resize(_start[i+1]-_start[i]);
+			size_t s = firstSegment(_start[i]) ;
+			size_t end, base = 0 ;
+			for (size_t k = _start[i] ; k < _start[i+1] ; ) {
+				nextSegment(s, k, _start[i+1], end, base);
+				for ( ; k < end ; ++k)
+					cols[k-_start[i]] = base+_colid[k] ;
+			}
+		}
+
+		struct Triple {
+			size_t row ;
+			size_t col ;
+			Element elt ;
+			Triple(size_t i, size_t j, const Element & e) :
+				row(i), col(j), elt(e)
+			{}
+		};
+
+	protected :
+		friend class SparseMatrixWriteHelper<Self_t >;
+		friend class SparseMatrixReadHelper<Self_t >;
+
+		size_t              _rownb ;
+		size_t              _colnb ;
+		size_t               _nbnz ;
+
+		std::vector<size_t>   _start ; //!< entries of row \p i are <code>_start[i].._start[i+1]</code>
+		std::vector<Segment>   _segs ; //!< where a row is not in slice 0, by entry
+		std::vector<Offset>   _colid ; //!< column of each entry, in its slice
+		std::vector<Element>   _data ;
+
+		const _Field & _field;
+
+		std::vector<Triple> _pending ; //!< appended, not yet stored
+
+		mutable RowPartition _partition ;
+
+		mutable struct _triples {
+			size_t _row ;
+			size_t _seg ;
+			size_t _k ;
+			size_t _base ;
+			_triples() :
+				_row(0)
+				, _seg(0)
+				, _k(0)
+				, _base(0)
+			{}
+
+			void reset()
+			{
+				_row = 0 ;
+				_seg = 0 ;
+				_k = 0 ;
+				_base = 0 ;
+			}
+		}_triples;
+	};
+
+	template<class Field>
+	struct is_blockbb<SparseMatrix<Field,SparseMatrixFormat::CSR16> > {
+		static const bool value = true;
+	};
+
+} // LinBox
+
+#endif // __LINBOX_matrix_sparsematrix_sparse_csr16_matrix_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -0,0 +1,497 @@
+/* linbox/matrix/sparsematrix/sparse-dia-matrix.h
+ * Copyright (C) 2013 the LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file matrix/sparsematrix/sparse-dia-matrix.h
+ * @ingroup sparsematrix
+ * @brief
+ * A <code>SparseMatrix<_Field, SparseMatrixFormat::DIA ></code>
+ * stores the nonzero diagonals of the matrix.
+ *
+ * Diagonal \c k holds the entries <code>A(i,i+k)</code>. It is stored either
+ * densely, or, when all its entries are equal (Toeplitz-like matrices),
+ * as a single value. finalize() drops the zero diagonals and compresses the
+ * constant ones. There are no column indices at all: this is the format for
+ * banded matrices.
+ */
+
+
+#ifndef __LINBOX_matrix_sparsematrix_sparse_dia_matrix_H
+#define __LINBOX_matrix_sparsematrix_sparse_dia_matrix_H
+
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+
+#include "linbox/linbox-config.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/field-axpy.h"
+#include "linbox/field/hom.h"
+#include "linbox/matrix/matrix-domain.h"
+#include "linbox/blackbox/blockbb.h"
+#include "sparse-domain.h"
+
+namespace LinBox
+{
+
+	/** Sparse matrix, Diagonal storage.
+	 *
+	 * \ingroup matrix
+	 * \ingroup sparse
+	 */
+	template<class _Field>
+	class SparseMatrix<_Field, SparseMatrixFormat::DIA > {
+	public :
+		typedef _Field                             Field ; //!< Field
+		typedef typename _Field::Element         Element ; //!< Element
+		typedef SparseMatrixFormat::DIA          Storage ; //!< Matrix Storage Format
+		typedef SparseMatrix<_Field,Storage>      Self_t ; //!< Self type
+
+		/*! Constructors.
+		 */
+		//@{
+		SparseMatrix<_Field, SparseMatrixFormat::DIA> (const _Field & F, size_t m = 0, size_t n = 0) :
+			_rownb(m),_colnb(n)
+			,_nbnz(0)
+			,_offset(0)
+			,_start(1,0)
+			,_data(0)
+			,_field(F)
+		{}
+
+		SparseMatrix<_Field, SparseMatrixFormat::DIA> (const SparseMatrix<_Field, SparseMatrixFormat::DIA> & S) :
+			_rownb(S._rownb),_colnb(S._colnb)
+			,_nbnz(S._nbnz)
+			,_offset(S._offset)
+			,_start(S._start)
+			,_data(S._data)
+			,_field(S._field)
+		{}
+
+		SparseMatrix<_Field, SparseMatrixFormat::DIA> ( MatrixStream<Field>& ms ):
+			_rownb(0),_colnb(0)
+			,_nbnz(0)
+			,_offset(0)
+			,_start(1,0)
+			,_data(0)
+			,_field(ms.field())
+		{
+			size_t m, n ;
+			if( !ms.getDimensions( m, n ) )
+				throw ms.reportError(__func__,__LINE__);
+			resize(m,n);
+			Element val;
+			size_t i, j;
+			while( ms.nextTriple(i,j,val) )
+				appendEntry(i,j,val);
+			if( ms.getError() > END_OF_MATRIX )
+				throw ms.reportError(__func__,__LINE__);
+			finalize();
+		}
+
+		template<typename _Tp1, typename _Rw1 = SparseMatrixFormat::DIA>
+		struct rebind {
+			typedef SparseMatrix<_Tp1, _Rw1> other;
+
+			void operator() (other & Ap, const Self_t& A)
+			{
+				typename _Tp1::Element e;
+				Hom<typename Self_t::Field, _Tp1> hom(A.field(), Ap.field());
+				Ap.resize(A.rowdim(), A.coldim());
+				size_t i, j ;
+				Element f ;
+				A.firstTriple();
+				while ( A.nextTriple(i,j,f) ) {
+					hom. image ( e, f) ;
+					if (! Ap.field().isZero(e) )
+						Ap.appendEntry(i,j,e);
+				}
+				A.firstTriple();
+				Ap.finalize();
+			}
+		};
+
+		template<typename _Tp1, typename _Rw1>
+		SparseMatrix (const SparseMatrix<_Tp1, _Rw1> &S, const Field& F) :
+			_rownb(S.rowdim()),_colnb(S.coldim())
+			,_nbnz(0)
+			,_offset(0)
+			,_start(1,0)
+			,_data(0)
+			,_field(F)
+		{
+			typename SparseMatrix<_Tp1,_Rw1>::template rebind<Field,Storage>()(*this, S);
+			finalize();
+		}
+		//@}
+
+		/// changes the dimensions ; the matrix becomes zero.
+		void resize(const size_t & mm, const size_t & nn, const size_t & = 0)
+		{
+			_rownb = mm ;
+			_colnb = nn ;
+			_nbnz = 0 ;
+			_offset.clear();
+			_start.assign(1,0);
+			_data.clear();
+			_partition.clear();
+			_tpartition.clear();
+		}
+
+		size_t rowdim() const
+		{
+			return _rownb ;
+		}
+
+		size_t coldim() const
+		{
+			return _colnb ;
+		}
+
+		/// number of non zero entries.
+		size_t size() const
+		{
+			return _nbnz ;
+		}
+
+		const Field & field()  const
+		{
+			return _field ;
+		}
+
+		/// number of stored diagonals.
+		size_t diagonals() const
+		{
+			return _offset.size();
+		}
+
+		/// offset \c k of the \p d-th stored diagonal, holding the <code>A(i,i+k)</code>.
+		ptrdiff_t offset(const size_t & d) const
+		{
+			return _offset[d];
+		}
+
+		/// whether the \p d-th stored diagonal is kept as a single value.
+		bool isConstant(const size_t & d) const
+		{
+			return _start[d+1]-_start[d] == 1 ;
+		}
+
+		/** Set an individual entry.
+		 * Setting the entry to 0 does not remove its diagonal,
+		 * finalize() does it.
+		 */
+		const Element& setEntry(const size_t &i, const size_t &j, const Element& e)
+		{
+			linbox_check(i<_rownb);
+			linbox_check(j<_colnb);
+			const ptrdiff_t k = (ptrdiff_t)j-(ptrdiff_t)i ;
+			size_t d = (size_t)(std::lower_bound(_offset.begin(),_offset.end(),k)-_offset.begin());
+			if (d == _offset.size() || _offset[d] != k) {
+				if (field().isZero(e))
+					return e ;
+				insertDiagonal(d,k);
+			}
+			else if (isConstant(d) && length(k) > 1)
+				expandDiagonal(d);
+
+			Element & x = _data[_start[d]+i-first(k)];
+			if (field().isZero(x) && !field().isZero(e))
+				++_nbnz ;
+			else if (!field().isZero(x) && field().isZero(e))
+				--_nbnz ;
+			field().assign(x,e);
+			return e ;
+		}
+
+		void appendEntry(const size_t &i, const size_t &j, const Element& e)
+		{
+			setEntry(i,j,e);
+		}
+
+		void clearEntry(const size_t &i, const size_t &j)
+		{
+			setEntry(i,j,field().zero);
+		}
+
+		/** make matrix ready to use after a sequence of setEntry calls.
+		 * Zero diagonals are removed, constant ones are kept as one value.
+		 */
+		void finalize()
+		{
+			std::vector<ptrdiff_t> offset ;
+			std::vector<size_t> start(1,0) ;
+			std::vector<Element> data ;
+			for (size_t d = 0 ; d < _offset.size() ; ++d) {
+				const Element * beg = &_data[_start[d]] ;
+				const Element * end = &_data[0]+_start[d+1] ;
+				bool cst = true ;
+				for (const Element * p = beg+1 ; cst && p < end ; ++p)
+					cst = field().areEqual(*p, *beg);
+				if (cst && field().isZero(*beg))
+					continue ;
+				offset.push_back(_offset[d]);
+				if (cst)
+					data.push_back(*beg);
+				else
+					data.insert(data.end(), beg, end);
+				start.push_back(data.size());
+			}
+			_offset.swap(offset);
+			_start.swap(start);
+			_data.swap(data);
+			_triples.reset();
+			_partition.clear();
+			_tpartition.clear();
+		}
+
+		const Element & getEntry(const size_t &i, const size_t &j) const
+		{
+			linbox_check(i<_rownb);
+			linbox_check(j<_colnb);
+			const ptrdiff_t k = (ptrdiff_t)j-(ptrdiff_t)i ;
+			size_t d = (size_t)(std::lower_bound(_offset.begin(),_offset.end(),k)-_offset.begin());
+			if (d == _offset.size() || _offset[d] != k)
+				return field().zero ;
+			return value(d,i) ;
+		}
+
+		Element      &getEntry (Element &x, size_t i, size_t j) const
+		{
+			return x = getEntry (i, j);
+		}
+
+		void firstTriple() const
+		{
+			_triples.reset();
+		}
+
+		/// entries diagonal by diagonal.
+		bool nextTriple(size_t & i, size_t &j, Element &e) const
+		{
+			for (;;) {
+				if (_triples._diag >= _offset.size()) {
+					_triples.reset();
+					return false ;
+				}
+				const ptrdiff_t k = _offset[_triples._diag] ;
+				i = first(k) + _triples._pos ;
+				if (i >= last(k)) {
+					++_triples._diag ;
+					_triples._pos = 0 ;
+					continue ;
+				}
+				++_triples._pos ;
+				e = value(_triples._diag, i) ;
+				if (field().isZero(e))
+					continue ;
+				j = (size_t)((ptrdiff_t)i+k) ;
+				return true ;
+			}
+		}
+
+		/** Write a matrix to the given output stream using field read/write.
+		 * @param os Output stream to which to write the matrix
+		 * @param format Format with which to write
+		 */
+		std::ostream & write(std::ostream &os
+				     , Tag::FileFormat format  = Tag::FileFormat::MatrixMarket) const
+		{
+			return SparseMatrixWriteHelper<Self_t>::write(*this,os,format);
+		}
+
+		/** Read a matrix from the given input stream using field read/write
+		 * @param is Input stream from which to read the matrix
+		 * @param format Format of input matrix
+		 * @return ref to \p is.
+		 */
+		std::istream& read (std::istream &is
+				    , Tag::FileFormat format = Tag::FileFormat::Detect)
+		{
+			return SparseMatrixReadHelper<Self_t>::read(*this,is,format);
+		}
+
+		// y= Ax
+		// y[i] = sum_d A(i,i+k_d) x[i+k_d]
+		template<class outVector, class inVector>
+		outVector& apply(outVector &y, const inVector& x ) const
+		{
+			linbox_check(y.size() == rowdim() && x.size() == coldim());
+			const size_t nd = _offset.size() ;
+			const RowPartition::Blocks part = _partition.update(_rownb, _rownb*nd,
+								      [nd](size_t) { return nd; });
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static,1) if(part.blocks() > 1)
+#endif
+			for (size_t b = 0 ; b < part.blocks() ; ++b) {
+				FieldAXPY<Field> accu(field());
+				for (size_t i = part.begin(b) ; i < part.end(b) ; ++i) {
+					accu.reset();
+					for (size_t d = 0 ; d < nd ; ++d) {
+						const ptrdiff_t j = (ptrdiff_t)i + _offset[d] ;
+						if (j < 0 || j >= (ptrdiff_t)_colnb)
+							continue ;
+						accu.mulacc(value(d,i), x[(size_t)j]);
+					}
+					accu.get(y[i]);
+				}
+			}
+			return y;
+		}
+
+		// y= A^t x
+		// y[j] = sum_d A(j-k_d,j) x[j-k_d] : also a gather, column by column.
+		template<class outVector, class inVector>
+		outVector& applyTranspose(outVector &y, const inVector& x ) const
+		{
+			linbox_check(y.size() == coldim() && x.size() == rowdim());
+			const size_t nd = _offset.size() ;
+			const RowPartition::Blocks part = _tpartition.update(_colnb, _colnb*nd,
+								       [nd](size_t) { return nd; });
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static,1) if(part.blocks() > 1)
+#endif
+			for (size_t b = 0 ; b < part.blocks() ; ++b) {
+				FieldAXPY<Field> accu(field());
+				for (size_t j = part.begin(b) ; j < part.end(b) ; ++j) {
+					accu.reset();
+					for (size_t d = 0 ; d < nd ; ++d) {
+						const ptrdiff_t i = (ptrdiff_t)j - _offset[d] ;
+						if (i < 0 || i >= (ptrdiff_t)_rownb)
+							continue ;
+						accu.mulacc(value(d,(size_t)i), x[(size_t)i]);
+					}
+					accu.get(y[j]);
+				}
+			}
+			return y;
+		}
+
+		/// Y <- A X.
+		template<class Mat1, class Mat2>
+		Mat1 & applyLeft(Mat1 &Y, const Mat2 &X) const
+		{
+			return applyLeftByTriples(MatrixDomain<Field>(field()), Y, *this, X);
+		}
+
+		/// Y <- X A.
+		template<class Mat1, class Mat2>
+		Mat1 & applyRight(Mat1 &Y, const Mat2 &X) const
+		{
+			return applyRightByTriples(MatrixDomain<Field>(field()), Y, *this, X);
+		}
+
+	private :
+		/// first row of diagonal \p k.
+		size_t first(const ptrdiff_t & k) const
+		{
+			return (k < 0) ? (size_t)(-k) : 0 ;
+		}
+
+		/// one past the last row of diagonal \p k.
+		size_t last(const ptrdiff_t & k) const
+		{
+			return std::min(_rownb, (size_t)((ptrdiff_t)_colnb - k)) ;
+		}
+
+		size_t length(const ptrdiff_t & k) const
+		{
+			return last(k) - first(k) ;
+		}
+
+		/// entry of row \p i on the \p d-th stored diagonal.
+		const Element & value(const size_t & d, const size_t & i) const
+		{
+			return isConstant(d) ? _data[_start[d]] : _data[_start[d]+i-first(_offset[d])] ;
+		}
+
+		void insertDiagonal(const size_t & d, const ptrdiff_t & k)
+		{
+			const size_t l = length(k) ;
+			_offset.insert(_offset.begin()+(ptrdiff_t)d, k);
+			_data.insert(_data.begin()+(ptrdiff_t)_start[d], l, field().zero);
+			_start.insert(_start.begin()+(ptrdiff_t)d+1, _start[d]+l);
+			for (size_t f = d+2 ; f < _start.size() ; ++f)
+				_start[f] += l ;
+			_partition.clear();
+			_tpartition.clear();
+		}
+
+		/// stores densely the constant \p d-th diagonal.
+		void expandDiagonal(const size_t & d)
+		{
+			const size_t l = length(_offset[d]) ;
+			const Element v = _data[_start[d]] ;
+			_data.insert(_data.begin()+(ptrdiff_t)_start[d], l-1, v);
+			for (size_t f = d+1 ; f < _start.size() ; ++f)
+				_start[f] += l-1 ;
+		}
+
+	protected :
+		friend class SparseMatrixWriteHelper<Self_t >;
+		friend class SparseMatrixReadHelper<Self_t >;
+
+		size_t              _rownb ;
+		size_t              _colnb ;
+		size_t               _nbnz ;
+
+		std::vector<ptrdiff_t> _offset ; //!< offsets of the diagonals, increasing
+		std::vector<size_t>    _start ;  //!< diagonal \p d is <code>_data[_start[d].._start[d+1]]</code>
+		std::vector<Element>   _data ;
+
+		const _Field & _field;
+
+		mutable RowPartition _partition ;
+		mutable RowPartition _tpartition ; //!< columns, for applyTranspose
+
+		mutable struct _triples {
+			size_t _diag ;
+			size_t _pos ;
+			_triples() :
+				_diag(0)
+				, _pos(0)
+			{}
+
+			void reset()
+			{
+				_diag = 0 ;
+				_pos = 0 ;
+			}
+		}_triples;
+	};
+
+	template<class Field>
+	struct is_blockbb<SparseMatrix<Field,SparseMatrixFormat::DIA> > {
+		static const bool value = true;
+	};
+
+} // LinBox
+
+#endif // __LINBOX_matrix_sparsematrix_sparse_dia_matrix_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
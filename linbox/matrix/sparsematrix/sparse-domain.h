@@ -31,9 +31,19 @@
 #ifndef __LINBOX_matrix_sparsematrix_sparse_domain_H
 #define __LINBOX_matrix_sparsematrix_sparse_domain_H
 
+#include <vector>
+#include <memory>
 #include "linbox/linbox-config.h"
 #include "linbox/util/debug.h"
 
+#ifdef __LINBOX_USE_OPENMP
+#include <omp.h>
+#endif
+
+#ifndef LINBOX_SPMV_PARALLEL
+#define LINBOX_SPMV_PARALLEL 10000
+#endif
+
 namespace LinBox {
 
 	/// y <- ay.  @todo Vector knows Field
@@ -57,6 +67,217 @@ namespace LinBox {
 		return y ;
 	}
 
+	/** Y <- A X, for a sparse \p A walked through firstTriple/nextTriple.
+	 * @param MD matrix domain over the field of \p A.
+	 */
+	template<class Domain, class SpMat, class Mat1, class Mat2>
+	Mat1 & applyLeftByTriples(const Domain & MD, Mat1 & Y, const SpMat & A, const Mat2 & X)
+	{
+		linbox_check(Y.rowdim() == A.rowdim() && X.rowdim() == A.coldim());
+		Y.zero();
+		size_t i, j ;
+		typename SpMat::Element e ;
+		A.firstTriple();
+		while (A.nextTriple(i,j,e)) {
+			typename Mat1::subMatrixType Yi(Y,i,0,1,Y.coldim());
+			typename Mat2::constSubMatrixType Xj(X,j,0,1,X.coldim());
+			MD.saxpyin(Yi, e, Xj);
+		}
+		A.firstTriple();
+		return Y ;
+	}
+
+	/** Y <- X A, for a sparse \p A walked through firstTriple/nextTriple.
+	 * @param MD matrix domain over the field of \p A.
+	 */
+	template<class Domain, class SpMat, class Mat1, class Mat2>
+	Mat1 & applyRightByTriples(const Domain & MD, Mat1 & Y, const SpMat & A, const Mat2 & X)
+	{
+		linbox_check(Y.coldim() == A.coldim() && X.coldim() == A.rowdim());
+		Y.zero();
+		size_t i, j ;
+		typename SpMat::Element e ;
+		A.firstTriple();
+		while (A.nextTriple(i,j,e)) {
+			typename Mat1::subMatrixType Yj(Y,0,j,Y.rowdim(),1);
+			typename Mat2::constSubMatrixType Xi(X,0,i,X.rowdim(),1);
+			MD.saxpyin(Yj, e, Xi);
+		}
+		A.firstTriple();
+		return Y ;
+	}
+
+	/** Rows of a sparse matrix split in contiguous blocks of about the same
+	 * number of nonzero entries, one per thread.
+	 *
+	 * Computed on the first parallel apply, and kept by the matrix; it is
+	 * recomputed when the dimension, the number of nonzero entries or the
+	 * number of threads change (or after \c clear()).
+	 * A stale partition (same counts, but entries moved from a row to
+	 * another) is still correct, only less balanced.
+	 *
+	 * Applies may run concurrently : \c update() returns a snapshot of the
+	 * blocks, and a new partition is built aside and then published by an
+	 * atomic store, so that a snapshot is never changed or freed under its
+	 * reader. A serial apply (one thread, or inside a parallel region) gets
+	 * a single block and leaves the cached partition alone.
+	 */
+	class RowPartition {
+		struct Cache {
+			std::vector<size_t> bounds ; //!< block \p b is rows <code>[bounds[b], bounds[b+1])</code>
+			size_t rows ;
+			size_t nnz ;
+			size_t threads ;
+		};
+		std::shared_ptr<const Cache> _cache ;
+	public :
+
+		/// The blocks of a partition, valid as long as the object lives.
+		class Blocks {
+			std::shared_ptr<const Cache> _cache ; //!< null for a single block
+			size_t _rows ;
+			friend class RowPartition ;
+			Blocks(const std::shared_ptr<const Cache> & c, size_t rows) :
+				_cache(c), _rows(rows)
+			{}
+		public :
+			size_t blocks() const
+			{
+				return _cache ? _cache->bounds.size()-1 : 1 ;
+			}
+
+			size_t begin(size_t b) const
+			{
+				return _cache ? _cache->bounds[b] : 0 ;
+			}
+
+			size_t end(size_t b) const
+			{
+				return _cache ? _cache->bounds[b+1] : _rows ;
+			}
+		};
+
+		RowPartition() :
+			_cache()
+		{}
+
+		/// number of threads an SpMV on \p nnz entries should use.
+		static size_t threads(size_t nnz)
+		{
+#ifdef __LINBOX_USE_OPENMP
+			if (nnz >= LINBOX_SPMV_PARALLEL && !omp_in_parallel())
+				return (size_t)omp_get_max_threads();
+#endif
+			return 1;
+		}
+
+		/// drops the cached partition; not to be called during an apply.
+		void clear()
+		{
+			_cache.reset();
+		}
+
+		/** Partition of \p rows rows, \p nnz entries.
+		 * @param rowsize functor, <code>rowsize(i)</code> is the number of entries in row \p i.
+		 */
+		template<class RowSize>
+		Blocks update(size_t rows, size_t nnz, const RowSize & rowsize)
+		{
+			const size_t t = threads(nnz);
+			if (t <= 1)
+				return Blocks(std::shared_ptr<const Cache>(), rows);
+			std::shared_ptr<const Cache> c = std::atomic_load(&_cache);
+			if (c && rows == c->rows && nnz == c->nnz && t == c->threads)
+				return Blocks(c, rows);
+
+			std::shared_ptr<Cache> p = std::make_shared<Cache>();
+			p->rows = rows ;
+			p->nnz = nnz ;
+			p->threads = t ;
+			p->bounds.assign(1,0);
+			// an empty row still costs its output entry
+			const size_t total = nnz + rows ;
+			size_t acc = 0 ;
+			for (size_t i = 0 ; i < rows && p->bounds.size() < t ; ++i) {
+				acc += rowsize(i) + 1 ;
+				if (acc * t >= total * p->bounds.size())
+					p->bounds.push_back(i+1);
+			}
+			if (p->bounds.back() != rows)
+				p->bounds.push_back(rows);
+			c = p ;
+			// two threads may build the same partition, the last one is kept
+			std::atomic_store(&_cache, c);
+			return Blocks(c, rows);
+		}
+	};
+
+	/** Transpose of a sparse matrix, kept by the matrix for its
+	 * \c applyTranspose : it is then an apply of the transpose, parallel
+	 * over its rows and without allocation, instead of a scatter of the
+	 * rows of the matrix into one accumulator per column.
+	 *
+	 * Built on the first \c applyTranspose and published like the
+	 * \ref RowPartition, so that concurrent applies may share it. The
+	 * matrix drops it (\c clear()) when it is modified. Without a call to
+	 * \c policy(), it is kept for matrices of more than \p threshold entries.
+	 */
+	template<class Matrix>
+	class TransposeCache {
+		std::shared_ptr<const Matrix> _AT ;
+		int _policy ; //!< 1 always, -1 never, 0 above the threshold
+		size_t _threshold ;
+	public :
+		TransposeCache(size_t threshold = 0) :
+			_AT(), _policy(0), _threshold(threshold)
+		{}
+
+		/// a copy of a matrix shares the transpose until either is modified.
+		TransposeCache(const TransposeCache & T) :
+			_AT(std::atomic_load(&T._AT)), _policy(T._policy), _threshold(T._threshold)
+		{}
+
+		TransposeCache & operator= (const TransposeCache & T)
+		{
+			std::atomic_store(&_AT, std::atomic_load(&T._AT));
+			_policy = T._policy ;
+			_threshold = T._threshold ;
+			return *this ;
+		}
+
+		/// drops the transpose; not to be called during an apply.
+		void clear()
+		{
+			_AT.reset();
+		}
+
+		/// \c true to always keep the transpose, \c false to never keep it.
+		void policy(bool on)
+		{
+			clear();
+			_policy = on ? 1 : -1 ;
+		}
+
+		/** The transpose of a matrix of \p nnz entries, built by
+		 * <code>build()</code> (which returns a new matrix) if there is
+		 * none yet; null if it is not kept.
+		 * Threads building it at the same time keep the first one.
+		 */
+		template<class Build>
+		std::shared_ptr<const Matrix> get(size_t nnz, const Build & build)
+		{
+			if (_policy < 0 || (_policy == 0 && nnz <= _threshold))
+				return std::shared_ptr<const Matrix>();
+			std::shared_ptr<const Matrix> c = std::atomic_load(&_AT);
+			if (c)
+				return c ;
+			std::shared_ptr<const Matrix> p(build());
+			if (std::atomic_compare_exchange_strong(&_AT, &c, p))
+				return p ;
+			return c ;
+		}
+	};
+
 } // LinBox
 
 #endif // __LINBOX_matrix_sparsematrix_sparse_domain_H
@@ -39,7 +39,9 @@
 #include "linbox/linbox-config.h"
 #include "linbox/util/debug.h"
 #include "linbox/field/hom.h"
+#include "linbox/blackbox/blockbb.h"
 #include "sparse-domain.h"
+#include "sparse-row-dot.h"
 
 #ifndef LINBOX_ELL_TRANSPOSE
 #define LINBOX_ELL_TRANSPOSE 1000
@@ -504,7 +506,7 @@ namespace LinBox
 		{
 			ptrdiff_t off = _triples.next(_maxc);
 			size_t ii = i ;
-			while ( field().isZero(_data[ii*_maxc+off]) )  {
+			while ( ii < _rownb && field().isZero(_data[ii*_maxc+off]) )  {
 				_triples._off = off = 0;
 				_triples._row = ii  = ii+1 ;
 			}
@@ -592,6 +594,7 @@ namespace LinBox
 		void finalize(){
 			// could check that maxc is not too large and shrink ? Is is optimize job ?
 			_triples.reset();
+			_partition.clear();
 		} // end construction after a sequence of setEntry calls.
 
 		/** Set an individual entry.
@@ -772,22 +775,79 @@ namespace LinBox
 			prepare(field(),y,a);
 
 
-			FieldAXPY<Field> accu(field());
-			for (size_t i = 0 ; i < _rownb ; ++i) {
-				accu.reset();
-				for (size_t k = 0   ; k < _maxc ; ++k)
-					if (!field().isZero(getData(i,k)))
-						// field().axpyin( y[i], getData(i,k), x[getColid(i,k)] ); //! @todo delay !!!
-						accu.mulacc( getData(i,k), x[getColid(i,k)] );
-					else {
-						break;
-					}
-				accu.get(y[i]);
+			const RowPartition::Blocks part = partition();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static,1) if(part.blocks() > 1)
+#endif
+			for (size_t b = 0 ; b < part.blocks() ; ++b) {
+				FieldAXPY<Field> accu(field());
+				const SparseRowDot<Field> dot(field());
+				for (size_t i = part.begin(b) ; i < part.end(b) ; ++i) {
+					accu.reset();
+					// the row ends at the first zero
+					size_t len = 0 ;
+					while (len < _maxc && !field().isZero(_data[i*_maxc+len]))
+						++len ;
+					dot.mulacc(accu, _data.data()+i*_maxc, _colid.data()+i*_maxc,
+					    len, x);
+					accu.get(y[i]);
+				}
 			}
 
 			return y;
 		}
 
+		/// rows split in blocks for the (parallel) apply ; every row is \p _maxc long here.
+		RowPartition::Blocks partition() const
+		{
+			const size_t maxc = _maxc ;
+			return _partition.update(_rownb, _rownb*_maxc,
+						 [maxc](size_t) { return maxc; });
+		}
+
+		/** Y <- A X, for dense row-major blocks.
+		 * Each entry of \p A is read once for all the columns of \p X.
+		 */
+		template<class Mat1, class Mat2>
+		Mat1 & applyLeft(Mat1 &Y, const Mat2 &X) const
+		{
+			linbox_check(Y.rowdim() == rowdim() && X.rowdim() == coldim() && Y.coldim() == X.coldim());
+			const RowPartition::Blocks part = partition();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static,1) if(part.blocks() > 1)
+#endif
+			for (size_t b = 0 ; b < part.blocks() ; ++b) {
+				SparseRowBlock<Field> row(field(), X.coldim());
+				for (size_t i = part.begin(b) ; i < part.end(b) ; ++i) {
+					size_t len = 0 ;
+					while (len < _maxc && !field().isZero(_data[i*_maxc+len]))
+						++len ;
+					row.mul(Y.getPointer()+i*Y.getStride(), _data.data()+i*_maxc, _colid.data()+i*_maxc,
+						len, X.getPointer(), X.getStride());
+				}
+			}
+			return Y;
+		}
+
+		/** Y <- X A, for dense row-major blocks.
+		 * Each entry of \p A is read once for all the rows of \p X.
+		 */
+		template<class Mat1, class Mat2>
+		Mat1 & applyRight(Mat1 &Y, const Mat2 &X) const
+		{
+			linbox_check(Y.coldim() == coldim() && X.coldim() == rowdim() && Y.rowdim() == X.rowdim());
+			SparseColBlock<Field> col(field(), coldim(), X.rowdim());
+			for (size_t i = 0 ; i < rowdim() ; ++i) {
+				size_t len = 0 ;
+				while (len < _maxc && !field().isZero(_data[i*_maxc+len]))
+					++len ;
+				col.mulacc(_data.data()+i*_maxc, _colid.data()+i*_maxc, len,
+					   X.getPointer(), X.getStride(), i);
+			}
+			col.get(Y.getPointer(), Y.getStride());
+			return Y;
+		}
+
 
 		// y= A^t x
 		// y[i] = sum(A(j,i) x(j)
@@ -1443,6 +1503,7 @@ namespace LinBox
 		const _Field            & _field;
 
 		mutable Helper _helper ;
+		mutable RowPartition _partition ;
 
 		mutable struct _triples {
 			ptrdiff_t _row ;
@@ -1474,6 +1535,11 @@ namespace LinBox
 		}_triples;
 	};
 
+	template<class Field>
+	struct is_blockbb<SparseMatrix<Field,SparseMatrixFormat::ELL> > {
+		static const bool value = true;
+	};
+
 
 
 
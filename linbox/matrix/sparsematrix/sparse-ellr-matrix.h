@@ -39,7 +39,9 @@
 #include "linbox/linbox-config.h"
 #include "linbox/util/debug.h"
 #include "linbox/field/hom.h"
+#include "linbox/blackbox/blockbb.h"
 #include "sparse-domain.h"
+#include "sparse-row-dot.h"
 
 #ifndef LINBOX_ELLR_TRANSPOSE
 #define LINBOX_ELLR_TRANSPOSE 1000
@@ -531,10 +533,7 @@ namespace LinBox
 
 				const size_t * beg = &_colid[i*_maxc];
 				const Element * dat = &_data[i*_maxc];
-				for (size_t k = 0 ; k < _maxc ; ++k) {
-					if ( field().isZero(dat[k])) {
-						return field().zero;
-					}
+				for (size_t k = 0 ; k < _rowid[i] ; ++k) {
 					// replace
 					if (beg[k] == j) {
 						_triples._off = k;
@@ -604,6 +603,7 @@ namespace LinBox
 		void finalize(){
 			// could check that maxc is not too large and shrink ? Is is optimize job ?
 			_triples.reset();
+			_partition.clear();
 		} // end construction after a sequence of setEntry calls.
 
 		/** Set an individual entry.
@@ -780,30 +780,81 @@ namespace LinBox
 
 		// y= Ax
 		// y[i] = sum(A(i,j) x(j)
-		template<class Vector>
-		Vector& apply(Vector &y, const Vector& x, const Element & a ) const
+		template<class outVector, class inVector>
+		outVector& apply(outVector &y, const inVector& x, const Element & a ) const
 		{
 			// linbox_check(consistent());
 			prepare(field(),y,a);
 
 
-			FieldAXPY<Field> accu(field());
-			for (size_t i = 0 ; i < _rownb ; ++i) {
-				accu.reset();
-				for (size_t k = 0   ; k < _rowid[i] ; ++k)
-					// field().axpyin( y[i], getData(i,k), x[getColid(i,k)] ); //! @todo delay !!!
-					accu.mulacc( getData(i,k), x[getColid(i,k)] );
-				accu.get(y[i]);
+			const RowPartition::Blocks part = partition();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static,1) if(part.blocks() > 1)
+#endif
+			for (size_t b = 0 ; b < part.blocks() ; ++b) {
+				FieldAXPY<Field> accu(field());
+				const SparseRowDot<Field> dot(field());
+				for (size_t i = part.begin(b) ; i < part.end(b) ; ++i) {
+					accu.reset();
+					dot.mulacc(accu, _data.data()+i*_maxc, _colid.data()+i*_maxc,
+					    _rowid[i], x);
+					accu.get(y[i]);
+				}
 			}
 
 			return y;
 		}
 
+		/// rows split by number of entries, for the (parallel) apply.
+		RowPartition::Blocks partition() const
+		{
+			const std::vector<size_t> & rowid = _rowid ;
+			return _partition.update(_rownb, _nbnz,
+						 [&rowid](size_t i) { return rowid[i]; });
+		}
+
+		/** Y <- A X, for dense row-major blocks.
+		 * Each entry of \p A is read once for all the columns of \p X.
+		 */
+		template<class Mat1, class Mat2>
+		Mat1 & applyLeft(Mat1 &Y, const Mat2 &X) const
+		{
+			linbox_check(Y.rowdim() == rowdim() && X.rowdim() == coldim() && Y.coldim() == X.coldim());
+			const RowPartition::Blocks part = partition();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static,1) if(part.blocks() > 1)
+#endif
+			for (size_t b = 0 ; b < part.blocks() ; ++b) {
+				SparseRowBlock<Field> row(field(), X.coldim());
+				for (size_t i = part.begin(b) ; i < part.end(b) ; ++i) {
+					row.mul(Y.getPointer()+i*Y.getStride(), _data.data()+i*_maxc, _colid.data()+i*_maxc,
+						_rowid[i], X.getPointer(), X.getStride());
+				}
+			}
+			return Y;
+		}
+
+		/** Y <- X A, for dense row-major blocks.
+		 * Each entry of \p A is read once for all the rows of \p X.
+		 */
+		template<class Mat1, class Mat2>
+		Mat1 & applyRight(Mat1 &Y, const Mat2 &X) const
+		{
+			linbox_check(Y.coldim() == coldim() && X.coldim() == rowdim() && Y.rowdim() == X.rowdim());
+			SparseColBlock<Field> col(field(), coldim(), X.rowdim());
+			for (size_t i = 0 ; i < rowdim() ; ++i) {
+				col.mulacc(_data.data()+i*_maxc, _colid.data()+i*_maxc, _rowid[i],
+					   X.getPointer(), X.getStride(), i);
+			}
+			col.get(Y.getPointer(), Y.getStride());
+			return Y;
+		}
+
 
 		// y= A^t x
 		// y[i] = sum(A(j,i) x(j)
-		template<class Vector>
-		Vector& applyTranspose(Vector &y, const Vector& x, const Element & a ) const
+		template<class outVector, class inVector>
+		outVector& applyTranspose(outVector &y, const inVector& x, const Element & a ) const
 		{
 			// linbox_check(consistent());
 			if (_helper.optimized(*this)) {
@@ -1495,6 +1546,7 @@ namespace LinBox
 		const _Field            & _field;
 
 		mutable Helper _helper ;
+		mutable RowPartition _partition ;
 
 		mutable struct _triples {
 			ptrdiff_t _row ;
@@ -1510,11 +1562,9 @@ namespace LinBox
 				if (_row == -1) {
 					++_row ;
 				}
-				while (_off >= (ptrdiff_t)rowid[(size_t)_row]) {
+				while (_row < (ptrdiff_t)rowid.size() && _off >= (ptrdiff_t)rowid[(size_t)_row]) {
 					_row += 1 ;
 					_off = 0 ;
-					if (_row >= (ptrdiff_t)rowid.size())
-						break;
 				}
 				return _off;
 			}
@@ -1527,6 +1577,11 @@ namespace LinBox
 		}_triples;
 	};
 
+	template<class Field>
+	struct is_blockbb<SparseMatrix<Field,SparseMatrixFormat::ELL_R> > {
+		static const bool value = true;
+	};
+
 
 
 
@@ -0,0 +1,430 @@
+/* linbox/matrix/sparsematrix/sparse-lil-matrix.h
+ * Copyright (C) 2013 the LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file matrix/sparsematrix/sparse-lil-matrix.h
+ * @ingroup sparsematrix
+ * @brief
+ * A <code>SparseMatrix<_Field, SparseMatrixFormat::LIL ></code>
+ * is a vector of rows, each a vector of (column, value) pairs sorted by column.
+ *
+ * Entries can be set in any order at any time, which makes it a building
+ * format ; the applies are row by row as in CSR.
+ */
+
+
+#ifndef __LINBOX_matrix_sparsematrix_sparse_lil_matrix_H
+#define __LINBOX_matrix_sparsematrix_sparse_lil_matrix_H
+
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <memory>
+
+#include "linbox/linbox-config.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/field-axpy.h"
+#include "linbox/field/hom.h"
+#include "linbox/matrix/matrix-domain.h"
+#include "linbox/blackbox/blockbb.h"
+#include "sparse-domain.h"
+
+namespace LinBox
+{
+
+	/** Sparse matrix, List of lists storage.
+	 *
+	 * \ingroup matrix
+	 * \ingroup sparse
+	 */
+	template<class _Field>
+	class SparseMatrix<_Field, SparseMatrixFormat::LIL > {
+	public :
+		typedef _Field                             Field ; //!< Field
+		typedef typename _Field::Element         Element ; //!< Element
+		typedef SparseMatrixFormat::LIL          Storage ; //!< Matrix Storage Format
+		typedef SparseMatrix<_Field,Storage>      Self_t ; //!< Self type
+		typedef std::vector<std::pair<size_t, Element> > Row ; //!< a row, sorted by column
+
+		/*! Constructors.
+		 */
+		//@{
+		SparseMatrix<_Field, SparseMatrixFormat::LIL> (const _Field & F, size_t m = 0, size_t n = 0) :
+			_rownb(m),_colnb(n)
+			,_nbnz(0)
+			,_rows(m)
+			,_field(F)
+		{}
+
+		SparseMatrix<_Field, SparseMatrixFormat::LIL> (const SparseMatrix<_Field, SparseMatrixFormat::LIL> & S) :
+			_rownb(S._rownb),_colnb(S._colnb)
+			,_nbnz(S._nbnz)
+			,_rows(S._rows)
+			,_field(S._field)
+		{}
+
+		SparseMatrix<_Field, SparseMatrixFormat::LIL> ( MatrixStream<Field>& ms ):
+			_rownb(0),_colnb(0)
+			,_nbnz(0)
+			,_rows(0)
+			,_field(ms.field())
+		{
+			size_t m, n ;
+			if( !ms.getDimensions( m, n ) )
+				throw ms.reportError(__func__,__LINE__);
+			resize(m,n);
+			Element val;
+			size_t i, j;
+			while( ms.nextTriple(i,j,val) )
+				appendEntry(i,j,val);
+			if( ms.getError() > END_OF_MATRIX )
+				throw ms.reportError(__func__,__LINE__);
+			finalize();
+		}
+
+		template<typename _Tp1, typename _Rw1 = SparseMatrixFormat::LIL>
+		struct rebind {
+			typedef SparseMatrix<_Tp1, _Rw1> other;
+
+			void operator() (other & Ap, const Self_t& A)
+			{
+				typename _Tp1::Element e;
+				Hom<typename Self_t::Field, _Tp1> hom(A.field(), Ap.field());
+				Ap.resize(A.rowdim(), A.coldim());
+				for (size_t i = 0 ; i < A.rowdim() ; ++i)
+					for (size_t k = 0 ; k < A.getRow(i).size() ; ++k) {
+						hom. image ( e, A.getRow(i)[k].second );
+						if (! Ap.field().isZero(e) )
+							Ap.appendEntry(i,A.getRow(i)[k].first,e);
+					}
+				Ap.finalize();
+			}
+		};
+
+		template<typename _Tp1, typename _Rw1>
+		SparseMatrix (const SparseMatrix<_Tp1, _Rw1> &S, const Field& F) :
+			_rownb(S.rowdim()),_colnb(S.coldim())
+			,_nbnz(0)
+			,_rows(S.rowdim())
+			,_field(F)
+		{
+			typename SparseMatrix<_Tp1,_Rw1>::template rebind<Field,Storage>()(*this, S);
+			finalize();
+		}
+		//@}
+
+		void resize(const size_t & mm, const size_t & nn, const size_t & = 0)
+		{
+			_rownb = mm ;
+			_colnb = nn ;
+			_rows.resize(mm);
+			_nbnz = 0 ;
+			for (size_t i = 0 ; i < mm ; ++i) {
+				while (!_rows[i].empty() && _rows[i].back().first >= nn)
+					_rows[i].pop_back();
+				_nbnz += _rows[i].size();
+			}
+			modified();
+		}
+
+		size_t rowdim() const
+		{
+			return _rownb ;
+		}
+
+		size_t coldim() const
+		{
+			return _colnb ;
+		}
+
+		/// number of non zero entries.
+		size_t size() const
+		{
+			return _nbnz ;
+		}
+
+		const Field & field()  const
+		{
+			return _field ;
+		}
+
+		const Row & getRow(const size_t & i) const
+		{
+			return _rows[i];
+		}
+
+		/** Set an individual entry.
+		 * Setting the entry to 0 removes it from the matrix.
+		 */
+		const Element& setEntry(const size_t &i, const size_t &j, const Element& e)
+		{
+			linbox_check(i<_rownb);
+			linbox_check(j<_colnb);
+			Row & row = _rows[i] ;
+			typename Row::iterator low = lower(row,j);
+			if (low != row.end() && low->first == j) {
+				if (field().isZero(e)) {
+					row.erase(low);
+					--_nbnz ;
+				}
+				else
+					field().assign(low->second,e);
+			}
+			else if (!field().isZero(e)) {
+				row.insert(low, std::make_pair(j,e));
+				++_nbnz ;
+			}
+			modified();
+			return e ;
+		}
+
+		/// same as setEntry, fast when \p j is larger than the columns already in row \p i.
+		void appendEntry(const size_t &i, const size_t &j, const Element& e)
+		{
+			if (_rows[i].empty() || _rows[i].back().first < j) {
+				if (field().isZero(e))
+					return ;
+				_rows[i].push_back(std::make_pair(j,e));
+				++_nbnz ;
+				modified();
+			}
+			else
+				setEntry(i,j,e);
+		}
+
+		void clearEntry(const size_t &i, const size_t &j)
+		{
+			setEntry(i,j,field().zero);
+		}
+
+		/// make matrix ready to use after a sequence of setEntry calls.
+		void finalize()
+		{
+			_triples.reset();
+			modified();
+		}
+
+		const Element & getEntry(const size_t &i, const size_t &j) const
+		{
+			linbox_check(i<_rownb);
+			linbox_check(j<_colnb);
+			const Row & row = _rows[i] ;
+			typename Row::const_iterator low = lower(row,j);
+			if (low != row.end() && low->first == j)
+				return low->second ;
+			return field().zero ;
+		}
+
+		Element      &getEntry (Element &x, size_t i, size_t j) const
+		{
+			return x = getEntry (i, j);
+		}
+
+		void firstTriple() const
+		{
+			_triples.reset();
+		}
+
+		bool nextTriple(size_t & i, size_t &j, Element &e) const
+		{
+			++_triples._off ;
+			while (_triples._row < _rownb && _triples._off >= _rows[_triples._row].size()) {
+				++_triples._row ;
+				_triples._off = 0 ;
+			}
+			if (_triples._row >= _rownb) {
+				_triples.reset();
+				return false ;
+			}
+			i = _triples._row ;
+			j = _rows[i][_triples._off].first ;
+			e = _rows[i][_triples._off].second ;
+			return true ;
+		}
+
+		/** Write a matrix to the given output stream using field read/write.
+		 * @param os Output stream to which to write the matrix
+		 * @param format Format with which to write
+		 */
+		std::ostream & write(std::ostream &os
+				     , Tag::FileFormat format  = Tag::FileFormat::MatrixMarket) const
+		{
+			return SparseMatrixWriteHelper<Self_t>::write(*this,os,format);
+		}
+
+		/** Read a matrix from the given input stream using field read/write
+		 * @param is Input stream from which to read the matrix
+		 * @param format Format of input matrix
+		 * @return ref to \p is.
+		 */
+		std::istream& read (std::istream &is
+				    , Tag::FileFormat format = Tag::FileFormat::Detect)
+		{
+			return SparseMatrixReadHelper<Self_t>::read(*this,is,format);
+		}
+
+		// y= Ax
+		template<class outVector, class inVector>
+		outVector& apply(outVector &y, const inVector& x ) const
+		{
+			linbox_check(y.size() == rowdim() && x.size() == coldim());
+			const RowPartition::Blocks part = partition();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static,1) if(part.blocks() > 1)
+#endif
+			for (size_t b = 0 ; b < part.blocks() ; ++b) {
+				FieldAXPY<Field> accu(field());
+				for (size_t i = part.begin(b) ; i < part.end(b) ; ++i) {
+					accu.reset();
+					const Row & row = _rows[i] ;
+					for (size_t k = 0 ; k < row.size() ; ++k)
+						accu.mulacc(row[k].second, x[row[k].first]);
+					accu.get(y[i]);
+				}
+			}
+			return y;
+		}
+
+		// y= A^t x
+		template<class outVector, class inVector>
+		outVector& applyTranspose(outVector &y, const inVector& x ) const
+		{
+			linbox_check(y.size() == coldim() && x.size() == rowdim());
+			const std::shared_ptr<const Self_t> T = _transpose.get(size(), [this]() { return transpose(); });
+			if (T)
+				return T->apply(y,x);
+
+			const FieldAXPY<Field> accu0(field());
+			std::vector<FieldAXPY<Field> > Y(_colnb, accu0);
+			for (size_t i = 0 ; i < _rownb ; ++i)
+				for (size_t k = 0 ; k < _rows[i].size() ; ++k)
+					Y[_rows[i][k].first].mulacc(_rows[i][k].second, x[i]);
+			for (size_t j = 0 ; j < _colnb ; ++j)
+				Y[j].get(y[j]);
+			return y;
+		}
+
+		/** Keep the transpose for \c applyTranspose, which is then a
+		 * parallel apply of it. It is built at the first
+		 * \c applyTranspose and dropped when the matrix is modified.
+		 * @param on \c false to never keep it, \c applyTranspose then
+		 * scatters the rows in one accumulator per column.
+		 */
+		void cacheTranspose(bool on = true)
+		{
+			_transpose.policy(on);
+		}
+
+		/// Y <- A X.
+		template<class Mat1, class Mat2>
+		Mat1 & applyLeft(Mat1 &Y, const Mat2 &X) const
+		{
+			return applyLeftByTriples(MatrixDomain<Field>(field()), Y, *this, X);
+		}
+
+		/// Y <- X A.
+		template<class Mat1, class Mat2>
+		Mat1 & applyRight(Mat1 &Y, const Mat2 &X) const
+		{
+			return applyRightByTriples(MatrixDomain<Field>(field()), Y, *this, X);
+		}
+
+		/// rows split by number of entries, for the (parallel) apply.
+		RowPartition::Blocks partition() const
+		{
+			const std::vector<Row> & rows = _rows ;
+			return _partition.update(_rownb, _nbnz,
+						 [&rows](size_t i) { return rows[i].size(); });
+		}
+
+	private :
+		/// drops what was computed from the entries (partition, transpose).
+		void modified()
+		{
+			_partition.clear();
+			_transpose.clear();
+		}
+
+		/// a new matrix, the transpose; its rows are filled in order.
+		Self_t * transpose() const
+		{
+			Self_t * T = new Self_t(field(), _colnb, _rownb);
+			for (size_t i = 0 ; i < _rownb ; ++i)
+				for (size_t k = 0 ; k < _rows[i].size() ; ++k)
+					T->appendEntry(_rows[i][k].first, i, _rows[i][k].second);
+			return T ;
+		}
+
+		template<class RowT>
+		static auto lower(RowT & row, size_t j) -> decltype(row.begin())
+		{
+			return std::lower_bound(row.begin(), row.end(), j,
+						[](const std::pair<size_t,Element> & p, size_t c) { return p.first < c; });
+		}
+
+	protected :
+		friend class SparseMatrixWriteHelper<Self_t >;
+		friend class SparseMatrixReadHelper<Self_t >;
+
+		size_t              _rownb ;
+		size_t              _colnb ;
+		size_t               _nbnz ;
+
+		std::vector<Row>     _rows ;
+
+		const _Field & _field;
+
+		mutable RowPartition _partition ;
+		mutable TransposeCache<Self_t> _transpose ;
+
+		mutable struct _triples {
+			size_t _row ;
+			size_t _off ;
+			_triples() :
+				_row(0)
+				, _off((size_t)-1)
+			{}
+
+			void reset()
+			{
+				_row = 0 ;
+				_off = (size_t)-1 ;
+			}
+		}_triples;
+	};
+
+	template<class Field>
+	struct is_blockbb<SparseMatrix<Field,SparseMatrixFormat::LIL> > {
+		static const bool value = true;
+	};
+
+} // LinBox
+
+#endif // __LINBOX_matrix_sparsematrix_sparse_lil_matrix_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
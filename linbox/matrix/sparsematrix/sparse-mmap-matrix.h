@@ -0,0 +1,660 @@
+/* linbox/matrix/sparsematrix/sparse-mmap-matrix.h
+ * Copyright (C) 2013 the LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file matrix/sparsematrix/sparse-mmap-matrix.h
+ * @ingroup sparsematrix
+ * @brief
+ * A <code>SparseMatrix<_Field, SparseMatrixFormat::MMAP ></code>
+ * is a read only CSR matrix in a memory mapped binary file.
+ *
+ * The file is written once by \c create(), from a MatrixStream (any text
+ * format it reads) or from another matrix ; opening it afterwards costs
+ * no parsing and no heap copy : the pages are read by the system when
+ * the applies stream through them.
+ *
+ * The file holds, in the byte order of the machine that wrote it :
+ * - a header : magic, version, rows, columns, entries, element size and
+ *   the offset of the values ;
+ * - the row starts, <code>rows+1</code> 64 bits integers ;
+ * - the column ids, one 64 bits integer per entry, sorted in each row ;
+ * - the values, as the \c Element of the field.
+ */
+
+
+#ifndef __LINBOX_matrix_sparsematrix_sparse_mmap_matrix_H
+#define __LINBOX_matrix_sparsematrix_sparse_mmap_matrix_H
+
+#include <utility>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "linbox/linbox-config.h"
+#include "linbox/util/debug.h"
+#include "linbox/util/field-axpy.h"
+#include "linbox/util/matrix-stream.h"
+#include "linbox/field/hom.h"
+#include "linbox/matrix/matrix-traits.h"
+#include "linbox/blackbox/blockbb.h"
+#include "sparse-domain.h"
+#include "sparse-row-dot.h"
+#include "sparse-csr-matrix.h"
+
+namespace LinBox
+{
+
+	namespace Protected {
+
+		/// a whole file mapped in memory, unmapped by the destructor.
+		class MappedFile {
+			void * _addr ;
+			size_t _bytes ;
+		public :
+			/// maps \p name read only.
+			MappedFile(const std::string & name) :
+				_addr(MAP_FAILED), _bytes(0)
+			{
+				int fd = ::open(name.c_str(), O_RDONLY);
+				if (fd == -1)
+					throw LinBoxError("cannot open " + name, __func__, __FILE__, __LINE__);
+				struct stat st ;
+				if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+					_bytes = (size_t)st.st_size ;
+					_addr = ::mmap(NULL, _bytes, PROT_READ, MAP_SHARED, fd, 0);
+				}
+				::close(fd);
+				if (_addr == MAP_FAILED)
+					throw LinBoxError("cannot map " + name, __func__, __FILE__, __LINE__);
+				// rows are streamed in order by the applies
+				::madvise(_addr, _bytes, MADV_SEQUENTIAL);
+			}
+
+			/// creates \p name, of \p bytes bytes, mapped read write.
+			MappedFile(const std::string & name, size_t bytes) :
+				_addr(MAP_FAILED), _bytes(bytes)
+			{
+				int fd = ::open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+				if (fd == -1)
+					throw LinBoxError("cannot create " + name, __func__, __FILE__, __LINE__);
+				if (::ftruncate(fd, (off_t)bytes) == 0)
+					_addr = ::mmap(NULL, _bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+				::close(fd);
+				if (_addr == MAP_FAILED)
+					throw LinBoxError("cannot map " + name, __func__, __FILE__, __LINE__);
+			}
+
+			~MappedFile()
+			{
+				if (_addr != MAP_FAILED)
+					::munmap(_addr, _bytes);
+			}
+
+			char * data() const
+			{
+				return static_cast<char*>(_addr);
+			}
+
+			size_t bytes() const
+			{
+				return _bytes ;
+			}
+
+		private :
+			MappedFile(const MappedFile &) ;
+			MappedFile & operator=(const MappedFile &) ;
+		};
+
+		/// removes the file \p name when it goes out of scope, thrown out of or not.
+		class TemporaryFile {
+			const std::string _name ;
+		public :
+			explicit TemporaryFile(const std::string & name) :
+				_name(name)
+			{}
+
+			~TemporaryFile()
+			{
+				std::remove(_name.c_str());
+			}
+
+			const std::string & name() const
+			{
+				return _name ;
+			}
+
+		private :
+			TemporaryFile(const TemporaryFile &) ;
+			TemporaryFile & operator=(const TemporaryFile &) ;
+		};
+
+		/// header of a SparseMatrixFormat::MMAP file.
+		struct MappedSparseHeader {
+			char     magic[8] ;
+			uint64_t version ;
+			uint64_t rows ;
+			uint64_t cols ;
+			uint64_t nnz ;
+			uint64_t eltsize ;
+			uint64_t data ;    //!< offset of the values
+		};
+
+	} // Protected
+
+	/** Sparse matrix, Compressed row storage in a memory mapped file.
+	 * Read only ; copies share the mapping.
+	 *
+	 * \ingroup matrix
+	 * \ingroup sparse
+	 */
+	template<class _Field>
+	class SparseMatrix<_Field, SparseMatrixFormat::MMAP > {
+	public :
+		typedef _Field                             Field ; //!< Field
+		typedef typename _Field::Element         Element ; //!< Element
+		typedef SparseMatrixFormat::MMAP         Storage ; //!< Matrix Storage Format
+		typedef SparseMatrix<_Field,Storage>      Self_t ; //!< Self type
+		typedef uint64_t                           Index ; //!< row starts and column ids, in the file
+		typedef Protected::MappedSparseHeader     Header ;
+
+		static_assert(std::is_trivially_copyable<Element>::value,
+			      "the elements are stored as they are in memory");
+
+		/*! Constructors.
+		 */
+		//@{
+		/// maps the file \p name, written by create().
+		SparseMatrix<_Field, SparseMatrixFormat::MMAP> (const _Field & F, const std::string & name) :
+			_file(std::make_shared<Protected::MappedFile>(name))
+			,_field(F)
+			,_transpose(LINBOX_CSR_TRANSPOSE)
+		{
+			const Header & h = *reinterpret_cast<const Header*>(_file->data()) ;
+			if (_file->bytes() < sizeof(Header)
+			    || std::memcmp(h.magic, magic(), sizeof(h.magic)) != 0
+			    || h.version != 1 || h.eltsize != sizeof(Element)
+			    || h.data < offset(h.rows, h.nnz) || _file->bytes() < h.data+h.nnz*sizeof(Element))
+				throw LinBoxError(name + " is not a sparse matrix over this field", __func__, __FILE__, __LINE__);
+			_rownb = (size_t)h.rows ;
+			_colnb = (size_t)h.cols ;
+			_nbnz  = (size_t)h.nnz ;
+			_start = reinterpret_cast<const Index*>(_file->data()+sizeof(Header)) ;
+			_colid = _start+_rownb+1 ;
+			_data  = reinterpret_cast<const Element*>(_file->data()+h.data) ;
+		}
+
+		SparseMatrix<_Field, SparseMatrixFormat::MMAP> (const SparseMatrix<_Field, SparseMatrixFormat::MMAP> & S) :
+			_rownb(S._rownb),_colnb(S._colnb)
+			,_nbnz(S._nbnz)
+			,_file(S._file)
+			,_start(S._start)
+			,_colid(S._colid)
+			,_data(S._data)
+			,_field(S._field)
+			,_transpose(S._transpose)
+		{}
+
+		/// the copy, over another field, is in memory (CSR by default).
+		template<typename _Tp1, typename _Rw1 = SparseMatrixFormat::CSR>
+		struct rebind {
+			typedef SparseMatrix<_Tp1, _Rw1> other;
+
+			void operator() (other & Ap, const Self_t& A)
+			{
+				typename _Tp1::Element e;
+				Hom<typename Self_t::Field, _Tp1> hom(A.field(), Ap.field());
+				Ap.resize(A.rowdim(), A.coldim());
+				size_t i, j ;
+				Element f ;
+				A.firstTriple();
+				while ( A.nextTriple(i,j,f) ) {
+					hom. image ( e, f) ;
+					if (! Ap.field().isZero(e) )
+						Ap.appendEntry(i,j,e);
+				}
+				A.firstTriple();
+				Ap.finalize();
+			}
+		};
+		//@}
+
+		/** Writes the file \p name from a matrix stream.
+		 * The triples go through a temporary file <code>name.tmp</code>,
+		 * then are put at their place in the mapped file : only two
+		 * integers per row are kept in memory.
+		 * Repeated entries : the last one read is kept, a zero removes the entry.
+		 */
+		static void create(const std::string & name, MatrixStream<Field> & ms)
+		{
+			size_t m, n ;
+			if( !ms.getDimensions( m, n ) )
+				throw ms.reportError(__func__,__LINE__);
+			StreamSource src(ms);
+			build(name, ms.field(), m, n, src);
+			if( ms.getError() > END_OF_MATRIX )
+				throw ms.reportError(__func__,__LINE__);
+		}
+
+		/// Writes the file \p name from the matrix \p A.
+		template<class Matrix>
+		static void create(const std::string & name, const Matrix & A)
+		{
+			createFrom(name, A, typename IndexedCategory<Matrix>::Tag());
+		}
+
+		size_t rowdim() const
+		{
+			return _rownb ;
+		}
+
+		size_t coldim() const
+		{
+			return _colnb ;
+		}
+
+		/// number of non zero entries.
+		size_t size() const
+		{
+			return _nbnz ;
+		}
+
+		const Field & field()  const
+		{
+			return _field ;
+		}
+
+		const Element & getEntry(const size_t &i, const size_t &j) const
+		{
+			linbox_check(i<_rownb);
+			linbox_check(j<_colnb);
+			const Index * beg = _colid+_start[i] ;
+			const Index * end = _colid+_start[i+1] ;
+			const Index * low = std::lower_bound(beg, end, (Index)j);
+			if (low != end && *low == j)
+				return _data[low-_colid] ;
+			return field().zero ;
+		}
+
+		Element      &getEntry (Element &x, size_t i, size_t j) const
+		{
+			return x = getEntry (i, j);
+		}
+
+		void firstTriple() const
+		{
+			_triples.reset();
+		}
+
+		bool nextTriple(size_t & i, size_t &j, Element &e) const
+		{
+			const size_t k = _triples._k ;
+			if (k >= _nbnz) {
+				_triples.reset();
+				return false ;
+			}
+			while (_start[_triples._row+1] <= k)
+				++_triples._row ;
+			i = _triples._row ;
+			j = (size_t)_colid[k] ;
+			e = _data[k] ;
+			++_triples._k ;
+			return true ;
+		}
+
+		/** Write a matrix to the given output stream using field read/write.
+		 * @param os Output stream to which to write the matrix
+		 * @param format Format with which to write
+		 */
+		std::ostream & write(std::ostream &os
+				     , Tag::FileFormat format  = Tag::FileFormat::MatrixMarket) const
+		{
+			return SparseMatrixWriteHelper<Self_t>::write(*this,os,format);
+		}
+
+		// y= Ax
+		template<class outVector, class inVector>
+		outVector& apply(outVector &y, const inVector& x ) const
+		{
+			linbox_check(y.size() == rowdim() && x.size() == coldim());
+			const RowPartition::Blocks part = partition();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static,1) if(part.blocks() > 1)
+#endif
+			for (size_t b = 0 ; b < part.blocks() ; ++b) {
+				FieldAXPY<Field> accu(field());
+				const SparseRowDot<Field> dot(field());
+				for (size_t i = part.begin(b) ; i < part.end(b) ; ++i) {
+					accu.reset();
+					dot.mulacc(accu, _data+_start[i], _colid+_start[i],
+						   (size_t)(_start[i+1]-_start[i]), x);
+					accu.get(y[i]);
+				}
+			}
+			return y;
+		}
+
+		// y= A^t x
+		template<class outVector, class inVector>
+		outVector& applyTranspose(outVector &y, const inVector& x ) const
+		{
+			linbox_check(y.size() == coldim() && x.size() == rowdim());
+			const std::shared_ptr<const Transpose_t> T = _transpose.get(size(), [this]() { return transpose(); });
+			if (T)
+				return T->apply(y,x);
+
+			const FieldAXPY<Field> accu0(field());
+			std::vector<FieldAXPY<Field> > Y(_colnb, accu0);
+			for (size_t i = 0 ; i < _rownb ; ++i)
+				for (Index k = _start[i] ; k < _start[i+1] ; ++k)
+					Y[_colid[k]].mulacc(_data[k], x[i]);
+			for (size_t j = 0 ; j < _colnb ; ++j)
+				Y[j].get(y[j]);
+			return y;
+		}
+
+		/** Keep the transpose, in memory (CSR), for \c applyTranspose,
+		 * which is then a parallel apply of it instead of a scatter in
+		 * one accumulator per column. It is built at the first
+		 * \c applyTranspose and shared by the copies.
+		 * @param on \c true to always keep it, \c false to never keep it.
+		 * Without a call, it is kept for matrices with more than
+		 * \c LINBOX_CSR_TRANSPOSE entries.
+		 */
+		void cacheTranspose(bool on = true)
+		{
+			_transpose.policy(on);
+		}
+
+		/** Y <- A X, for dense row-major blocks.
+		 * Each entry of \p A is read once for all the columns of \p X.
+		 */
+		template<class Mat1, class Mat2>
+		Mat1 & applyLeft(Mat1 &Y, const Mat2 &X) const
+		{
+			linbox_check(Y.rowdim() == rowdim() && X.rowdim() == coldim() && Y.coldim() == X.coldim());
+			const RowPartition::Blocks part = partition();
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(static,1) if(part.blocks() > 1)
+#endif
+			for (size_t b = 0 ; b < part.blocks() ; ++b) {
+				SparseRowBlock<Field> row(field(), X.coldim());
+				for (size_t i = part.begin(b) ; i < part.end(b) ; ++i)
+					row.mul(Y.getPointer()+i*Y.getStride(), _data+_start[i], _colid+_start[i],
+						(size_t)(_start[i+1]-_start[i]), X.getPointer(), X.getStride());
+			}
+			return Y;
+		}
+
+		/** Y <- X A, for dense row-major blocks.
+		 * Each entry of \p A is read once for all the rows of \p X.
+		 */
+		template<class Mat1, class Mat2>
+		Mat1 & applyRight(Mat1 &Y, const Mat2 &X) const
+		{
+			linbox_check(Y.coldim() == coldim() && X.coldim() == rowdim() && Y.rowdim() == X.rowdim());
+			SparseColBlock<Field> col(field(), coldim(), X.rowdim());
+			for (size_t i = 0 ; i < rowdim() ; ++i)
+				col.mulacc(_data+_start[i], _colid+_start[i], (size_t)(_start[i+1]-_start[i]),
+					   X.getPointer(), X.getStride(), i);
+			col.get(Y.getPointer(), Y.getStride());
+			return Y;
+		}
+
+		/// rows split by number of entries, for the (parallel) apply.
+		RowPartition::Blocks partition() const
+		{
+			const Index * start = _start ;
+			return _partition.update(_rownb, _nbnz,
+						 [start](size_t i) { return (size_t)(start[i+1]-start[i]); });
+		}
+
+	private :
+		typedef SparseMatrix<_Field, SparseMatrixFormat::CSR> Transpose_t ;
+
+		// the transpose, by a counting sort of the entries by column.
+		Transpose_t * transpose() const
+		{
+			std::vector<index_t> start(_colnb+1,0), colid(_nbnz);
+			std::vector<Element> data(_nbnz);
+			for (size_t k = 0 ; k < _nbnz ; ++k)
+				++start[_colid[k]+1] ;
+			for (size_t j = 0 ; j < _colnb ; ++j)
+				start[j+1] += start[j] ;
+			std::vector<index_t> fill(start.begin(), start.end()-1);
+			for (size_t i = 0 ; i < _rownb ; ++i)
+				for (Index k = _start[i] ; k < _start[i+1] ; ++k) {
+					const size_t l = (size_t)fill[_colid[k]]++ ;
+					colid[l] = (index_t) i ;
+					data[l] = _data[k] ;
+				}
+			Transpose_t * T = new Transpose_t(field(), _colnb, _rownb);
+			T->resize(_colnb, _rownb, _nbnz);
+			T->setStart(start);
+			T->setColid(colid);
+			T->setData(data);
+			T->finalize();
+			return T ;
+		}
+
+		static const char * magic()
+		{
+			return "LBSPMM\0\0" ;
+		}
+
+		/// where the values start, 64 bytes aligned.
+		static uint64_t offset(uint64_t m, uint64_t nnz)
+		{
+			const uint64_t end = sizeof(Header) + (m+1+nnz)*sizeof(Index) ;
+			return (end+63)/64*64 ;
+		}
+
+		struct StreamSource {
+			MatrixStream<Field> & ms ;
+			StreamSource(MatrixStream<Field> & s) : ms(s) {}
+			bool next(size_t & i, size_t & j, Element & e) { return ms.nextTriple(i,j,e); }
+		};
+
+		template<class Matrix>
+		struct TripleSource {
+			const Matrix & A ;
+			TripleSource(const Matrix & M) : A(M) { A.firstTriple(); }
+			bool next(size_t & i, size_t & j, Element & e) { return A.nextTriple(i,j,e); }
+		};
+
+		template<class Matrix>
+		struct IndexedSource {
+			typename Matrix::ConstIndexedIterator it, end ;
+			IndexedSource(const Matrix & A) : it(A.IndexedBegin()), end(A.IndexedEnd()) {}
+			bool next(size_t & i, size_t & j, Element & e)
+			{
+				if (it == end)
+					return false ;
+				i = (size_t)it.rowIndex() ;
+				j = (size_t)it.colIndex() ;
+				e = it.value() ;
+				++it ;
+				return true ;
+			}
+		};
+
+		template<class Matrix>
+		static void createFrom(const std::string & name, const Matrix & A, IndexedTags::HasNext)
+		{
+			TripleSource<Matrix> src(A);
+			build(name, A.field(), A.rowdim(), A.coldim(), src);
+		}
+
+		template<class Matrix>
+		static void createFrom(const std::string & name, const Matrix & A, IndexedTags::HasIndexed)
+		{
+			IndexedSource<Matrix> src(A);
+			build(name, A.field(), A.rowdim(), A.coldim(), src);
+		}
+
+		struct Record {
+			uint64_t row ;
+			uint64_t col ;
+			Element  elt ;
+		};
+
+		template<class Source>
+		static void build(const std::string & name, const Field & F, size_t m, size_t n, Source & src)
+		{
+			// the triples, in the order given, counted by row
+			const Protected::TemporaryFile tmpfile(name + ".tmp");
+			const std::string & tmpname = tmpfile.name() ;
+			std::vector<Index> start(m+1,0);
+			{
+				std::ofstream tmp(tmpname.c_str(), std::ios::binary | std::ios::trunc);
+				if (!tmp)
+					throw LinBoxError("cannot create " + tmpname, __func__, __FILE__, __LINE__);
+				Record r ;
+				size_t i, j ;
+				while (src.next(i,j,r.elt)) {
+					if (i >= m || j >= n)
+						throw LinBoxError("entry outside of the matrix in " + name, __func__, __FILE__, __LINE__);
+					r.row = i ;
+					r.col = j ;
+					tmp.write(reinterpret_cast<const char*>(&r), sizeof(Record));
+					++start[i+1] ;
+				}
+				tmp.close();
+				if (!tmp)
+					throw LinBoxError("cannot write " + tmpname, __func__, __FILE__, __LINE__);
+			}
+			for (size_t i = 0 ; i < m ; ++i)
+				start[i+1] += start[i] ;
+			const uint64_t nnz = start[m] ;
+
+			Protected::MappedFile out(name, (size_t)(offset(m,nnz)+nnz*sizeof(Element)));
+			Header & h = *reinterpret_cast<Header*>(out.data()) ;
+			std::memcpy(h.magic, magic(), sizeof(h.magic));
+			h.version = 1 ;
+			h.rows = m ;
+			h.cols = n ;
+			h.eltsize = sizeof(Element) ;
+			h.data = offset(m,nnz) ;
+			Index * ostart = reinterpret_cast<Index*>(out.data()+sizeof(Header)) ;
+			Index * ocolid = ostart+m+1 ;
+			Element * odata = reinterpret_cast<Element*>(out.data()+h.data) ;
+
+			// each triple to its row
+			{
+				std::vector<Index> fill(start.begin(), start.end()-1);
+				std::ifstream tmp(tmpname.c_str(), std::ios::binary);
+				Record r ;
+				uint64_t read = 0 ;
+				while (read < nnz && tmp.read(reinterpret_cast<char*>(&r), sizeof(Record))) {
+					ocolid[fill[r.row]] = r.col ;
+					odata [fill[r.row]] = r.elt ;
+					++fill[r.row] ;
+					++read ;
+				}
+				if (read != nnz)
+					throw LinBoxError("cannot read " + tmpname, __func__, __FILE__, __LINE__);
+			}
+
+			// rows sorted by column, the last repeated entry kept, then the zeros dropped
+			Index k = 0 ;
+			std::vector<std::pair<Index,Element> > row ;
+			for (size_t i = 0 ; i < m ; ++i) {
+				row.clear();
+				for (Index l = start[i] ; l < start[i+1] ; ++l)
+					row.push_back(std::make_pair(ocolid[l], odata[l]));
+				std::stable_sort(row.begin(), row.end(),
+						 [](const std::pair<Index,Element> & a, const std::pair<Index,Element> & b) {
+						 return a.first < b.first ; });
+				ostart[i] = k ;
+				for (size_t l = 0 ; l < row.size() ; ++l) {
+					if (l+1 < row.size() && row[l+1].first == row[l].first)
+						continue ;
+					if (F.isZero(row[l].second))
+						continue ;
+					ocolid[k] = row[l].first ;
+					odata [k] = row[l].second ;
+					++k ;
+				}
+			}
+			ostart[m] = k ;
+			h.nnz = k ;
+		}
+
+	protected :
+		friend class SparseMatrixWriteHelper<Self_t >;
+
+		size_t              _rownb ;
+		size_t              _colnb ;
+		size_t               _nbnz ;
+
+		std::shared_ptr<Protected::MappedFile> _file ;
+		const Index        * _start ; //!< entries of row \p i are <code>_start[i].._start[i+1]</code>
+		const Index        * _colid ;
+		const Element       * _data ;
+
+		const _Field & _field;
+
+		mutable RowPartition _partition ;
+		mutable TransposeCache<Transpose_t> _transpose ;
+
+		mutable struct _triples {
+			size_t _row ;
+			size_t _k ;
+			_triples() :
+				_row(0)
+				, _k(0)
+			{}
+
+			void reset()
+			{
+				_row = 0 ;
+				_k = 0 ;
+			}
+		}_triples;
+	};
+
+	template<class Field>
+	struct is_blockbb<SparseMatrix<Field,SparseMatrixFormat::MMAP> > {
+		static const bool value = true;
+	};
+
+} // LinBox
+
+#endif // __LINBOX_matrix_sparsematrix_sparse_mmap_matrix_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -0,0 +1,232 @@
+/* linbox/matrix/sparsematrix/sparse-row-dot.h
+ * Copyright (C) 2013 the LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file matrix/sparsematrix/sparse-row-dot.h
+ * @ingroup sparsematrix
+ * @brief Dot product of a sparse row with a dense vector, the inner loop
+ * of the CSR, ELL and ELL_R applies, and its dense block counterparts.
+ */
+
+
+#ifndef __LINBOX_matrix_sparsematrix_sparse_row_dot_H
+#define __LINBOX_matrix_sparsematrix_sparse_row_dot_H
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include "linbox/linbox-config.h"
+#include "linbox/util/field-axpy.h"
+#include "fflas-ffpack/fflas/fflas_simd.h"
+#include "givaro/modular.h"
+
+namespace LinBox {
+
+	/** accu += sum a[k] x[c[k]], for k < len.
+	 * Generic version, one FieldAXPY::mulacc per entry.
+	 * One object is built per block of rows, outside the row loop.
+	 */
+	template<class Field>
+	struct SparseRowDot {
+		SparseRowDot(const Field &) {}
+
+		template<class Index, class Vector>
+		void mulacc(FieldAXPY<Field> & accu,
+			    const typename Field::Element * a, const Index * c, size_t len,
+			    const Vector & x) const
+		{
+			for (size_t k = 0 ; k < len ; ++k)
+				accu.mulacc(a[k], x[(size_t)c[k]]);
+		}
+	};
+
+	/** SparseRowDot for the floating point modular fields.
+	 *
+	 * The entries of \p x are gathered by packets into SIMD registers, and
+	 * the products are summed in each lane without reduction, as long as
+	 * the mantissa holds the sum of all the lanes ; these are then added
+	 * and reduced once. For primes too large for that, the generic loop
+	 * is used.
+	 */
+	template<class Field>
+	struct SparseRowDotSimd {
+		typedef typename Field::Element Element ;
+		typedef ::Simd<Element>          simd ;
+		typedef typename simd::vect_t  vect_t ;
+
+		SparseRowDotSimd(const Field & F) :
+			_p((Element)F.characteristic())
+			, _invp((Element)1/_p)
+			// packets summed before reduction, the lanes included
+			, _delay((size_t)(maxSum()/((_p-1)*(_p-1)*(Element)simd::vect_size)))
+		{}
+
+		template<class Index, class Vector>
+		void mulacc(FieldAXPY<Field> & accu,
+			    const Element * a, const Index * c, size_t len,
+			    const Vector & x) const
+		{
+			const size_t V = simd::vect_size ;
+			size_t k = 0 ;
+			if (len >= V && _delay > 0) {
+				Element buf[simd::vect_size] ;
+				vect_t acc = simd::set1(0) ;
+				size_t todo = _delay ;
+				for ( ; k+V <= len ; k += V) {
+					for (size_t l = 0 ; l < V ; ++l)
+						buf[l] = x[(size_t)c[k+l]] ;
+					acc = simd::add(acc, simd::mul(simd::loadu(a+k), simd::loadu(buf)));
+					if (--todo == 0) {
+						flush(accu, acc, buf);
+						todo = _delay ;
+					}
+				}
+				if (todo != _delay)
+					flush(accu, acc, buf);
+			}
+			for ( ; k < len ; ++k)
+				accu.mulacc(a[k], x[(size_t)c[k]]);
+		}
+
+	private :
+		/// largest integer below which all integers are exact.
+		static Element maxSum()
+		{
+			return (Element)((uint64_t)1 << std::numeric_limits<Element>::digits) ;
+		}
+
+		/// sums the lanes of \p acc, exactly, and reduces once.
+		void flush(FieldAXPY<Field> & accu, vect_t & acc, Element * buf) const
+		{
+			simd::storeu(buf, acc);
+			Element t = buf[0] ;
+			for (size_t l = 1 ; l < simd::vect_size ; ++l)
+				t += buf[l] ;
+			// t < 2^digits : the quotient is off by one at most
+			t -= std::floor(t*_invp)*_p ;
+			if (t < 0) t += _p ;
+			else if (t >= _p) t -= _p ;
+			accu.accumulate(t);
+			acc = simd::set1(0) ;
+		}
+
+		Element _p ;
+		Element _invp ;
+		size_t  _delay ;
+	};
+
+	template<>
+	struct SparseRowDot<Givaro::Modular<double> > : public SparseRowDotSimd<Givaro::Modular<double> > {
+		SparseRowDot(const Givaro::Modular<double> & F) : SparseRowDotSimd<Givaro::Modular<double> >(F) {}
+	};
+
+	template<>
+	struct SparseRowDot<Givaro::Modular<float> > : public SparseRowDotSimd<Givaro::Modular<float> > {
+		SparseRowDot(const Givaro::Modular<float> & F) : SparseRowDotSimd<Givaro::Modular<float> >(F) {}
+	};
+
+	/** Row of Y <- A X, for a dense row-major block \p X of \p b columns.
+	 * Each entry of the sparse row is read once, and multiplies a whole
+	 * (contiguous) row of \p X ; one accumulator per column of the block.
+	 */
+	template<class Field>
+	struct SparseRowBlock {
+		typedef typename Field::Element Element ;
+
+		SparseRowBlock(const Field & F, size_t b) :
+			_accu(b, FieldAXPY<Field>(F))
+		{}
+
+		/// y[l] <- sum a[k] X(c[k],l), \p X of leading dimension \p ldx.
+		template<class Index>
+		void mul(Element * y, const Element * a, const Index * c, size_t len,
+			 const Element * X, size_t ldx)
+		{
+			const size_t b = _accu.size() ;
+			for (size_t l = 0 ; l < b ; ++l)
+				_accu[l].reset();
+			for (size_t k = 0 ; k < len ; ++k) {
+				const Element * xk = X + (size_t)c[k]*ldx ;
+				for (size_t l = 0 ; l < b ; ++l)
+					_accu[l].mulacc(a[k], xk[l]);
+			}
+			for (size_t l = 0 ; l < b ; ++l)
+				_accu[l].get(y[l]);
+		}
+
+	private :
+		std::vector<FieldAXPY<Field> > _accu ;
+	};
+
+	/** Y <- X A, for a dense row-major block \p X of \p b rows, the rows of
+	 * \p A given one after the other.
+	 * Each entry of \p A is read once ; the accumulators of a column of
+	 * \p Y are contiguous.
+	 */
+	template<class Field>
+	struct SparseColBlock {
+		typedef typename Field::Element Element ;
+
+		SparseColBlock(const Field & F, size_t n, size_t b) :
+			_b(b), _accu(n*b, FieldAXPY<Field>(F)), _x(b)
+		{}
+
+		/// takes row \p i of \p A, with column \p i of \p X (leading dimension \p ldx).
+		template<class Index>
+		void mulacc(const Element * a, const Index * c, size_t len,
+			    const Element * X, size_t ldx, size_t i)
+		{
+			for (size_t l = 0 ; l < _b ; ++l)
+				_x[l] = X[l*ldx+i] ;
+			for (size_t k = 0 ; k < len ; ++k) {
+				FieldAXPY<Field> * yk = _accu.data() + (size_t)c[k]*_b ;
+				for (size_t l = 0 ; l < _b ; ++l)
+					yk[l].mulacc(a[k], _x[l]);
+			}
+		}
+
+		/// Y(l,j), \p Y of leading dimension \p ldy.
+		void get(Element * Y, size_t ldy)
+		{
+			const size_t n = _accu.size()/std::max(_b,(size_t)1) ;
+			for (size_t j = 0 ; j < n ; ++j)
+				for (size_t l = 0 ; l < _b ; ++l)
+					_accu[j*_b+l].get(Y[l*ldy+j]);
+		}
+
+	private :
+		size_t _b ;
+		std::vector<FieldAXPY<Field> > _accu ;
+		std::vector<Element> _x ;
+	};
+
+} // LinBox
+
+#endif // __LINBOX_matrix_sparsematrix_sparse_row_dot_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
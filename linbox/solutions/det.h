@@ -510,6 +510,68 @@ namespace LinBox
 
 		return d;
 	}
+
+	/** Determinant over \f$ \mathbf{F}_2 \f$ of a word packed dense matrix (M4RI).
+	 * A will be modified.
+	 */
+	inline GF2::Element &detInPlace (GF2::Element                     &d,
+					 M4RIMatrix                       &A)
+	{
+		commentator().start ("M4RI Determinant", "m4ridet");
+		M4RIDomain D (A.field());
+		d = D.detInPlace(A);
+		commentator().stop ("done", NULL, "m4ridet");
+		return d;
+	}
+
+	inline GF2::Element &detInPlace (GF2::Element                     &d,
+					 M4RIMatrix                       &A,
+					 const RingCategories::ModularTag &,
+					 const Method::DenseElimination   &)
+	{
+		return detInPlace(d, A);
+	}
+
+	inline GF2::Element &detInPlace (GF2::Element                     &d,
+					 M4RIMatrix                       &A,
+					 const RingCategories::ModularTag &,
+					 const Method::Elimination        &)
+	{
+		return detInPlace(d, A);
+	}
+
+	inline GF2::Element &detInPlace (GF2::Element                     &d,
+					 M4RIMatrix                       &A,
+					 const RingCategories::ModularTag &,
+					 const Method::Auto               &)
+	{
+		return detInPlace(d, A);
+	}
+
+	inline GF2::Element &det (GF2::Element                     &d,
+				  const M4RIMatrix                 &A,
+				  const RingCategories::ModularTag &tag,
+				  const Method::DenseElimination   &Meth)
+	{
+		M4RIMatrix B (A);
+		return detInPlace(d, B, tag, Meth);
+	}
+
+	inline GF2::Element &det (GF2::Element                     &d,
+				  const M4RIMatrix                 &A,
+				  const RingCategories::ModularTag &tag,
+				  const Method::Elimination        &Meth)
+	{
+		return det(d, A, tag, Method::DenseElimination(Meth));
+	}
+
+	inline GF2::Element &det (GF2::Element                     &d,
+				  const M4RIMatrix                 &A,
+				  const RingCategories::ModularTag &tag,
+				  const Method::Auto               &Meth)
+	{
+		return det(d, A, tag, Method::DenseElimination(Meth));
+	}
 } // end of LinBox namespace
 
 #include "linbox/ring/modular.h"
@@ -221,6 +221,8 @@ namespace LinBox {
         SingularSolutionType singularSolutionType = SingularSolutionType::Random;
         bool certifyMinimalDenominator = false; //!< Whether the solver should try to find a certificate
                                                 //!  that the provided denominator is minimal.
+        size_t liftingDigitsPerStep = 1;        //!< Number k of p-adic digits per lifting step,
+                                                //!  the lifting then works modulo p^k.
 
         // ----- For random-based systems.
         size_t trialsBeforeFailure = LINBOX_DEFAULT_TRIALS_BEFORE_FAILURE; //!< Maximum number of trials before giving up.
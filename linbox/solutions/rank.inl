@@ -604,6 +604,65 @@ namespace LinBox { /*  rankInPlace */
 		return rankInPlace(r, A, M);
 	}
 
+	/// specialization to \f$ \mathbf{F}_2 \f$, word packed dense matrix (M4RI).
+	inline size_t &rankInPlace (size_t                       &r,
+				      M4RIMatrix                          &A,
+				      const RingCategories::ModularTag    &,//tag
+				      const Method::DenseElimination      &)//M
+	{
+		commentator().start ("M4RI Rank", "m4rirank");
+		M4RIDomain D (A.field());
+		r = D.rankInPlace(A);
+		commentator().stop ("done", NULL, "m4rirank");
+		return r;
+	}
+
+	inline size_t &rankInPlace (size_t                       &r,
+				      M4RIMatrix                          &A,
+				      const RingCategories::ModularTag    &tag,
+				      const Method::Elimination           &m)
+	{
+		return rankInPlace(r, A, tag, Method::DenseElimination(m));
+	}
+
+	inline size_t &rankInPlace (size_t                       &r,
+				      M4RIMatrix                          &A,
+				      const RingCategories::ModularTag    &tag,
+				      const Method::Auto                  &m)
+	{
+		return rankInPlace(r, A, tag, Method::DenseElimination(m));
+	}
+
+	inline size_t &rankInPlace (size_t &r, M4RIMatrix &A)
+	{
+		return rankInPlace(r, A, RingCategories::ModularTag(), Method::DenseElimination());
+	}
+
+	inline size_t &rank (size_t                       &r,
+				    const M4RIMatrix                    &A,
+				    const RingCategories::ModularTag    &tag,
+				    const Method::DenseElimination      &M)
+	{
+		M4RIMatrix B (A);
+		return rankInPlace(r, B, tag, M);
+	}
+
+	inline size_t &rank (size_t                       &r,
+				    const M4RIMatrix                    &A,
+				    const RingCategories::ModularTag    &tag,
+				    const Method::Elimination           &m)
+	{
+		return rank(r, A, tag, Method::DenseElimination(m));
+	}
+
+	inline size_t &rank (size_t                       &r,
+				    const M4RIMatrix                    &A,
+				    const RingCategories::ModularTag    &tag,
+				    const Method::Auto                  &m)
+	{
+		return rank(r, A, tag, Method::DenseElimination(m));
+	}
+
 
 	/// A is modified.
 	template <class Field>
@@ -55,6 +55,16 @@ namespace LinBox {
         return solve(x, A, b, tag, reinterpret_cast<const Method::DenseElimination&>(m));
     }
 
+    /**
+     * \brief Solve specialisation for Auto with M4RIMatrix.
+     */
+    template <class ResultVector, class Vector>
+    ResultVector& solve(ResultVector& x, const M4RIMatrix& A, const Vector& b, const RingCategories::ModularTag& tag,
+                        const Method::Auto& m)
+    {
+        return solve(x, A, b, tag, reinterpret_cast<const Method::DenseElimination&>(m));
+    }
+
     /**
      * \brief Solve specialisation for Auto with SparseMatrix and ModularTag.
      */
@@ -36,6 +36,9 @@
 #include <linbox/algorithms/rational-cra-builder-early-multip.h>
 #include <linbox/algorithms/rational-cra-builder-full-multip.h>
 #include <linbox/algorithms/rational-cra.h>
+#if defined(__LINBOX_USE_OPENMP) || defined(_OPENMP)
+#include <linbox/algorithms/rational-cra-omp.h>
+#endif
 #include <linbox/field/rebind.h>
 #include <linbox/randiter/random-prime.h>
 #include <linbox/solutions/hadamard-bound.h>
@@ -97,7 +100,11 @@ namespace LinBox {
     /**
      * \brief Solve specialization with Chinese Remainder Algorithm method for an Integer or Rational tags.
      *
-     * If a Dispatch::Distributed is used, please note that the result will only be set on the master node.
+     * If a Dispatch::Distributed or Dispatch::Combined is used, please note that the result will only be set on the master node.
+     *
+     * Dispatch::SMP computes several residues at once with OpenMP threads on this node,
+     * Dispatch::Combined does the same on each MPI worker node.
+     * Without OpenMP, both fall back to one residue at a time per node.
      */
     template <class IntVector, class Matrix, class Vector, class IterationMethod>
     inline void solve(IntVector& xNum, typename IntVector::Element& xDen, const Matrix& A, const Vector& b,
@@ -135,6 +142,18 @@ namespace LinBox {
             return solve(xNum, xDen, A, b, tag, newM);
         }
 
+        if (m.dispatch == Dispatch::Combined && m.pCommunicator == nullptr) {
+            Method::CRA<IterationMethod> newM(m);
+#if defined(__LINBOX_HAVE_MPI)
+            // Threads of a worker node send their residues one after the other.
+            Communicator communicator(nullptr, 0, Communicator::ThreadMode::Serialized);
+#else
+            Communicator communicator(nullptr, 0);
+#endif
+            newM.pCommunicator = &communicator;
+            return solve(xNum, xDen, A, b, tag, newM);
+        }
+
         //
         // Init all (Hadamard bound, prime generator).
         //
@@ -174,9 +193,27 @@ namespace LinBox {
             LinBox::RationalChineseRemainder<CRAAlgorithm> cra(hadamardLogBound);
             cra(num, den, iteration, primeGenerator);
         }
+        else if (dispatch == Dispatch::SMP
+#if !defined(__LINBOX_HAVE_MPI)
+                 // Without MPI, this node is the only one.
+                 || dispatch == Dispatch::Combined
+#endif
+        ) {
+#if defined(__LINBOX_USE_OPENMP) || defined(_OPENMP)
+            LinBox::RationalChineseRemainderOMP<CRAAlgorithm> cra(hadamardLogBound);
+#else
+            if (m.master()) {
+                commentator().report(Commentator::LEVEL_NORMAL, INTERNAL_WARNING)
+                    << "LinBox is built without OpenMP: the residues are computed one at a time." << std::endl;
+            }
+            LinBox::RationalChineseRemainder<CRAAlgorithm> cra(hadamardLogBound);
+#endif
+            cra(num, den, iteration, primeGenerator);
+        }
 #if defined(__LINBOX_HAVE_MPI)
-        else if (dispatch == Dispatch::Distributed) {
-            LinBox::ChineseRemainderDistributed<CRAAlgorithm> cra(hadamardLogBound, m.pCommunicator);
+        else if (dispatch == Dispatch::Distributed || dispatch == Dispatch::Combined) {
+            LinBox::ChineseRemainderDistributed<CRAAlgorithm> cra(hadamardLogBound, m.pCommunicator,
+                                                                  dispatch == Dispatch::Combined);
             cra(num, den, iteration, primeGenerator);
         }
 #endif
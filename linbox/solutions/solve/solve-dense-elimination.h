@@ -23,6 +23,7 @@
 #pragma once
 
 #include <linbox/matrix/dense-matrix.h>
+#include <linbox/matrix/matrixdomain/matrix-domain-m4ri.h>
 #include <linbox/matrix/sparse-matrix.h>
 #include <linbox/solutions/methods.h>
 
@@ -30,9 +31,9 @@ namespace LinBox {
     /**
      * \brief Solve specialisation for DenseElimination.
      */
-    template <class Matrix, class Vector>
-    Vector& solve(Vector& x, const Matrix& A, const Vector& b, const RingCategories::ModularTag& tag,
-                  const Method::DenseElimination& m)
+    template <class ResultVector, class Matrix, class Vector>
+    ResultVector& solve(ResultVector& x, const Matrix& A, const Vector& b, const RingCategories::ModularTag& tag,
+                        const Method::DenseElimination& m)
     {
         commentator().report(Commentator::LEVEL_UNIMPORTANT,
                              "Warning: Solve implicitly convert to a dense matrix because of Method::DenseElimination."
@@ -47,9 +48,9 @@ namespace LinBox {
     /**
      * \brief Solve specialisation for DenseElimination on dense matrices with ModularTag.
      */
-    template <class Field, class Vector>
-    Vector& solve(Vector& x, const DenseMatrix<Field>& A, const Vector& b, const RingCategories::ModularTag& tag,
-                  const Method::DenseElimination& m)
+    template <class ResultVector, class Field, class Vector>
+    ResultVector& solve(ResultVector& x, const DenseMatrix<Field>& A, const Vector& b,
+                        const RingCategories::ModularTag& tag, const Method::DenseElimination& m)
     {
         linbox_check((A.coldim() == x.size()) && (A.rowdim() == b.size()));
 
@@ -62,4 +63,26 @@ namespace LinBox {
 
         return x;
     }
+
+    /**
+     * \brief Solve specialisation for DenseElimination on M4RIMatrix, over GF2.
+     *
+     * The free variables are set to zero.
+     * Throws LinboxMathInconsistentSystem if there is no solution.
+     */
+    template <class ResultVector, class Vector>
+    ResultVector& solve(ResultVector& x, const M4RIMatrix& A, const Vector& b, const RingCategories::ModularTag& tag,
+                        const Method::DenseElimination& m)
+    {
+        linbox_check((A.coldim() == x.size()) && (A.rowdim() == b.size()));
+
+        commentator().start("solve.dense-elimination.modular.m4ri");
+
+        M4RIDomain D(A.field());
+        D.solve(x, A, b);
+
+        commentator().stop("solve.dense-elimination.modular.m4ri");
+
+        return x;
+    }
 }
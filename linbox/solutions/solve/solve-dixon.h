@@ -97,6 +97,7 @@ namespace LinBox {
 
         using Solver = DixonSolver<Ring, Field, PrimeGenerator, typename MethodForMatrix<Matrix>::type>;
         Solver dixonSolve(A.field(), primeGenerator);
+        dixonSolve.setDigitsPerStep(m.liftingDigitsPerStep);
 
         // Either A is known to be non-singular, or we just don't know yet.
         int maxTrials = m.trialsBeforeFailure;
@@ -46,6 +46,9 @@
 #include <streambuf>
 #include <fstream>
 #include <cstring>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 //#include "linbox/util/timer.h"
 #include "givaro/givtimer.h"
@@ -994,9 +997,18 @@ namespace LinBox
 
     namespace LinBox
     {
-        // Default static commentator
+        // Default static commentator.
+        // It keeps one stack of activities and takes no lock : inside an
+        // OpenMP parallel region, each thread gets a commentator of its own,
+        // whose reports are dropped.
         Commentator& commentator() {
             static Commentator internal_static_commentator;
+#ifdef _OPENMP
+            if (omp_in_parallel ()) {
+                static thread_local Commentator thread_commentator;
+                return thread_commentator;
+            }
+#endif
             return internal_static_commentator;
         }
         Commentator& commentator(std::ostream& stream) {
@@ -38,6 +38,7 @@ namespace LinBox {
         template <class T> inline void ssend(const T& value, int dest) {}
         template <class T> inline void recv(T& value, int src) {}
         template <class T> inline void bcast(T& value, int src) {}
+        inline bool iprobe(int src) { return false; }
     };
 }
 #else
@@ -89,6 +90,9 @@ namespace LinBox {
         template <class T> void recv(T& value, int src);
         template <class T> void bcast(T& value, int src);
 
+        // Whether a message from src is waiting, without receiving it.
+        bool iprobe(int src);
+
     protected:
         MPI_Comm _comm;       // MPI's handle for the communicator
         MPI_Status _status;   // status from most recent receive
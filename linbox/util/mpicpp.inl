@@ -137,6 +137,13 @@ namespace LinBox {
             unserialize(value, bytes);
         }
     }
+
+    inline bool Communicator::iprobe(int src)
+    {
+        int flag = 0;
+        MPI_Iprobe(src, 0, _comm, &flag, &_status);
+        return flag != 0;
+    }
 }
 
 // Local Variables:
@@ -0,0 +1,613 @@
+/* linbox/util/parallel-matrix-reader.h
+ * Copyright (C) 2013 the LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file util/parallel-matrix-reader.h
+ * @ingroup util
+ * @brief Parallel reader of sparse matrix files (SMS, Matrix Market
+ * coordinate), compressed with gzip or not.
+ *
+ * MatrixStream reads one triple at a time, through the virtual
+ * \c nextTripleImpl of the format and <code>operator>></code> on a
+ * \c std::istream. For large files, ParallelMatrixReader reads the file by
+ * blocks, cuts each block at line ends into one chunk per thread, and
+ * parses the chunks in parallel, the indices and the small integer
+ * values without streams. The next block is read (and decompressed)
+ * while the current one is parsed. As long as the triples come sorted by
+ * row, the chunks are given to the matrix with \c appendEntry as soon as
+ * they are parsed ; otherwise they are kept, sorted by row at the end,
+ * then given.
+ *
+ * Only the sparse formats are read this way ; the others (dense, Maple,
+ * sparse rows...) are read by MatrixStream.
+ */
+
+#ifndef __LINBOX_util_parallel_matrix_reader_H
+#define __LINBOX_util_parallel_matrix_reader_H
+
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <cstdint>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+
+#include "linbox/linbox-config.h"
+#include "linbox/util/debug.h"
+
+#ifdef __LINBOX_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef __LINBOX_USE_OPENMP
+#include <omp.h>
+#endif
+
+#ifndef LINBOX_READER_BLOCK
+/// bytes of the file parsed at once by ParallelMatrixReader.
+#define LINBOX_READER_BLOCK (64UL << 20)
+#endif
+
+namespace LinBox
+{
+
+	namespace Protected {
+
+		/** The bytes of a file, read by blocks.
+		 * gzip files are decompressed when LinBox is configured with zlib
+		 * (zlib reads the other files as they are).
+		 */
+		class ByteSource {
+#ifdef __LINBOX_HAVE_ZLIB
+			gzFile _gz ;
+#else
+			std::FILE * _f ;
+#endif
+		public :
+			ByteSource(const std::string & name)
+			{
+#ifdef __LINBOX_HAVE_ZLIB
+				_gz = gzopen(name.c_str(), "rb");
+				if (_gz == NULL)
+					throw LinBoxError("cannot open " + name, __func__, __FILE__, __LINE__);
+				gzbuffer(_gz, 1 << 20);
+#else
+				_f = std::fopen(name.c_str(), "rb");
+				if (_f == NULL)
+					throw LinBoxError("cannot open " + name, __func__, __FILE__, __LINE__);
+				int c0 = std::getc(_f), c1 = std::getc(_f);
+				if (c0 == 0x1f && c1 == 0x8b) {
+					std::fclose(_f);
+					throw LinBoxError(name + " is compressed, and LinBox is not configured with zlib",
+							  __func__, __FILE__, __LINE__);
+				}
+				std::rewind(_f);
+#endif
+			}
+
+			~ByteSource()
+			{
+#ifdef __LINBOX_HAVE_ZLIB
+				gzclose(_gz);
+#else
+				std::fclose(_f);
+#endif
+			}
+
+			/// appends at most \p len bytes to \p buf ; false at the end of the file.
+			bool read(std::vector<char> & buf, size_t len)
+			{
+				const size_t old = buf.size() ;
+				buf.resize(old+len);
+#ifdef __LINBOX_HAVE_ZLIB
+				size_t done = 0 ;
+				while (done < len) {
+					// gzread counts in unsigned
+					unsigned step = (unsigned)std::min(len-done, (size_t)1 << 30);
+					int r = gzread(_gz, buf.data()+old+done, step);
+					if (r < 0)
+						throw LinBoxError("corrupted compressed file", __func__, __FILE__, __LINE__);
+					if (r == 0)
+						break ;
+					done += (size_t)r ;
+				}
+#else
+				size_t done = std::fread(buf.data()+old, 1, len, _f);
+#endif
+				buf.resize(old+done);
+				return done == len ;
+			}
+
+			/// back to the first byte.
+			void rewind()
+			{
+#ifdef __LINBOX_HAVE_ZLIB
+				if (gzrewind(_gz) != 0)
+					throw LinBoxError("cannot rewind", __func__, __FILE__, __LINE__);
+#else
+				std::rewind(_f);
+#endif
+			}
+
+		private :
+			ByteSource(const ByteSource &) ;
+			ByteSource & operator=(const ByteSource &) ;
+		};
+
+	} // Protected
+
+	/** Reads a sparse matrix file, SMS or Matrix Market coordinate, in parallel.
+	 *
+	 * The header is read by the constructor, then \c read fills a
+	 * sparse matrix with \c resize, \c appendEntry and \c finalize (every
+	 * SparseMatrix format has them).
+	 * If an entry is repeated, the last one read is kept (a zero
+	 * removes it). The Matrix Market symmetric and skew-symmetric
+	 * matrices are expanded.
+	 *
+	 * A file sorted by row, then column, is given to the matrix while it
+	 * is read : only the blocks being parsed are in memory. The entries
+	 * of other files are all kept until the end of the file ; if the
+	 * disorder is only found after some entries were given, the matrix
+	 * is emptied and the file read again.
+	 *
+	 * \ingroup util
+	 */
+	template<class Field>
+	class ParallelMatrixReader {
+	public :
+		typedef typename Field::Element Element ;
+
+		/** Opens \p name and reads its header.
+		 * @param block bytes parsed at once (two blocks are in memory).
+		 */
+		ParallelMatrixReader(const Field & F, const std::string & name, size_t block = LINBOX_READER_BLOCK) :
+			_field(F), _name(name), _src(name), _block(std::max(block,(size_t)1))
+			, _pos(0), _eof(false), _m(0), _n(0), _nnz(0)
+			, _sms(false), _pattern(false), _mirror(0)
+		{
+			readHeader();
+		}
+
+		size_t rowdim() const
+		{
+			return _m ;
+		}
+
+		size_t coldim() const
+		{
+			return _n ;
+		}
+
+		const Field & field() const
+		{
+			return _field ;
+		}
+
+		/// "sms" or "mm".
+		const char * getFormat() const
+		{
+			return _sms ? "sms" : "mm" ;
+		}
+
+		/// reads the entries into \p A, resized to the dimensions of the file.
+		template<class Matrix>
+		Matrix & read(Matrix & A)
+		{
+			std::vector<std::vector<Entry> > parts ;
+			A.resize(_m, _n);
+			if (!readEntries(A, parts, true)) {
+				// out of order after some entries were given
+				A.resize(0, 0);
+				A.resize(_m, _n);
+				rewind();
+				readEntries(A, parts, false);
+			}
+			if (!parts.empty()) {
+				std::vector<Entry> all ;
+				sortByRow(all, parts);
+				for (size_t k = 0 ; k < all.size() ; ++k) {
+					// the last of repeated entries
+					if (k+1 < all.size() && all[k+1].row == all[k].row && all[k+1].col == all[k].col)
+						continue ;
+					if (!_field.isZero(all[k].val))
+						A.appendEntry(all[k].row, all[k].col, all[k].val);
+				}
+			}
+			A.finalize();
+			return A ;
+		}
+
+	private :
+		struct Entry {
+			size_t row ;
+			size_t col ;
+			Element val ;
+		};
+
+		/// one chunk of a block, parsed by one thread.
+		struct Chunk {
+			const char * begin ;
+			const char * end ;
+			std::vector<Entry> entries ;
+			std::string error ;  //!< the bad line, if any
+			bool stop ;          //!< SMS end line "0 0 0" met
+			bool sorted ;        //!< entries by row then column, no repetition
+		};
+
+		static bool blank(char c)
+		{
+			return c == ' ' || c == '\t' || c == '\r' ;
+		}
+
+		static bool space(char c)
+		{
+			return blank(c) || c == '\n' ;
+		}
+
+		static bool sameWord(const std::string & s, const char * w)
+		{
+			if (s.size() != std::strlen(w))
+				return false ;
+			for (size_t k = 0 ; k < s.size() ; ++k)
+				if (std::tolower((unsigned char)s[k]) != w[k])
+					return false ;
+			return true ;
+		}
+
+		/// the next line of the header, without its end ; false at the end of the file.
+		bool headerLine(std::string & line)
+		{
+			for (;;) {
+				const char * b = _buf.data()+_pos ;
+				const char * e = _buf.data()+_buf.size() ;
+				const char * nl = std::find(b, e, '\n');
+				if (nl != e || _eof) {
+					if (b == e)
+						return false ;
+					line.assign(b, nl);
+					_pos = (size_t)(nl-_buf.data()) + (nl != e) ;
+					return true ;
+				}
+				_eof = !_src.read(_buf, _block);
+			}
+		}
+
+		void badHeader(const std::string & why) const
+		{
+			throw LinBoxError(_name + " : " + why, __func__, __FILE__, __LINE__);
+		}
+
+		void readHeader()
+		{
+			std::string line ;
+			do {
+				if (!headerLine(line))
+					badHeader("empty file");
+			} while (line.find_first_not_of(" \t\r") == std::string::npos);
+
+			std::istringstream in(line);
+			if (line.compare(0,2,"%%") == 0) {
+				std::string banner, object, format, type, symmetry ;
+				in >> banner >> object >> format >> type >> symmetry ;
+				if (!sameWord(banner,"%%matrixmarket") || !sameWord(object,"matrix"))
+					badHeader("not a Matrix Market matrix");
+				if (!sameWord(format,"coordinate"))
+					badHeader("not a sparse (coordinate) matrix, read it with MatrixStream");
+				if (sameWord(type,"complex"))
+					badHeader("complex entries");
+				_pattern = sameWord(type,"pattern");
+				if (sameWord(symmetry,"symmetric") || sameWord(symmetry,"hermitian"))
+					_mirror = 1 ;
+				else if (sameWord(symmetry,"skew-symmetric"))
+					_mirror = -1 ;
+				else if (!sameWord(symmetry,"general"))
+					badHeader("unknown symmetry " + symmetry);
+				do {
+					if (!headerLine(line))
+						badHeader("no dimensions");
+				} while (line.empty() || line[0] == '%' || line.find_first_not_of(" \t\r") == std::string::npos);
+				std::istringstream dims(line);
+				dims >> _m >> _n >> _nnz ;
+				if (dims.fail())
+					badHeader("bad dimensions " + line);
+				if (_mirror && _m != _n)
+					badHeader("symmetric matrix not square");
+			}
+			else {
+				std::string letter ;
+				in >> _m >> _n >> letter ;
+				if (in.fail() || letter.size() != 1 || !std::strchr("MmIiRrPp", letter[0]))
+					badHeader("neither SMS nor Matrix Market");
+				_sms = true ;
+			}
+		}
+
+		/// reads an index (from 1), on the current line.
+		static bool readIndex(const char *& p, const char * end, size_t & i)
+		{
+			while (p < end && blank(*p))
+				++p ;
+			const char * b = p ;
+			i = 0 ;
+			while (p < end && *p >= '0' && *p <= '9' && p-b < 19)
+				i = i*10 + (size_t)(*p++ - '0') ;
+			return p != b && (p == end || space(*p)) ;
+		}
+
+		/// reads a value : small integers directly, the others through \c Field::read.
+		bool readValue(const char *& p, const char * end, Element & v) const
+		{
+			while (p < end && blank(*p))
+				++p ;
+			const char * b = p ;
+			while (p < end && !space(*p))
+				++p ;
+			if (p == b)
+				return false ;
+			const char * d = b + (*b == '-' || *b == '+') ;
+			if (d < p && p-d <= 18) {
+				int64_t x = 0 ;
+				const char * q = d ;
+				for ( ; q < p && *q >= '0' && *q <= '9' ; ++q)
+					x = x*10 + (*q - '0') ;
+				if (q == p) {
+					_field.init(v, (*b == '-') ? -x : x);
+					return true ;
+				}
+			}
+			std::istringstream in(std::string(b,p));
+			_field.read(in, v);
+			return !in.fail() ;
+		}
+
+		/// parses the lines of \p c.
+		void parse(Chunk & c) const
+		{
+			c.entries.clear();
+			c.entries.reserve((size_t)(c.end-c.begin)/16);
+			c.error.clear();
+			c.stop = false ;
+			c.sorted = true ;
+			const char * p = c.begin ;
+			while (p < c.end) {
+				while (p < c.end && space(*p))
+					++p ;
+				if (p == c.end)
+					break ;
+				const char * line = p ;
+				if (*p == '%') {
+					p = std::find(p, c.end, '\n');
+					continue ;
+				}
+				size_t i, j ;
+				Element v ;
+				bool ok = readIndex(p, c.end, i) && readIndex(p, c.end, j) ;
+				if (ok && _sms && i == 0 && j == 0) {
+					c.stop = true ;
+					return ;
+				}
+				if (ok && _pattern)
+					_field.assign(v, _field.one);
+				else
+					ok = ok && readValue(p, c.end, v) ;
+				while (p < c.end && blank(*p))
+					++p ;
+				ok = ok && (p == c.end || *p == '\n') && i >= 1 && j >= 1 && i <= _m && j <= _n ;
+				if (!ok) {
+					c.error.assign(line, std::find(line, c.end, '\n'));
+					return ;
+				}
+				Entry e = { i-1, j-1, v } ;
+				if (c.sorted && !c.entries.empty())
+					c.sorted = before(c.entries.back(), e) ;
+				c.entries.push_back(e);
+				if (_mirror && i != j) {
+					std::swap(e.row, e.col);
+					if (_mirror < 0)
+						_field.negin(e.val);
+					c.sorted = false ;
+					c.entries.push_back(e);
+				}
+			}
+		}
+
+		/// back to the first entry, for another \c readEntries.
+		void rewind()
+		{
+			_src.rewind();
+			_buf.clear();
+			_pos = 0 ;
+			_eof = false ;
+			readHeader();
+		}
+
+		/// gives the non zero entries of \p c to \p A, then frees them.
+		template<class Matrix>
+		void give(Matrix & A, Chunk & c) const
+		{
+			for (size_t k = 0 ; k < c.entries.size() ; ++k)
+				if (!_field.isZero(c.entries[k].val))
+					A.appendEntry(c.entries[k].row, c.entries[k].col, c.entries[k].val);
+			std::vector<Entry>().swap(c.entries);
+		}
+
+		/** Reads all the entries, in the order of the file.
+		 * With \p stream, the chunks are given to \p A as long as the
+		 * entries are sorted by row, then column, without repetition.
+		 * The others are put in \p parts, one part per chunk : all
+		 * of them, if some are out of order.
+		 * @return false if some entries were given to \p A, then others
+		 * found out of order : \p parts is then incomplete.
+		 */
+		template<class Matrix>
+		bool readEntries(Matrix & A, std::vector<std::vector<Entry> > & parts, bool stream)
+		{
+#ifdef __LINBOX_USE_OPENMP
+			const size_t threads = (size_t)omp_get_max_threads() ;
+#else
+			const size_t threads = 1 ;
+#endif
+			bool sorted = stream ;
+			bool given = false ;
+			Entry last ;
+			std::vector<Chunk> chunks(threads);
+			// the block being parsed starts after the header
+			std::vector<char> cur(_buf.begin()+(ptrdiff_t)_pos, _buf.end()), next ;
+			std::vector<char>().swap(_buf);
+			if (!_eof && cur.size() < _block)
+				_eof = !_src.read(cur, _block-cur.size());
+			for (;;) {
+				// whole lines only
+				size_t cut = cur.size() ;
+				if (!_eof) {
+					while (cut > 0 && cur[cut-1] != '\n')
+						--cut ;
+					if (cut == 0) {
+						// a line longer than a block
+						_eof = !_src.read(cur, _block);
+						continue ;
+					}
+				}
+				const char * b = cur.data() ;
+				const char * e = cur.data()+cut ;
+				for (size_t t = 0 ; t < threads ; ++t) {
+					chunks[t].begin = b ;
+					const char * m = std::max(b, (const char*)cur.data() + cut*(t+1)/threads) ;
+					const char * nl = std::find(m, e, '\n') ;
+					b = (t+1 == threads || nl == e) ? e : nl+1 ;
+					chunks[t].end = b ;
+				}
+
+				// the next block is read while the chunks are parsed
+				const bool more = !_eof ;
+				bool eof = _eof ;
+				std::string readError ;
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(dynamic,1)
+#endif
+				for (size_t t = 0 ; t <= threads ; ++t) {
+					if (t > 0)
+						parse(chunks[t-1]);
+					else if (more) {
+						try {
+							next.assign(cur.begin()+(ptrdiff_t)cut, cur.end());
+							eof = !_src.read(next, _block);
+						}
+						catch (...) {
+							readError = "read error" ;
+						}
+					}
+				}
+				if (!readError.empty())
+					throw LinBoxError(_name + " : " + readError, __func__, __FILE__, __LINE__);
+
+				// the chunks up to the end of the matrix
+				bool stop = false ;
+				for (size_t t = 0 ; t < threads && !stop ; ++t) {
+					Chunk & c = chunks[t] ;
+					if (!c.error.empty())
+						throw LinBoxError(_name + " : bad entry \"" + c.error + "\"", __func__, __FILE__, __LINE__);
+					stop = c.stop ;
+					if (c.entries.empty())
+						continue ;
+					sorted = sorted && c.sorted
+						&& (!given || before(last, c.entries.front())) ;
+					if (sorted) {
+						last = c.entries.back() ;
+						given = true ;
+						give(A, c);
+						continue ;
+					}
+					if (given)
+						return false ;
+					parts.push_back(std::vector<Entry>());
+					parts.back().swap(c.entries);
+				}
+				if (stop || !more)
+					break ;
+				cur.swap(next);
+				_eof = eof ;
+			}
+			return true ;
+		}
+
+		/// \p a strictly before \p b, by row then column.
+		static bool before(const Entry & a, const Entry & b)
+		{
+			return a.row < b.row || (a.row == b.row && a.col < b.col) ;
+		}
+
+		/// \p all : the entries of \p parts (freed), by row then column ; stable.
+		void sortByRow(std::vector<Entry> & all, std::vector<std::vector<Entry> > & parts) const
+		{
+			std::vector<size_t> start(_m+1,0);
+			for (size_t t = 0 ; t < parts.size() ; ++t)
+				for (size_t k = 0 ; k < parts[t].size() ; ++k)
+					++start[parts[t][k].row+1] ;
+			for (size_t i = 0 ; i < _m ; ++i)
+				start[i+1] += start[i] ;
+			all.resize(start[_m]);
+			{
+				// counting sort by row
+				std::vector<size_t> fill(start.begin(), start.end()-1);
+				for (size_t t = 0 ; t < parts.size() ; ++t) {
+					for (size_t k = 0 ; k < parts[t].size() ; ++k)
+						all[fill[parts[t][k].row]++] = parts[t][k] ;
+					std::vector<Entry>().swap(parts[t]);
+				}
+			}
+#ifdef __LINBOX_USE_OPENMP
+#pragma omp parallel for schedule(dynamic,1024)
+#endif
+			for (size_t i = 0 ; i < _m ; ++i)
+				std::stable_sort(all.begin()+(ptrdiff_t)start[i], all.begin()+(ptrdiff_t)start[i+1],
+						 [](const Entry & a, const Entry & b) { return a.col < b.col ; });
+		}
+
+		const Field & _field ;
+		std::string _name ;
+		Protected::ByteSource _src ;
+		size_t _block ;
+		std::vector<char> _buf ; //!< the header, and the first bytes after it
+		size_t _pos ;            //!< end of the header in \c _buf
+		bool _eof ;
+		size_t _m ;
+		size_t _n ;
+		size_t _nnz ;            //!< announced by a Matrix Market header
+		bool _sms ;
+		bool _pattern ;
+		int _mirror ;            //!< 1 symmetric, -1 skew-symmetric, 0 general
+	};
+
+} // LinBox
+
+#endif // __LINBOX_util_parallel_matrix_reader_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
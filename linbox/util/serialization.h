@@ -151,6 +151,23 @@ namespace LinBox {
      */
     template <class Field>
     uint64_t unserialize(BlasVector<Field>& V, const std::vector<uint8_t>& bytes, uint64_t offset = 0u);
+
+    /**
+     * Serializes a std::vector of any serializable type.
+     *
+     * Format is (by bytes count):
+     *  0-7  l      Length of the vector
+     *  8-..        Entries of the vector
+     */
+    template <class T>
+    uint64_t serialize(std::vector<uint8_t>& bytes, const std::vector<T>& V);
+
+    /**
+     * Unserializes a std::vector.
+     * The vector will be resized if necessary.
+     */
+    template <class T>
+    uint64_t unserialize(std::vector<T>& V, const std::vector<uint8_t>& bytes, uint64_t offset = 0u);
 }
 
 #include "serialization.inl"
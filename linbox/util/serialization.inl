@@ -352,4 +352,34 @@ namespace LinBox {
 
         return bytesRead;
     }
+
+    // ----- std::vector
+
+    template <class T>
+    inline uint64_t serialize(std::vector<uint8_t>& bytes, const std::vector<T>& V)
+    {
+        uint64_t l = V.size();
+        auto bytesWritten = serialize(bytes, l);
+
+        for (uint64_t i = 0; i < l; ++i) {
+            bytesWritten += serialize(bytes, V[i]);
+        }
+
+        return bytesWritten;
+    }
+
+    template <class T>
+    inline uint64_t unserialize(std::vector<T>& V, const std::vector<uint8_t>& bytes, uint64_t offset)
+    {
+        uint64_t l;
+        uint64_t bytesRead = 0u;
+        bytesRead += unserialize(l, bytes, offset + bytesRead);
+
+        V.resize(l);
+        for (uint64_t i = 0; i < l; ++i) {
+            bytesRead += unserialize(V[i], bytes, offset + bytesRead);
+        }
+
+        return bytesRead;
+    }
 }
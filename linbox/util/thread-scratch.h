@@ -0,0 +1,63 @@
+/* linbox/util/thread-scratch.h
+ * Copyright (C) 2013 the LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ */
+
+/*! @file util/thread-scratch.h
+ * @ingroup util
+ * @brief Per thread scratch storage.
+ */
+
+#ifndef __LINBOX_util_thread_scratch_H
+#define __LINBOX_util_thread_scratch_H
+
+namespace LinBox
+{
+
+	/** The \p T of the calling thread for \p Buffer.
+	 *
+	 * Built at the first call in each thread and kept until the thread
+	 * ends, so that the temporaries of an apply are not allocated at each
+	 * call and the apply may run in several threads at once. \p Buffer is
+	 * any type naming the use, so that each caller has its own storage.
+	 *
+	 * \code
+	 * std::vector<double> & buf = threadScratch<std::vector<double>, MyBuffer> ();
+	 * if (buf.size () < n) buf.resize (n);
+	 * \endcode
+	 */
+	template <class T, class Buffer>
+	T & threadScratch ()
+	{
+		static thread_local T s;
+		return s;
+	}
+
+} // namespace LinBox
+
+#endif // __LINBOX_util_thread_scratch_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
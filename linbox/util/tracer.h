@@ -0,0 +1,254 @@
+/* linbox/util/tracer.h
+ * Copyright (C) 2013 the LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ *.
+ */
+
+/*! @file util/tracer.h
+ * @ingroup util
+ * @brief Thread safe spans and counters, exported as Chrome trace JSON.
+ */
+
+#ifndef __LINBOX_tracer_H
+#define __LINBOX_tracer_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace LinBox
+{
+
+	/** \brief Recorder of timed spans and counters, usable from any thread.
+	 *
+	 * Unlike \ref Commentator, which keeps one global stack of activities,
+	 * each thread appends its events to a buffer of its own : recording
+	 * takes no lock, so spans may be opened inside OpenMP regions (the
+	 * \ref CRA workers for instance). The mutex is only taken the first time
+	 * a thread records something, to register its buffer.
+	 *
+	 * Recording is off until \c enable() is called, and then costs a clock
+	 * read and a \c push_back per event. The instrumentation in the library
+	 * goes through the \c LINBOX_TRACE_SPAN and \c LINBOX_TRACE_COUNTER
+	 * macros, which are empty unless \c __LINBOX_TRACE is defined.
+	 *
+	 * \c write() outputs the events in the Chrome trace event format, which
+	 * chrome://tracing and Perfetto (ui.perfetto.dev) load directly. It and
+	 * \c clear() must not run while other threads are recording.
+	 *
+	 * Event names are not copied : they must be string literals.
+	 *
+	 * \code
+	 * Tracer::instance ().enable ();
+	 * { TraceSpan s ("rank"); rank (r, A); }
+	 * std::ofstream out ("rank.json");
+	 * Tracer::instance ().write (out);
+	 * \endcode
+	 */
+	class Tracer {
+	public:
+
+		/// One event ; \c ph is 'B' (begin), 'E' (end) or 'C' (counter).
+		struct Event {
+			const char *name;
+			int64_t     ts;    // nanoseconds since the creation of the tracer
+			int64_t     value;
+			char        ph;
+		};
+
+		/// The tracer of the program.
+		static Tracer & instance ()
+		{
+			static Tracer t;
+			return t;
+		}
+
+		/// Start (or stop) recording.
+		void enable (bool on = true) { _on.store (on, std::memory_order_relaxed); }
+
+		bool enabled () const { return _on.load (std::memory_order_relaxed); }
+
+		/// Open a span named \p name in the calling thread.
+		void begin (const char *name) { if (enabled ()) record (name, 'B', 0); }
+
+		/// Close the last span opened by the calling thread.
+		void end (const char *name) { if (enabled ()) record (name, 'E', 0); }
+
+		/// Value \p v of the counter \p name.
+		void counter (const char *name, int64_t v) { if (enabled ()) record (name, 'C', v); }
+
+		/// Number of events recorded, in all threads.
+		size_t size () const
+		{
+			std::lock_guard<std::mutex> lock (_mutex);
+			size_t s = 0;
+			for (size_t i = 0; i < _buffers.size (); ++i)
+				s += _buffers[i]->size ();
+			return s;
+		}
+
+		/// Forget the events recorded.
+		void clear ()
+		{
+			std::lock_guard<std::mutex> lock (_mutex);
+			for (size_t i = 0; i < _buffers.size (); ++i)
+				_buffers[i]->clear ();
+		}
+
+		/// Chrome trace JSON of the events recorded, one tid per thread.
+		std::ostream & write (std::ostream &os) const
+		{
+			std::lock_guard<std::mutex> lock (_mutex);
+			os << "{\"traceEvents\":[";
+			bool first = true;
+			for (size_t t = 0; t < _buffers.size (); ++t)
+				for (size_t i = 0; i < _buffers[t]->size (); ++i) {
+					const Event &e = (*_buffers[t])[i];
+					char ts[32];
+					std::snprintf (ts, sizeof (ts), "%lld.%03lld",
+						       (long long) (e.ts / 1000), (long long) (e.ts % 1000));
+					os << (first ? "\n" : ",\n") << "{\"name\":\"";
+					writeString (os, e.name);
+					os << "\",\"ph\":\"" << e.ph << "\",\"ts\":" << ts
+					   << ",\"pid\":0,\"tid\":" << t;
+					if (e.ph == 'C')
+						os << ",\"args\":{\"value\":" << e.value << "}";
+					os << "}";
+					first = false;
+				}
+			return os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+		}
+
+	private:
+
+		typedef std::vector<Event> Buffer;
+
+		Tracer () :
+			_on (false), _t0 (std::chrono::steady_clock::now ())
+		{}
+
+		Tracer (const Tracer &);
+		Tracer & operator= (const Tracer &);
+
+		friend class TraceSpan;
+
+		void record (const char *name, char ph, int64_t value)
+		{
+			Event e;
+			e.name  = name;
+			e.ts    = std::chrono::duration_cast<std::chrono::nanoseconds>
+				(std::chrono::steady_clock::now () - _t0).count ();
+			e.value = value;
+			e.ph    = ph;
+			buffer ().push_back (e);
+		}
+
+		// The buffer of the calling thread, registered on first use. The
+		// buffers are kept after their thread ends, until the program does.
+		Buffer & buffer ()
+		{
+			static thread_local Buffer *b = 0;
+			if (b == 0) {
+				std::lock_guard<std::mutex> lock (_mutex);
+				_buffers.emplace_back (new Buffer);
+				b = _buffers.back ().get ();
+			}
+			return *b;
+		}
+
+		static void writeString (std::ostream &os, const char *s)
+		{
+			for (; *s; ++s) {
+				if (*s == '"' || *s == '\\')
+					os << '\\' << *s;
+				else if ((unsigned char) *s < 0x20) {
+					char u[8];
+					std::snprintf (u, sizeof (u), "\\u%04x", (unsigned) *s);
+					os << u;
+				}
+				else
+					os << *s;
+			}
+		}
+
+		std::atomic<bool>                     _on;
+		const std::chrono::steady_clock::time_point _t0;
+		mutable std::mutex                    _mutex;
+		std::vector<std::unique_ptr<Buffer> > _buffers;
+	};
+
+	/** \brief Span of the \ref Tracer over the lifetime of the object.
+	 *
+	 * The span is closed only if it was opened, so that enabling or
+	 * disabling the tracer inside of it leaves the begin and end events
+	 * balanced.
+	 */
+	class TraceSpan {
+	public:
+		explicit TraceSpan (const char *name) :
+			_name (name), _on (Tracer::instance ().enabled ())
+		{
+			if (_on) Tracer::instance ().record (_name, 'B', 0);
+		}
+
+		~TraceSpan ()
+		{
+			if (_on) Tracer::instance ().record (_name, 'E', 0);
+		}
+
+	private:
+		TraceSpan (const TraceSpan &);
+		TraceSpan & operator= (const TraceSpan &);
+
+		const char *_name;
+		bool        _on;
+	};
+
+} // namespace LinBox
+
+#define LINBOX_TRACE_CAT_(a, b) a##b
+#define LINBOX_TRACE_CAT(a, b) LINBOX_TRACE_CAT_(a, b)
+
+#ifdef __LINBOX_TRACE
+/// Trace the enclosing scope as a span named \p name (a string literal).
+#define LINBOX_TRACE_SPAN(name) \
+	LinBox::TraceSpan LINBOX_TRACE_CAT(__linbox_trace_span_, __LINE__) (name)
+/// Trace the value \p v of the counter \p name (a string literal).
+#define LINBOX_TRACE_COUNTER(name, v) \
+	LinBox::Tracer::instance ().counter (name, (int64_t) (v))
+#else
+#define LINBOX_TRACE_SPAN(name)
+#define LINBOX_TRACE_COUNTER(name, v)
+#endif
+
+#endif // __LINBOX_tracer_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
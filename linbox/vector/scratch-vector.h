@@ -0,0 +1,159 @@
+/* linbox/vector/scratch-vector.h
+ * Copyright (C) 2013 the LinBox
+ *
+ * ========LICENCE========
+ * This file is part of the library LinBox.
+ *
+ * LinBox is free software: you can redistribute it and/or modify
+ * it under the terms of the  GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * ========LICENCE========
+ *.
+ */
+
+#ifndef __LINBOX_scratch_vector_H
+#define __LINBOX_scratch_vector_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+#include "linbox/util/thread-scratch.h"
+#include "linbox/vector/blas-vector.h"
+
+#ifndef LINBOX_SCRATCH_VECTOR_KEEP
+// Largest scratch vector (in entries) kept for the next apply
+#define LINBOX_SCRATCH_VECTOR_KEEP 1048576
+#endif
+
+namespace LinBox
+{
+
+	namespace Protected {
+
+		/// How a scratch vector of type Vector is built.
+		template <class Field, class Vector>
+		struct ScratchVectorAlloc {
+			static Vector * make (const Field &F, size_t n)
+			{ return new Vector (F, n); }
+		};
+
+		/// std::vector has no field.
+		template <class Field, class Element>
+		struct ScratchVectorAlloc<Field, std::vector<Element> > {
+			static std::vector<Element> * make (const Field &, size_t n)
+			{ return new std::vector<Element> (n); }
+		};
+	}
+
+	/** \brief Temporary vector taken from a per thread stack.
+	 *
+	 * The intermediate vectors of the compound black boxes (Compose, Sum)
+	 * are taken from here for the duration of an apply, instead of being
+	 * mutable members of the black box : the black box can then be applied
+	 * from several threads at once, and the nested applies of a chain of
+	 * compositions each get their own vector.
+	 *
+	 * Each thread keeps a stack of vectors per (Field, Vector) type, in
+	 * its \ref threadScratch. The
+	 * constructor takes the next one, resized to \p n, and the destructor
+	 * gives it back, so that nothing is allocated once a chain has been
+	 * applied once at its dimensions. A vector built over another field
+	 * object is replaced.
+	 *
+	 * The vectors are kept until the thread ends, except those of more than
+	 * \c LINBOX_SCRATCH_VECTOR_KEEP entries, which are freed when given back ;
+	 * \c release() frees the others.
+	 *
+	 * \code
+	 * ScratchVector<Field> z (A.field (), A.coldim ());
+	 * B.apply (*z, x);
+	 * A.apply (y, *z);
+	 * \endcode
+	 */
+	template <class Field, class Vector = BlasVector<Field> >
+	class ScratchVector {
+	public:
+
+		ScratchVector (const Field &F, size_t n)
+		{
+			Stack &s = stack ();
+			if (s.depth == s.slots.size ())
+				s.slots.push_back (Slot ());
+			Slot &slot = s.slots[s.depth++];
+			if (slot.field != &F || !slot.v) {
+				slot.v.reset (Protected::ScratchVectorAlloc<Field, Vector>::make (F, n));
+				slot.field = &F;
+			}
+			else
+				slot.v->resize (n);
+			_v = slot.v.get ();
+		}
+
+		~ScratchVector ()
+		{
+			Stack &s = stack ();
+			Slot &slot = s.slots[--s.depth];
+			if (slot.v->size () > LINBOX_SCRATCH_VECTOR_KEEP)
+				slot.v.reset ();
+		}
+
+		/// Free the vectors kept by the calling thread, but those in use.
+		static void release ()
+		{
+			Stack &s = stack ();
+			s.slots.resize (s.depth);
+		}
+
+		/// Change the dimension of the vector.
+		void resize (size_t n) { _v->resize (n); }
+
+		Vector & operator* () const { return *_v; }
+		Vector * operator-> () const { return _v; }
+
+	private:
+
+		ScratchVector (const ScratchVector &);
+		ScratchVector & operator= (const ScratchVector &);
+
+		struct Slot {
+			Slot () : field (0) {}
+			const Field            *field;
+			std::unique_ptr<Vector> v;
+		};
+
+		struct Stack {
+			Stack () : depth (0) {}
+			std::vector<Slot> slots;
+			size_t            depth;
+		};
+
+		static Stack & stack ()
+		{
+			return threadScratch<Stack, ScratchVector> ();
+		}
+
+		Vector *_v;
+	};
+
+} // namespace LinBox
+
+#endif // __LINBOX_scratch_vector_H
+
+// Local Variables:
+// mode: C++
+// tab-width: 4
+// indent-tabs-mode: nil
+// c-basic-offset: 4
+// End:
+// vim:sts=4:sw=4:ts=4:et:sr:cino=>s,f0,{0,g0,(0,\:0,t0,+0,=s
@@ -49,6 +49,18 @@ AC_DEFUN([AC_PROFILE],
 ]
 )
 
+dnl enable the tracer spans of the library (linbox/util/tracer.h).
+AC_DEFUN([AC_TRACE],
+[AC_MSG_CHECKING([whether to compile the tracer spans in the library])
+  AC_ARG_ENABLE(trace,
+[AC_HELP_STRING([--enable-trace=yes|no], [record spans and counters of the main algorithms, see LinBox::Tracer])],
+      USE_TRACE=$enableval,
+      USE_TRACE=no)
+  AC_MSG_RESULT([$USE_TRACE])
+  AS_IF([test "x$USE_TRACE" = "xyes"],[AC_DEFINE(TRACE,1,[Define whether to compile the tracer spans])],[])
+]
+)
+
 dnl Enable warnings from compiler.
 AC_DEFUN([AC_WARNINGS],
 [AC_MSG_CHECKING([whether to enable warnings when compiling the library])
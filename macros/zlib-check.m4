@@ -0,0 +1,45 @@
+dnl Check for zlib
+dnl Copyright (c) the LinBox group
+dnl This file is part of LinBox
+
+ dnl ========LICENCE========
+ dnl This file is part of the library LinBox.
+ dnl
+ dnl LinBox is free software: you can redistribute it and/or modify
+ dnl it under the terms of the  GNU Lesser General Public
+ dnl License as published by the Free Software Foundation; either
+ dnl version 2.1 of the License, or (at your option) any later version.
+ dnl
+ dnl This library is distributed in the hope that it will be useful,
+ dnl but WITHOUT ANY WARRANTY; without even the implied warranty of
+ dnl MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ dnl Lesser General Public License for more details.
+ dnl
+ dnl You should have received a copy of the GNU Lesser General Public
+ dnl License along with this library; if not, write to the Free Software
+ dnl Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ dnl ========LICENCE========
+ dnl
+
+AC_DEFUN([LB_CHECK_ZLIB],
+[
+AC_MSG_CHECKING(if zlib is available)
+SAVED_LIBS=$LIBS
+    LIBS="$LIBS -lz"
+    AC_TRY_LINK(
+      [#include <zlib.h>],
+      [
+      gzFile f = gzopen("", "rb");
+      gzbuffer(f, 1 << 16);
+      ],
+      [
+AC_MSG_RESULT(yes)
+AC_DEFINE(HAVE_ZLIB,1,[Define if zlib is installed])
+ZLIB_LIBS="-lz"
+AC_SUBST(ZLIB_LIBS)
+],
+      [AC_MSG_RESULT(no)
+      AC_MSG_WARN([zlib is not installed (no reading of compressed matrix files).])]
+    )
+    LIBS=$SAVED_LIBS
+])